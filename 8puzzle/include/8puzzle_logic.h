@@ -1,7 +1,8 @@
 #ifndef LOGIC_H
 #define LOGIC_H
 #include "state.h"
-#include "linked_list.h"
+#include "successors.h"
+#include <stdint.h>
 
 // Estrutura do que contem o estado do nosso puzzle 8
 typedef struct 
@@ -13,8 +14,8 @@ typedef struct
 // Implementa a heurística do problema 8 puzzle
 int heuristic(const state_t*, const state_t*);
 
-// Encontra os vizinhos de um estado no problema 8 puzzle
-void visit(state_t*, state_allocator_t*, linked_list_t*);
+// Encontra os vizinhos de um estado no problema 8 puzzle, retorna falso se não for possível alocar os sucessores
+bool visit(state_t*, state_allocator_t*, successors_t*);
 
 // Verifica se um estado é um objetivo do problema 8 puzzle
 bool goal(const state_t*, const state_t*);
@@ -24,4 +25,18 @@ bool goal(const state_t*, const state_t*);
 // mover uma peça de cada vez para o espaço livre
 int distance(const state_t*, const state_t*);
 
+// Hash de Zobrist abstrato para atribuir os estados aos trabalhadores: apenas as posições das peças 1 a 4, os
+// movimentos das outras peças mantêm o estado no mesmo trabalhador
+uint64_t owner(const state_t*);
+
+// Número de nblocks da abstração do PBNF (posição do espaço vazio x posição da peça 1)
+#define NBLOCK_COUNT 81
+
+// Abstração para o algoritmo PBNF: apenas as posições do espaço vazio e da peça 1, os movimentos das outras peças
+// mantêm o estado no mesmo nblock
+size_t nblock(const state_t*);
+
+// Preenche os nblocks sucessores de um nblock (instance não é utilizado) e retorna quantos são
+size_t nblock_successors(const void* instance, size_t nblock, size_t* successors);
+
 #endif
\ No newline at end of file
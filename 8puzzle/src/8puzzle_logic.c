@@ -1,6 +1,7 @@
 #include "8puzzle_logic.h"
-#include "linked_list.h"
+#include "successors.h"
 #include "state.h"
+#include "zobrist.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,6 +13,13 @@ static const puzzle_state goal_puzzle = { { { '1', '2', '3' }, { '4', '5', '6' }
 // Estrutura para ajudar no cálculo da heurística
 static const int heuristic_table[8][2] = { { 0, 0 }, { 0, 1 }, { 0, 2 }, { 1, 0 }, { 1, 1 }, { 1, 2 }, { 2, 0 }, { 2, 1 } };
 
+// Distância de Manhattan de uma peça na posição indicada até à sua posição no objetivo
+static inline int piece_distance(char piece, int row, int col)
+{
+  int num = (piece - 49);
+  return abs(col - heuristic_table[num][1]) + abs(row - heuristic_table[num][0]);
+}
+
 // Função de heurística para o puzzle 8
 int heuristic(const state_t* current_state, const state_t*)
 {
@@ -45,8 +53,8 @@ int heuristic(const state_t* current_state, const state_t*)
   return h;
 }
 
-// Função para visitar um estado do puzzle 8, expandir vizinhos possíveis e armazená-los na lista ligada
-void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t* neighbors)
+// Função para visitar um estado do puzzle 8, expandir vizinhos possíveis e armazená-los no buffer
+bool visit(state_t* current_state, state_allocator_t* allocator, successors_t* neighbors)
 {
   // Obtenha o ponteiro para a estrutura puzzle_state
   puzzle_state* puzzle = (puzzle_state*)(current_state->data);
@@ -58,7 +66,7 @@ void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t*
   memcpy(&new_puzzle_left, puzzle, sizeof(puzzle_state));
   memcpy(&new_puzzle_right, puzzle, sizeof(puzzle_state));
 
-  // Lógica para expandir o estado e adicionar os vizinhos à lista ligada
+  // Lógica para expandir o estado e adicionar os vizinhos ao buffer
 
   // Localizar a posição do espaço vazio no tabuleiro
   int empty_row = 0;
@@ -84,7 +92,13 @@ void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t*
   {
     new_puzzle_up.board[empty_row][empty_col] = new_puzzle_up.board[empty_row - 1][empty_col];
     new_puzzle_up.board[empty_row - 1][empty_col] = '-';
-    linked_list_append(neighbors, state_allocator_new(allocator, &new_puzzle_up));
+    // Apenas a peça movida muda de distância ao objetivo
+    char piece = puzzle->board[empty_row - 1][empty_col];
+    int h_delta = piece_distance(piece, empty_row, empty_col) - piece_distance(piece, empty_row - 1, empty_col);
+    if(!successors_add_data(neighbors, allocator, &new_puzzle_up, 1, h_delta))
+    {
+      return false;
+    }
   }
 
   // Movimento para baixo do espaço vazio
@@ -92,7 +106,13 @@ void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t*
   {
     new_puzzle_down.board[empty_row][empty_col] = new_puzzle_down.board[empty_row + 1][empty_col];
     new_puzzle_down.board[empty_row + 1][empty_col] = '-';
-    linked_list_append(neighbors, state_allocator_new(allocator, &new_puzzle_down));
+    // Apenas a peça movida muda de distância ao objetivo
+    char piece = puzzle->board[empty_row + 1][empty_col];
+    int h_delta = piece_distance(piece, empty_row, empty_col) - piece_distance(piece, empty_row + 1, empty_col);
+    if(!successors_add_data(neighbors, allocator, &new_puzzle_down, 1, h_delta))
+    {
+      return false;
+    }
   }
 
   // Movimento para a esquerda
@@ -100,7 +120,13 @@ void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t*
   {
     new_puzzle_left.board[empty_row][empty_col] = new_puzzle_left.board[empty_row][empty_col - 1];
     new_puzzle_left.board[empty_row][empty_col - 1] = '-';
-    linked_list_append(neighbors, state_allocator_new(allocator, &new_puzzle_left));
+    // Apenas a peça movida muda de distância ao objetivo
+    char piece = puzzle->board[empty_row][empty_col - 1];
+    int h_delta = piece_distance(piece, empty_row, empty_col) - piece_distance(piece, empty_row, empty_col - 1);
+    if(!successors_add_data(neighbors, allocator, &new_puzzle_left, 1, h_delta))
+    {
+      return false;
+    }
   }
 
   // Movimento para a direita
@@ -108,8 +134,16 @@ void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t*
   {
     new_puzzle_right.board[empty_row][empty_col] = new_puzzle_right.board[empty_row][empty_col + 1];
     new_puzzle_right.board[empty_row][empty_col + 1] = '-';
-    linked_list_append(neighbors, state_allocator_new(allocator, &new_puzzle_right));
+    // Apenas a peça movida muda de distância ao objetivo
+    char piece = puzzle->board[empty_row][empty_col + 1];
+    int h_delta = piece_distance(piece, empty_row, empty_col) - piece_distance(piece, empty_row, empty_col + 1);
+    if(!successors_add_data(neighbors, allocator, &new_puzzle_right, 1, h_delta))
+    {
+      return false;
+    }
   }
+
+  return true;
 }
 
 // Verifica se um estado é um objectivo do problema 8 puzzle
@@ -125,3 +159,68 @@ int distance(const state_t*, const state_t*)
 {
   return 1;
 }
+
+// Peças utilizadas pelo hash abstrato ('1' a OWNER_LAST_PIECE)
+#define OWNER_LAST_PIECE '4'
+
+// Hash de Zobrist abstrato das posições das peças 1 a 4
+uint64_t owner(const state_t* state)
+{
+  puzzle_state* puzzle = (puzzle_state*)(state->data);
+
+  uint64_t hash = 0;
+  for(int y = 0; y < 3; y++)
+  {
+    for(int x = 0; x < 3; x++)
+    {
+      char piece = puzzle->board[y][x];
+      if(piece >= '1' && piece <= OWNER_LAST_PIECE)
+      {
+        hash ^= zobrist_key((uint32_t)(piece - '1'), (uint32_t)(y * 3 + x));
+      }
+    }
+  }
+  return hash;
+}
+
+// Posições do espaço vazio e da peça 1
+size_t nblock(const state_t* state)
+{
+  puzzle_state* puzzle = (puzzle_state*)(state->data);
+
+  size_t empty = 0;
+  size_t one = 0;
+  for(int i = 0; i < 9; i++)
+  {
+    char piece = puzzle->board[i / 3][i % 3];
+    if(piece == '-')
+    {
+      empty = i;
+    }
+    else if(piece == '1')
+    {
+      one = i;
+    }
+  }
+  return empty * 9 + one;
+}
+
+// O espaço vazio move-se para uma posição vizinha, se essa posição for a da peça 1 a peça passa para a posição
+// anterior do espaço vazio
+size_t nblock_successors(const void* instance, size_t nblock, size_t* successors)
+{
+  int empty = (int)nblock / 9;
+  int one = (int)nblock % 9;
+  int moves[4] = { empty - 3, empty + 3, empty % 3 > 0 ? empty - 1 : -1, empty % 3 < 2 ? empty + 1 : -1 };
+
+  size_t count = 0;
+  for(int i = 0; i < 4; i++)
+  {
+    if(moves[i] < 0 || moves[i] > 8)
+    {
+      continue;
+    }
+    successors[count++] = (size_t)(moves[i] * 9 + (moves[i] == one ? empty : one));
+  }
+  return count;
+}
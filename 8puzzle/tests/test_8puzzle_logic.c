@@ -1,5 +1,5 @@
 #include "8puzzle_logic.h"
-#include "linked_list.h"
+#include "successors.h"
 #include "state.h"
 #include <check.h>
 #include <stdlib.h>
@@ -17,10 +17,10 @@ START_TEST(test_visit_case_1)
   puzzle_state expected_2 = { { { '1', '2', '3' }, { '4', '5', '6' }, { '7', '-', '8' } } };
 
   // Criação do alocador de estados
-  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state));
+  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state), 0);
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -28,13 +28,13 @@ START_TEST(test_visit_case_1)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 2);
 
   // Verificação dos vizinhos gerados
-  state_t* neighbor1 = linked_list_get(neighbors, 0);
-  state_t* neighbor2 = linked_list_get(neighbors, 1);
+  state_t* neighbor1 = neighbors->items[0].state;
+  state_t* neighbor2 = neighbors->items[1].state;
 
   puzzle_state* neighbor1_puzzle = (puzzle_state*)(neighbor1->data);
   puzzle_state* neighbor2_puzzle = (puzzle_state*)(neighbor2->data);
@@ -46,7 +46,7 @@ START_TEST(test_visit_case_1)
   ck_assert(memcmp(neighbor2_puzzle, &expected_2, sizeof(puzzle_state)) == 0);
 
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
 }
 END_TEST
@@ -69,10 +69,10 @@ START_TEST(test_visit_case_2)
   puzzle_state expected_4 = { { { '1', '2', '3' }, { '4', '5', '-' }, { '6', '7', '8' } } };
 
   // Criação do alocador de estados
-  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state));
+  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state), 0);
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -80,15 +80,15 @@ START_TEST(test_visit_case_2)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 4);
 
   // Verificação dos vizinhos gerados
-  state_t* neighbor1 = linked_list_get(neighbors, 0);
-  state_t* neighbor2 = linked_list_get(neighbors, 1);
-  state_t* neighbor3 = linked_list_get(neighbors, 2);
-  state_t* neighbor4 = linked_list_get(neighbors, 3);
+  state_t* neighbor1 = neighbors->items[0].state;
+  state_t* neighbor2 = neighbors->items[1].state;
+  state_t* neighbor3 = neighbors->items[2].state;
+  state_t* neighbor4 = neighbors->items[3].state;
 
   puzzle_state* neighbor1_puzzle = (puzzle_state*)(neighbor1->data);
   puzzle_state* neighbor2_puzzle = (puzzle_state*)(neighbor2->data);
@@ -107,8 +107,16 @@ START_TEST(test_visit_case_2)
   // Verificação do vizinho 4
   ck_assert(memcmp(neighbor4_puzzle, &expected_4, sizeof(puzzle_state)) == 0);
 
+  // O custo e a variação da heurística fornecidos coincidem com as funções de distância e de heurística
+  for(size_t i = 0; i < neighbors->size; i++)
+  {
+    successor_t* successor = &neighbors->items[i];
+    ck_assert_int_eq(successor->cost, distance(initial_state_ptr, successor->state));
+    ck_assert_int_eq(heuristic(initial_state_ptr, NULL) + successor->h_delta, heuristic(successor->state, NULL));
+  }
+
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
 }
 END_TEST
@@ -125,10 +133,10 @@ START_TEST(test_visit_case_3)
   puzzle_state expected_2 = { { { '1', '-', '2' }, { '3', '4', '5' }, { '6', '7', '8' } } };
 
   // Criação do alocador de estados
-  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state));
+  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state), 0);
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -136,13 +144,13 @@ START_TEST(test_visit_case_3)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 2);
 
   // Verificação dos vizinhos gerados
-  state_t* neighbor1 = linked_list_get(neighbors, 0);
-  state_t* neighbor2 = linked_list_get(neighbors, 1);
+  state_t* neighbor1 = neighbors->items[0].state;
+  state_t* neighbor2 = neighbors->items[1].state;
 
   puzzle_state* neighbor1_puzzle = (puzzle_state*)(neighbor1->data);
   puzzle_state* neighbor2_puzzle = (puzzle_state*)(neighbor2->data);
@@ -154,7 +162,7 @@ START_TEST(test_visit_case_3)
   ck_assert(memcmp(neighbor2_puzzle, &expected_2, sizeof(puzzle_state)) == 0);
 
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
 }
 END_TEST
@@ -171,10 +179,10 @@ START_TEST(test_visit_case_4)
   puzzle_state expected_2 = { { { '1', '-', '2' }, { '3', '4', '5' }, { '6', '7', '8' } } };
 
   // Criação do alocador de estados
-  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state));
+  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state), 0);
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -182,13 +190,13 @@ START_TEST(test_visit_case_4)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 2);
 
   // Verificação dos vizinhos gerados
-  state_t* neighbor1 = linked_list_get(neighbors, 0);
-  state_t* neighbor2 = linked_list_get(neighbors, 1);
+  state_t* neighbor1 = neighbors->items[0].state;
+  state_t* neighbor2 = neighbors->items[1].state;
 
   puzzle_state* neighbor1_puzzle = (puzzle_state*)(neighbor1->data);
   puzzle_state* neighbor2_puzzle = (puzzle_state*)(neighbor2->data);
@@ -200,7 +208,7 @@ START_TEST(test_visit_case_4)
   ck_assert(memcmp(neighbor2_puzzle, &expected_2, sizeof(puzzle_state)) == 0);
 
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
 }
 END_TEST
@@ -217,10 +225,10 @@ START_TEST(test_visit_case_5)
   puzzle_state expected_2 = { { { '1', '2', '3' }, { '3', '4', '5' }, { '7', '-', '8' } } };
 
   // Criação do alocador de estados
-  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state));
+  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state), 0);
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -228,13 +236,13 @@ START_TEST(test_visit_case_5)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 2);
 
   // Verificação dos vizinhos gerados
-  state_t* neighbor1 = linked_list_get(neighbors, 0);
-  state_t* neighbor2 = linked_list_get(neighbors, 1);
+  state_t* neighbor1 = neighbors->items[0].state;
+  state_t* neighbor2 = neighbors->items[1].state;
 
   puzzle_state* neighbor1_puzzle = (puzzle_state*)(neighbor1->data);
   puzzle_state* neighbor2_puzzle = (puzzle_state*)(neighbor2->data);
@@ -246,7 +254,7 @@ START_TEST(test_visit_case_5)
   ck_assert(memcmp(neighbor2_puzzle, &expected_2, sizeof(puzzle_state)) == 0);
 
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
 }
 END_TEST
@@ -256,8 +264,8 @@ START_TEST(test_goal)
   puzzle_state ok_state_data = { { { '1', '2', '3' }, { '4', '-', '5' }, { '6', '7', '8' } } };
   puzzle_state nok_state_data = { { { '1', '2', '3' }, { '-', '4', '5' }, { '3', '7', '8' } } };
 
-  state_t ok_state = { 0, sizeof(puzzle_state), &ok_state_data };
-  state_t nok_state = { 0, sizeof(puzzle_state), &nok_state_data };
+  state_t ok_state = { 0, &ok_state_data };
+  state_t nok_state = { 0, &nok_state_data };
 
   ck_assert(!goal(&nok_state, NULL));
   ck_assert(!goal(&ok_state, NULL));
@@ -270,8 +278,8 @@ START_TEST(test_distance)
   puzzle_state ok_state_data = { { { '1', '2', '3' }, { '4', '-', '5' }, { '6', '7', '8' } } };
   puzzle_state nok_state_data = { { { '1', '2', '3' }, { '-', '4', '5' }, { '3', '7', '8' } } };
 
-  state_t ok_state = { 0, sizeof(puzzle_state), &ok_state_data };
-  state_t nok_state = { 0, sizeof(puzzle_state), &nok_state_data };
+  state_t ok_state = { 0, &ok_state_data };
+  state_t nok_state = { 0, &nok_state_data };
 
   ck_assert(distance(&nok_state, &ok_state) == 1);
 }
@@ -285,8 +293,8 @@ START_TEST(test_heuristic)
   puzzle_state goal_puzzle = { { { '1', '2', '3' }, { '4', '5', '6' }, { '7', '8', '-' } } };
 
   // Criação dos objetos state_t para os estados de teste
-  state_t current_state = { 0, sizeof(puzzle_state), &current_puzzle };
-  state_t goal_state = { 0, sizeof(puzzle_state), &goal_puzzle };
+  state_t current_state = { 0, &current_puzzle };
+  state_t goal_state = { 0, &goal_puzzle };
 
   // Chamada da função heuristic para calcular a heurística
   int h = heuristic(&current_state, &goal_state);
@@ -306,6 +314,60 @@ START_TEST(test_heuristic)
 }
 END_TEST
 
+// Teste unitário para o hash abstrato, apenas as peças 1 a 4 mudam o trabalhador do estado
+START_TEST(test_owner)
+{
+  puzzle_state puzzle = { { { '1', '2', '3' }, { '4', '-', '5' }, { '6', '7', '8' } } };
+  puzzle_state moved_5 = { { { '1', '2', '3' }, { '4', '5', '-' }, { '6', '7', '8' } } };
+  puzzle_state moved_4 = { { { '1', '2', '3' }, { '-', '4', '5' }, { '6', '7', '8' } } };
+
+  state_t state = { 0, &puzzle };
+  state_t state_5 = { 0, &moved_5 };
+  state_t state_4 = { 0, &moved_4 };
+
+  ck_assert_uint_eq(owner(&state), owner(&state_5));
+  ck_assert_uint_ne(owner(&state), owner(&state_4));
+}
+END_TEST
+
+// Teste unitário da abstração do PBNF, os sucessores de um estado pertencem aos nblocks sucessores do seu nblock
+START_TEST(test_nblock)
+{
+  puzzle_state puzzle = { { { '2', '3', '5' }, { '1', '-', '4' }, { '6', '7', '8' } } };
+  state_allocator_t* allocator = state_allocator_create(sizeof(puzzle_state), 0);
+  successors_t* neighbors = successors_create(0);
+  state_t* state = state_allocator_new(allocator, &puzzle);
+
+  size_t parent = nblock(state);
+  ck_assert_uint_eq(parent, 4 * 9 + 3);
+
+  size_t successors[4];
+  size_t num_successors = nblock_successors(NULL, parent, successors);
+  ck_assert_uint_eq(num_successors, 4);
+
+  visit(state, allocator, neighbors);
+  ck_assert_uint_eq(neighbors->size, 4);
+  for(size_t i = 0; i < neighbors->size; i++)
+  {
+    size_t child = nblock(neighbors->items[i].state);
+    ck_assert_uint_lt(child, NBLOCK_COUNT);
+
+    bool found = false;
+    for(size_t j = 0; j < num_successors; j++)
+    {
+      found |= successors[j] == child;
+    }
+    ck_assert(found);
+  }
+
+  // Mover a peça 1 troca as posições do espaço vazio e da peça
+  ck_assert_uint_eq(successors[2], 3 * 9 + 4);
+
+  successors_destroy(neighbors);
+  state_allocator_destroy(allocator);
+}
+END_TEST
+
 // Função auxiliar para criação da suíte de testes
 Suite* create_suite()
 {
@@ -319,6 +381,8 @@ Suite* create_suite()
   tcase_add_test(tcase, test_goal);
   tcase_add_test(tcase, test_distance);
   tcase_add_test(tcase, test_heuristic);
+  tcase_add_test(tcase, test_owner);
+  tcase_add_test(tcase, test_nblock);
   suite_add_tcase(suite, tcase);
   return suite;
 }
@@ -0,0 +1,91 @@
+#include "8puzzle_logic.h"
+#include "astar_pbnf.h"
+#include <check.h>
+#include <stdlib.h>
+
+// O 8 puzzle não suporta STATS_GEN (as estatísticas da procura não são inicializadas), os testes não são compilados
+#ifndef STATS_GEN
+// Instância 8puzzle_easy_1, a solução ótima tem custo 18
+static puzzle_state easy_1 = { { { '7', '3', '1' }, { '4', '8', '2' }, { '-', '5', '6' } } };
+
+// Instância 8puzzle_easy_2, a solução ótima tem custo 20
+static puzzle_state easy_2 = { { { '1', '3', '8' }, { '2', '7', '4' }, { '6', '5', '-' } } };
+
+// Instância 8puzzle_impossible_1, sem solução
+static puzzle_state impossible_1 = { { { '2', '3', '5' }, { '-', '8', '7' }, { '1', '4', '6' } } };
+
+// Cria uma instância do algoritmo PBNF com a abstração do 8 puzzle
+static a_star_pbnf_t* create_pbnf(int num_workers)
+{
+  a_star_abstraction_t abstraction = { NULL, NBLOCK_COUNT, nblock, nblock_successors };
+  a_star_pbnf_t* a_star = a_star_pbnf_create(
+      sizeof(puzzle_state), goal, visit, heuristic, distance, NULL, num_workers, false, &abstraction, NULL);
+  ck_assert_ptr_nonnull(a_star);
+  return a_star;
+}
+
+// Resolve o puzzle e retorna o custo da solução encontrada, -1 se não existir solução
+static int solve_cost(a_star_pbnf_t* a_star, puzzle_state* puzzle)
+{
+  a_star_pbnf_solve(a_star, puzzle, NULL);
+  return a_star->common->solution == NULL ? -1 : a_star->common->solution->g;
+}
+
+// A solução encontrada é ótima com um e com vários trabalhadores
+START_TEST(test_pbnf_easy)
+{
+  int workers[] = { 1, 4 };
+  for(size_t i = 0; i < sizeof(workers) / sizeof(workers[0]); i++)
+  {
+    a_star_pbnf_t* a_star = create_pbnf(workers[i]);
+    ck_assert_int_eq(solve_cost(a_star, &easy_1), 18);
+    a_star_pbnf_destroy(a_star);
+  }
+}
+END_TEST
+
+// Sem solução a procura termina depois de esgotar os nós abertos de todos os nblocks
+START_TEST(test_pbnf_impossible)
+{
+  a_star_pbnf_t* a_star = create_pbnf(4);
+  ck_assert_int_eq(solve_cost(a_star, &impossible_1), -1);
+  ck_assert_int_eq(a_star->common->num_solutions, 0);
+  a_star_pbnf_destroy(a_star);
+}
+END_TEST
+
+// Depois de um reset o custo da solução anterior não poda os nós do problema seguinte
+START_TEST(test_pbnf_reset)
+{
+  a_star_pbnf_t* a_star = create_pbnf(4);
+  ck_assert_int_eq(solve_cost(a_star, &easy_1), 18);
+  a_star_pbnf_reset(a_star);
+  ck_assert_int_eq(solve_cost(a_star, &easy_2), 20);
+  a_star_pbnf_reset(a_star);
+  ck_assert_int_eq(solve_cost(a_star, &impossible_1), -1);
+  a_star_pbnf_destroy(a_star);
+}
+END_TEST
+#endif
+
+// Função principal de teste
+int main()
+{
+  Suite* suite = suite_create("8puzzle_pbnf");
+  TCase* testcase = tcase_create("Core");
+
+#ifndef STATS_GEN
+  tcase_add_test(testcase, test_pbnf_easy);
+  tcase_add_test(testcase, test_pbnf_impossible);
+  tcase_add_test(testcase, test_pbnf_reset);
+#endif
+
+  suite_add_tcase(suite, testcase);
+
+  SRunner* runner = srunner_create(suite);
+  srunner_run_all(runner, CK_NORMAL);
+  int num_failed = srunner_ntests_failed(runner);
+  srunner_free(runner);
+
+  return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
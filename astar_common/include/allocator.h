@@ -2,22 +2,43 @@
    Alocador de Memória com Páginas
 
    Este alocador implementa uma estratégia simples de alocação de memória baseada em páginas.
-   Cada página tem um tamanho fixo de 1 gigabyte. O objetivo do alocador é alocar memória
-   para uma estrutura específica, cujo tamanho é especificado na inicialização do alocador.
+   Cada página é uma zona de endereços reservada com `mmap` (por defeito ALLOCATOR_PAGE_SIZE bytes), a
+   memória só é disponibilizada (commit) em blocos de ALLOCATOR_COMMIT_CHUNK bytes à medida que a página é
+   utilizada, assim um alocador pouco utilizado só ocupa os blocos que utilizou. O objetivo do alocador é
+   alocar memória para uma estrutura específica, cujo tamanho é especificado na inicialização do alocador.
+
+   Cada thread recebe um bloco (`chunk_size` bytes) de cada vez e aloca as estruturas desse bloco apenas
+   avançando um ponteiro local, sem locks. Os blocos são distribuídos com um fetch-add atómico sobre o
+   cursor partilhado (página atual e deslocamento), o mutex só é utilizado para reservar uma nova página.
 
    Funcionalidades:
 
    - `allocator_create`: Inicializa o alocador de memória com o tamanho da estrutura a ser alocada.
+   - `allocator_create_paged`: Inicializa o alocador com um tamanho de página e opções próprias.
+   - `allocator_alloc`: Aloca uma estrutura, retorna NULL caso não seja possível reservar memória.
+   - `allocator_reset`: Descarta todas as estruturas mantendo as páginas para as alocações seguintes.
+   - `allocator_memory`: Memória disponibilizada pelos blocos (reservada) e dos blocos já entregues (utilizada).
    - `allocator_destroy`: Liberta o alocador de memória e todas as páginas alocadas.
 
    Estrutura do Alocador:
 
    - `struct_size`: Tamanho da estrutura a ser alocada.
-   - `page_size`: Tamanho fixo da página em bytes (1 gigabyte).
-   - `pages`: Array de ponteiros para as páginas alocadas.
+   - `page_size`: Tamanho da página em bytes (múltiplo de ALLOCATOR_COMMIT_CHUNK).
+   - `chunk_size`: Tamanho dos blocos entregues a cada thread (múltiplo de ALLOCATOR_COMMIT_CHUNK).
+   - `flags`: Opções das páginas (ALLOCATOR_HUGE_PAGES, ALLOCATOR_HUGETLB).
+   - `id`: Identificador único do alocador, utilizado pelas threads para reconhecer os seus blocos.
+   - `generation`: Número de resets, os blocos das threads de gerações anteriores deixam de ser utilizados.
+   - `pages`: Array de ponteiros para as páginas alocadas (no máximo ALLOCATOR_MAX_PAGES).
+   - `sorted_pages`: Índices das páginas ordenados pelo endereço, para encontrar a página de uma estrutura.
    - `num_pages`: Número total de páginas alocadas.
-   - `current_page`: Índice da página atual.
-   - `offset`: Deslocamento atual dentro da página.
+   - `cursor`: Página atual (bits mais significativos) e deslocamento do próximo bloco dentro da página.
+
+   Páginas grandes:
+
+   - ALLOCATOR_HUGE_PAGES pede ao kernel páginas grandes transparentes (`MADV_HUGEPAGE`), não tem efeito
+     se estas estiverem desativadas no sistema.
+   - ALLOCATOR_HUGETLB utiliza páginas grandes explícitas (`MAP_HUGETLB`), que têm de estar reservadas
+     no sistema, caso não seja possível a página é reservada com páginas normais.
 
    Utilização:
 
@@ -28,8 +49,13 @@
 
    Limitações e Considerações:
 
-   - O alocador atualmente não verifica se a estrutura alocada é maior do que o tamanho da página,
-     o que pode resultar em comportamento indefinido se o tamanho da estrutura exceder o tamanho da página.
+   - Estruturas maiores que a página não podem ser alocadas, nesse caso a criação do alocador falha.
+   - As estruturas não são libertadas individualmente, apenas todas com `allocator_destroy`.
+   - Estruturas alocadas seguidas pela mesma thread são contíguas, mas as de threads diferentes não.
+   - O que resta do bloco de uma thread quando esta termina não é aproveitado.
+   - Cada thread guarda os blocos de ALLOCATOR_THREAD_CACHES alocadores (procurados pelo identificador completo,
+     a partir da posição indicada por este), com mais alocadores em uso na mesma thread os blocos podem ser
+     substituídos antes de estarem cheios.
 
    Observações:
    
@@ -53,28 +79,83 @@
 #ifndef ALLOCATOR_H
 #define ALLOCATOR_H
 
+#include "memory_usage.h"
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+// Tamanho por defeito de cada página (endereços reservados, não memória ocupada)
+#define ALLOCATOR_PAGE_SIZE (64 * 1024 * 1024)
+
+// Tamanho dos blocos disponibilizados de cada vez dentro de uma página (o tamanho de uma página grande)
+#define ALLOCATOR_COMMIT_CHUNK (2 * 1024 * 1024)
+
+// Número máximo de páginas de um alocador
+#define ALLOCATOR_MAX_PAGES 16384
+
+// Número de alocadores com bloco próprio em cada thread
+#define ALLOCATOR_THREAD_CACHES 16
+
+// Opções das páginas
+#define ALLOCATOR_HUGE_PAGES 0x1 // Páginas grandes transparentes (MADV_HUGEPAGE)
+#define ALLOCATOR_HUGETLB 0x2 // Páginas grandes explícitas (MAP_HUGETLB)
 
 typedef struct
 {
   size_t struct_size; // Tamanho da estrutura a ser alocada
   size_t page_size; // Tamanho da página em bytes
+  size_t chunk_size; // Tamanho dos blocos entregues a cada thread
+  size_t chunk_structs; // Número de estruturas em cada bloco
+  size_t page_structs; // Número de estruturas em cada página
+  unsigned flags; // Opções das páginas
+  uint64_t id; // Identificador único, os blocos das threads pertencem a este identificador
+  uint64_t generation; // Número de resets, os blocos das threads têm de ser da geração atual
   void** pages; // Array de ponteiros para as páginas alocadas
+  size_t* sorted_pages; // Índices das páginas ordenados pelo endereço da página
   size_t num_pages; // Número total de páginas alocadas
-  size_t current_page; // Índice da página atual
-  size_t offset; // Deslocamento atual dentro da página
-  pthread_mutex_t mutex; // Mutex para garantir exclusão mútua
+  size_t max_chunks; // Maior número de blocos entregues antes de um reset (os blocos continuam disponíveis)
+  _Atomic uint64_t cursor; // Página atual e deslocamento do próximo bloco
+  pthread_mutex_t mutex; // Mutex para reservar novas páginas
 } allocator_t;
 
 // Inicializa o alocador de memória
 allocator_t* allocator_create(size_t struct_size);
 
+// Inicializa o alocador de memória com um tamanho de página (0 para o tamanho por defeito, arredondado
+// para um múltiplo de ALLOCATOR_COMMIT_CHUNK) e opções das páginas. Retorna NULL se a estrutura for maior
+// do que a página
+allocator_t* allocator_create_paged(size_t struct_size, size_t page_size, unsigned flags);
+
 // Liberta o alocador de memória e todas as páginas alocadas, incluindo os dados existentes
 void allocator_destroy(allocator_t* allocator);
 
-// Aloca uma estrutura de memória no alocador
+// Descarta todas as estruturas alocadas, as páginas já reservadas são reutilizadas pelas alocações seguintes.
+// Não pode ser utilizada enquanto outras threads alocam, os blocos que as threads tinham deixam de ser utilizados
+void allocator_reset(allocator_t* allocator);
+
+// Aloca uma estrutura de memória no alocador, retorna NULL caso não seja possível reservar memória.
+// Pode ser utilizada por várias threads em simultâneo
 void* allocator_alloc(allocator_t* allocator);
 
+// Soma a memória do alocador: a reservada são os blocos já disponibilizados (incluindo os anteriores a um reset),
+// a utilizada são os blocos entregues às threads desde o último reset
+void allocator_memory(allocator_t* allocator, memory_usage_t* usage);
+
+// Índice de uma estrutura alocada: as posições de todas as páginas são numeradas por ordem, o que permite
+// identificar as estruturas com menos de 64 bits. A página da estrutura é encontrada com uma pesquisa binária
+// pelo endereço, retorna SIZE_MAX se o ponteiro não pertencer ao alocador. Não pode ser utilizada enquanto
+// outras threads alocam
+size_t allocator_index_of(allocator_t* allocator, const void* ptr);
+
+// Estrutura que se encontra no índice indicado (ver allocator_index_of())
+static inline void* allocator_at(allocator_t* allocator, size_t index)
+{
+  size_t page = index / allocator->page_structs;
+  size_t position = index % allocator->page_structs;
+  return (char*)allocator->pages[page] + position / allocator->chunk_structs * allocator->chunk_size +
+         position % allocator->chunk_structs * allocator->struct_size;
+}
+
 #endif // ALLOCATOR_H
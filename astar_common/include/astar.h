@@ -1,8 +1,12 @@
 #ifndef ASTAR_H
 #define ASTAR_H
-#include "linked_list.h"
+#include "memory_usage.h"
+#include "min_heap.h"
 #include "node.h"
+#include "node_store.h"
 #include "state.h"
+#include "successors.h"
+#include <stdatomic.h>
 #include <time.h>
 #ifdef STATS_GEN
 #  include "search_data.h"
@@ -17,8 +21,9 @@ typedef struct a_star_node_t a_star_node_t;
 // Tipo para funções que calculam a heurística
 typedef int (*heuristic_function)(const state_t*, const state_t*);
 
-// Tipo para funções que expandem um estado nos estados filho, utilizando o alocador predefinido, atualiza a min_heap e a hash_table
-typedef void (*visit_function)(state_t*, state_allocator_t*, linked_list_t*);
+// Tipo para funções que expandem um estado nos estados filho, utilizando o alocador predefinido, e os acrescentam ao buffer.
+// Retorna falso se não for possível alocar os sucessores, nesse caso a procura termina
+typedef bool (*visit_function)(state_t*, state_allocator_t*, successors_t*);
 
 // Tipo para funções que verificam se um estado é o objetivo a atingir
 typedef bool (*goal_function)(const state_t*, const state_t*);
@@ -26,12 +31,47 @@ typedef bool (*goal_function)(const state_t*, const state_t*);
 // Tipo para funções que devolvem a distancia de um estado para o seu vizinho
 typedef int (*distance_function)(const state_t*, const state_t*);
 
+// Número máximo de nós expandidos em conjunto (expansion_batch)
+#define A_STAR_MAX_EXPANSION_BATCH 256
+
+// Opções de configuração do algoritmo, partilhadas pelas versões sequencial e paralela
+typedef struct
+{
+  enum min_heap_type_e open_set_type; // Estrutura utilizada para os nós abertos (heap ou bucket queue)
+  enum min_heap_tie_e tie_policy; // Desempate entre nós abertos com o mesmo custo
+  size_t expansion_batch; // Nós expandidos em conjunto (com o mesmo custo) antes de obter os sucessores, 0 expande
+                          // um nó de cada vez e os sucessores são obtidos durante a visita (apenas sequencial)
+  bool compact_nodes; // Nós compactos em arrays indexados por 32 bits em vez de embutidos nos estados (ver
+                      // node_store.h), reduz a memória por estado (apenas sequencial)
+  size_t outbox_size; // Mensagens guardadas para cada trabalhador antes de serem enviadas num bloco, 0 ou 1 envia
+                      // cada mensagem de imediato (apenas paralelo)
+  size_t outbox_expansions; // Expansões após as quais todas as mensagens guardadas são enviadas, 0 não limita
+                            // (apenas paralelo)
+  size_t steal_batch; // Nós abertos com menor custo roubados de cada vez ao trabalhador com mais nós por um
+                      // trabalhador sem trabalho, 0 desativa o roubo de nós (apenas paralelo)
+} a_star_options_t;
+
+// Memória utilizada por cada parte do algoritmo, medida no fim de cada resolução
+typedef struct
+{
+  memory_usage_t states; // Registos dos estados (com os nós embutidos)
+  memory_usage_t hashtable; // Hashtable dos estados
+  memory_usage_t nodes; // Nós compactos
+  memory_usage_t open_set; // Nós abertos (de todos os trabalhadores)
+  memory_usage_t channel; // Canal de mensagens entre trabalhadores
+  size_t num_states; // Estados existentes no fim da resolução
+} a_star_memory_t;
+
 // Estrutura que contem o estado do algoritmo A*
 struct a_star_t
 {
   // Estruturas para gestão de nós e estados
   state_allocator_t* state_allocator;
   node_allocator_t* node_allocator;
+  node_store_t* node_store; // Nós compactos, apenas com a opção compact_nodes
+
+  // Opções de configuração
+  a_star_options_t options;
 
   // Callbacks necessárias para o algoritmo funcionar
   goal_function goal_func;
@@ -41,8 +81,12 @@ struct a_star_t
 
   // Solução e estado a atingir
   a_star_node_t* solution;
+  a_star_node_t* solution_path; // Caminho da solução copiado dos nós compactos (a solução aponta para o início)
   state_t* goal_state;
 
+  // A procura terminou por falta de memória, pode ser assinalado por vários trabalhadores em simultâneo
+  atomic_bool allocation_error;
+
   // Informação estatística
   int generated;
   int expanded;
@@ -56,19 +100,56 @@ struct a_star_t
   int num_solutions;
   int num_worst_solutions;
   int num_better_solutions;
+  a_star_memory_t memory;
 };
 
-// Funções comuns do algoritmo
+// Custo do arco do nó pai até ao sucessor, a função de distância só é chamada se a visita não o forneceu
+static inline int a_star_successor_cost(a_star_t* a_star, state_t* parent, const successor_t* successor)
+{
+  if(successor->cost != SUCCESSOR_UNKNOWN)
+  {
+    return successor->cost;
+  }
+  return a_star->d_func(parent, successor->state);
+}
+
+// Heurística de um sucessor, a função de heurística só é chamada se a visita não forneceu a variação
+static inline int a_star_successor_h(a_star_t* a_star, int parent_h, const successor_t* successor)
+{
+  if(successor->h_delta != SUCCESSOR_UNKNOWN)
+  {
+    return parent_h + successor->h_delta;
+  }
+  return a_star->h_func(successor->state, a_star->goal_state);
+}
+
+// Preenche as opções com os valores por defeito
+void a_star_options_default(a_star_options_t* options);
+
+// Funções comuns do algoritmo, se options for NULL são utilizadas as opções por defeito
 a_star_t* a_star_create(size_t struct_size,
                         goal_function goal_func,
                         visit_function visit_func,
                         heuristic_function h_func,
                         distance_function d_func,
-                        print_function print_func);
+                        print_function print_func,
+                        const a_star_options_t* options);
 
 // Liberta uma instância do algoritmo A* sequencial
 void a_star_destroy(a_star_t* a_star);
 
+// Prepara a instância para resolver outro problema: descarta estados, nós, solução e estatísticas, mantendo
+// a memória e as hashtables já alocadas
+void a_star_reset(a_star_t* a_star);
+
+// Guarda a solução encontrada com nós compactos: o caminho até ao nó indicado é copiado para nós normais, para
+// que a impressão da solução e as estatísticas sejam as mesmas nos dois modos. Retorna false se não houver memória
+bool a_star_set_compact_solution(a_star_t* a_star, node_id_t goal);
+
+// Mede a memória dos estados, da hashtable e dos nós. A memória dos nós abertos e do canal pertence a cada versão
+// do algoritmo, que a soma depois desta função
+void a_star_measure_memory(a_star_t* a_star);
+
 // Imprime as estatísticas possíveis
 void a_star_print_statistics(a_star_t* a_star, bool csv, bool show_solution);
 
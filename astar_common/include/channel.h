@@ -6,27 +6,50 @@
   de um tamanho especificado quando se inicializa o canal.
 
   Cada thread pode colocar uma mensagem na fila dedicada para outra thread, para isso ao colocar a mensagem tem
-  de especificar em qual fila quer colocar a mensagem. As fila de mensagens são FIFO.
+  de especificar em qual fila quer colocar a mensagem. As fila de mensagens são FIFO. Um bloco de mensagens para
+  a mesma fila pode ser enviado com channel_send_batch(), com um único acesso ao mutex da fila.
 
-  As operações de colocar mensagens e de retirar mensagens são thread-safe com recurso ao uso de mutexes. Por uma
-  questão de performance é possível também colocar um bloco de mensagens para filas diferentes e o canal deve
-  distribuir as mensagens para a fila correta.
+  Cada fila tem dois buffers: as mensagens enviadas são acrescentadas ao buffer de escrita, com o mutex da fila,
+  e ao receber os dois buffers são trocados. O consumidor recebe as mensagens diretamente no buffer de leitura,
+  sem cópias nem alocações, o buffer pertence-lhe até à receção seguinte na mesma fila. Os buffers apenas
+  crescem (para o dobro) quando o buffer de escrita fica cheio. As filas estão alinhadas à linha de cache, assim
+  produtores de filas diferentes não disputam as mesmas linhas.
+
+  Uma thread sem trabalho pode bloquear com channel_wait() até existirem mensagens na sua fila, em vez de
+  verificar a fila continuamente. channel_close() acorda todas as threads bloqueadas, por exemplo para terminar.
 */
 
 #ifndef CHANNEL_H
 #define CHANNEL_H
-#include "queue.h"
+#include "memory_usage.h"
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 
+// Capacidade inicial, em mensagens, de cada buffer
 #define QUEUE_BUFFER_SIZE 2048
 
+// Tamanho de uma linha de cache
+#define CHANNEL_CACHE_LINE_SIZE 64
+
+// Fila de mensagens de uma thread
+typedef struct
+{
+  _Alignas(CHANNEL_CACHE_LINE_SIZE) pthread_mutex_t lock; // Protege o buffer de escrita
+  pthread_cond_t cond; // Sinalizada quando chegam mensagens à fila ou o canal é fechado
+  char* write_buffer; // Mensagens enviadas ainda por receber
+  atomic_size_t write_count; // Número de mensagens no buffer de escrita
+  size_t write_capacity;
+  char* read_buffer; // Mensagens entregues na última receção
+  size_t read_capacity;
+} channel_queue_t;
+
 // Estrutura do canal
 typedef struct
 {
-  void** queues;
-  size_t* queue_pos;
-  size_t* queue_size;
-  pthread_mutex_t* queue_lock; // Mutex para garantir a thread-safety
+  channel_queue_t* queues; // Uma fila por thread
+  bool closed; // As threads bloqueadas em channel_wait() devem sair
   size_t struct_size;
   size_t num_queues; // Número de filas
 
@@ -35,12 +58,34 @@ typedef struct
 // Inicializa o canal com o número especificado de filas
 channel_t* channel_create(size_t num_queues, size_t struct_size);
 
-// Envia uma mensagem para uma fila específica no canal
-void channel_send(channel_t* channel, size_t queue_index, void* data);
+// Envia uma mensagem para uma fila específica no canal, retorna falso se não foi possível guardar a mensagem
+bool channel_send(channel_t* channel, size_t queue_index, void* data);
+
+// Envia um bloco de count mensagens consecutivas para uma fila específica no canal, retorna falso se não foi
+// possível guardar as mensagens (nenhuma é enviada)
+bool channel_send_batch(channel_t* channel, size_t queue_index, void* data, size_t count);
 
-// Recebe uma mensagem da fila específica no canal (bloqueante)
+// Recebe todas as mensagens da fila específica no canal, sem bloquear. Retorna NULL se não existirem mensagens.
+// As mensagens pertencem ao canal (não devem ser libertadas) e são válidas até à próxima receção na mesma fila
 void* channel_receive(channel_t* channel, size_t queue_index, size_t* len);
 
+// Bloqueia até existirem mensagens na fila ou o canal ser fechado, retorna falso se o canal foi fechado
+bool channel_wait(channel_t* channel, size_t queue_index);
+
+// Bloqueia até existirem mensagens na fila, o canal ser fechado ou passarem timeout_ns nanossegundos, retorna falso
+// se o canal foi fechado
+bool channel_wait_timed(channel_t* channel, size_t queue_index, long timeout_ns);
+
+// Fecha o canal e acorda todas as threads bloqueadas em channel_wait()
+void channel_close(channel_t* channel);
+
+// Descarta as mensagens de todas as filas, mantendo a memória das filas, e volta a abrir o canal
+void channel_reset(channel_t* channel);
+
+// Soma a memória das filas do canal, a utilizada são as mensagens por receber. Não pode ser utilizada enquanto
+// outras threads enviam mensagens
+void channel_memory(channel_t* channel, memory_usage_t* usage);
+
 // Liberta a memória alocada para o canal
 void channel_destroy(channel_t* channel);
 
@@ -8,22 +8,40 @@
    - Libertar a memória utilizada pela hashtable.
 
    Estrutura da HashTable:
-   - A hashtable utiliza o método de encadeamento separado para lidar com colisões.
-   - Cada bucket na hashtable contém uma lista encadeada de entradas.
-   - Cada entrada armazena um ponteiro para a struct e a chave correspondente.
+   - A hashtable utiliza endereçamento aberto com sondagem linear, sem alocações por inserção.
+   - A tabela está dividida em HASH_MAX_MUTEXES partições, cada uma com o seu array de entradas, a
+     partição é escolhida pelos bits menos significativos do hash.
+   - Cada entrada guarda o hash completo e o ponteiro para os dados, os dados só são comparados
+     (memcmp ou comparador fornecido) quando os hashes são iguais.
+   - As procuras não utilizam locks. Uma inserção ocupa a entrada com um compare-and-swap do hash e
+     só depois publica os dados, duas threads a inserir os mesmos dados percorrem as mesmas posições
+     e encontram-se na mesma entrada, por isso `hashtable_insert_if_absent()` garante que só uma delas
+     insere e que ambas recebem o mesmo ponteiro.
+   - Quando uma partição ultrapassa 3/4 de ocupação é publicado um array com o dobro do tamanho. As
+     entradas do array antigo são transferidas aos poucos pelas inserções seguintes (HASH_MIGRATE_STEP
+     posições de cada vez), assim nenhuma inserção paga o custo de recolocar a partição inteira.
+     Enquanto a transferência decorre as procuras verificam os dois arrays. O mutex da partição só é
+     utilizado para crescer e transferir entradas.
+   - Os arrays antigos podem estar a ser lidos por outras threads, só são libertados com a hashtable.
+   - A função de hash por defeito (`hash_function()`) retorna 64 bits e processa os dados 16 bytes
+     de cada vez, ao estilo do wyhash.
 
    Utilização:
    1. Inclua o arquivo de cabeçalho "hashtable.h" em seu código.
    2. Crie uma nova hashtable usando a função hashtable_create(), especificando o tamanho da struct.
-   3. Insira as structs na hashtable usando a função hashtable_insert().
+   3. Insira as structs na hashtable usando a função hashtable_insert() ou hashtable_insert_if_absent().
    4. Verifique se uma struct está presente usando a função hashtable_contains().
-   5. Liberte a memória utilizada pela hashtable usando a função hashtable_destroy().
+   5. Para reutilizar a hashtable, remova todas as entradas com hashtable_reset().
+      O número de entradas e a memória ocupada obtêm-se com hashtable_count() e hashtable_memory().
+   6. Liberte a memória utilizada pela hashtable usando a função hashtable_destroy().
 
    Limitações e Considerações:
-   - Esta implementação não lida com situações de concorrência.
+   - Todas as operações, exceto hashtable_reset() e hashtable_destroy(), podem ser utilizadas por várias
+     threads em simultâneo.
    - A capacidade da hashtable é dinâmica e redimensiona automaticamente conforme necessário.
-   - No entanto, em cenários de carga elevada ou massiva, pode haver impacto no desempenho
-     devido ao redimensionamento e ao método de encadeamento separado.
+   - A função de hash fornecida pode retornar qualquer valor, o valor é misturado antes de ser
+     utilizado, mas valores repetidos para dados diferentes aumentam as sondagens.
+   - Não é possível guardar ponteiros NULL nem remover elementos.
    - Certifique-se de fornecer um tamanho adequado para a struct ao inicializar a hashtable.
    - Esta hashtable foi desenvolvida como parte de um projeto universitário com o objetivo de
      fornecer uma implementação simples e didática, mas pode não ser adequada para todos os casos
@@ -57,56 +75,101 @@
 #ifndef HASHTABLE_H
 #define HASHTABLE_H
 
+#include "memory_usage.h"
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #define HASH_MAX_MUTEXES 8192
 #define HASH_CAPACITY 65533
+#define HASH_MIGRATE_STEP 64
 
-typedef struct entry_t entry_t;
+typedef struct hashtable_entry_t hashtable_entry_t;
+typedef struct hashtable_array_t hashtable_array_t;
+typedef struct hashtable_shard_t hashtable_shard_t;
 typedef struct hashtable_t hashtable_t;
 
 // Tipo para funções para comparar dados dentro da hastable
-typedef bool (*hashtable_compare_func)(const void*, const void*);
+typedef bool (*hashtable_compare_func)(hashtable_t*, const void*, const void*);
 
-// Tipo para funções para comparar dados dentro da hastable
+// Tipo para funções que calculam o hash dos dados dentro da hastable
 typedef size_t (*hashtable_hash_func)(hashtable_t*, const void*);
 
+// Definição de uma entrada na hashtable, uma entrada com hash 0 está livre. O hash é ocupado primeiro
+// e os dados são publicados logo a seguir
+struct hashtable_entry_t
+{
+  _Atomic size_t hash;
+  _Atomic(void*) data;
+};
+
+// Array de entradas de uma partição
+struct hashtable_array_t
+{
+  size_t capacity; // Potência de 2
+  atomic_size_t size; // Entradas ocupadas ou reservadas, incluindo as que faltam transferir do array anterior
+  atomic_size_t writers; // Inserções a decorrer neste array
+  atomic_bool ready; // O array anterior já não recebe inserções e o tamanho já as inclui
+  _Atomic(hashtable_array_t*) prev; // Array anterior, enquanto existir as suas entradas estão a ser transferidas
+  size_t migrate_pos; // As posições anteriores do array anterior já foram transferidas
+  hashtable_array_t* retired; // Lista dos arrays já transferidos, só são libertados com a hashtable
+  hashtable_entry_t entries[];
+};
+
+// Partição da hashtable, o mutex apenas serializa o crescimento e a transferência de entradas
+struct hashtable_shard_t
+{
+  _Atomic(hashtable_array_t*) array; // NULL enquanto a partição estiver vazia
+  pthread_mutex_t mutex;
+};
+
 // Definição da hashtable
 struct hashtable_t
 {
   size_t struct_size;
-  size_t capacity;
-  entry_t** buckets;
+  size_t shard_capacity; // Capacidade inicial de cada partição
+  hashtable_shard_t* shards;
+  uint16_t* used_shards; // Partições com array alocado, pela ordem em que foram utilizadas
+  atomic_size_t num_used_shards;
   hashtable_compare_func cmp_func;
   hashtable_hash_func hash_func;
-  pthread_mutex_t* mutexes;
-};
-
-// Definição de uma entrada na hashtable
-struct entry_t
-{
-  void* data;
-  struct entry_t* next;
 };
 
 // Inicializa uma nova hashtable
 hashtable_t* hashtable_create(size_t struct_size, hashtable_compare_func cmp_func, hashtable_hash_func hash_func);
 
-// Insere uma struct na hashtable
+// Insere uma struct na hashtable, caso já exista uma igual a struct não é inserida
 void hashtable_insert(hashtable_t* hashtable, void* data);
 
 // Verifica se uma struct já está na hashtable, retorna NULL se os dados não foram encontrados
 // ou o ponteiro para a zona de memória onde se encontra os dados
 void* hashtable_contains(hashtable_t* hashtable, const void* data);
 
+// Antecipa o acesso à posição onde se encontram (ou seriam inseridos) os dados com o hash indicado (o valor
+// devolvido pela função de hash), para que uma procura ou inserção posterior não espere pela memória
+void hashtable_prefetch(hashtable_t* hashtable, size_t hash_value);
+
+// Remove todas as entradas mantendo os arrays das partições, percorre apenas as partições utilizadas.
+// Não liberta os dados
+void hashtable_reset(hashtable_t* hashtable);
+
+// Número de entradas na hashtable. Com inserções a decorrer o valor é aproximado
+size_t hashtable_count(hashtable_t* hashtable);
+
+// Soma a memória da hashtable (partições e arrays de entradas, incluindo os arrays ainda por libertar), a memória
+// utilizada são as entradas ocupadas. Não inclui os dados
+void hashtable_memory(hashtable_t* hashtable, memory_usage_t* usage);
+
 // Liberta a memória utilizada pela hashtable, atenção, não liberta os dados apenas a hashtable
 void hashtable_destroy(hashtable_t* hashtable, bool free_data);
 
-// Função de hashing utilizada
-size_t hash_function(const void* data, size_t size, size_t mod);
+// Função de hashing utilizada, retorna um hash de 64 bits dos dados
+size_t hash_function(const void* data, size_t size);
 
-// Insere uma struct na hashtable
-entry_t* hashtable_reserve(hashtable_t* hashtable, void* data);
+// Insere uma struct na hashtable caso ainda não exista uma igual, retorna os dados existentes ou os
+// dados inseridos (NULL em caso de erro de alocação). Com várias threads a inserir dados iguais apenas
+// uma insere, todas recebem o mesmo ponteiro
+void* hashtable_insert_if_absent(hashtable_t* hashtable, void* data);
 
 #endif // HASHTABLE_H
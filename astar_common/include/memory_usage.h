@@ -0,0 +1,22 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <stddef.h>
+
+// Memória de uma estrutura em bytes. As funções *_memory() das estruturas somam a sua memória aos valores
+// existentes, assim é possível juntar várias estruturas na mesma variável (por exemplo os heaps de todos os
+// trabalhadores)
+typedef struct
+{
+  size_t reserved; // Memória reservada pela estrutura, incluindo a capacidade ainda por utilizar
+  size_t used; // Memória ocupada pelos elementos atuais
+} memory_usage_t;
+
+// Soma a memória de b a a
+static inline void memory_usage_add(memory_usage_t* a, const memory_usage_t* b)
+{
+  a->reserved += b->reserved;
+  a->used += b->used;
+}
+
+#endif // MEMORY_USAGE_H
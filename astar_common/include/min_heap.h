@@ -2,18 +2,41 @@
    Min-Heap
   
    Este é um projeto de implementação de um min-heap, uma estrutura de dados fundamental
-   utilizada em ciência da computação. Um min-heap é uma árvore binária completa onde
+   utilizada em ciência da computação. Um min-heap é uma árvore completa onde
    cada nó possui um valor menor ou igual aos seus filhos. Ele é frequentemente usado
    para manter o elemento mínimo em tempo constante.
+
+   A árvore pode ser binária, 4-ária ou 8-ária (escolhido em `min_heap_create()`). Com mais filhos
+   por nó a árvore fica menos profunda e os filhos de um nó ocupam uma linha de cache (4-ário) ou
+   duas (8-ário), o que reduz as falhas de cache num heap grande.
+
+   Em alternativa ao heap existe uma bucket queue (`MIN_HEAP_BUCKET`) com a mesma interface, pensada para
+   custos inteiros num intervalo estreito como os do algoritmo A*. Os elementos ficam numa camada por custo
+   e, dentro de cada camada, numa lista por valor da heurística (h). A inserção, remoção e atualização são
+   O(1) e a extração do mínimo é O(1) amortizado, o cursor do mínimo só avança sobre camadas e listas vazias.
+
+   Desempate:
+   Os elementos com o mesmo custo saem segundo a política escolhida em `min_heap_create()`. No heap o
+   critério é guardado nos 32 bits menos significativos da chave: h (menor h), o complemento de g = custo - h
+   (maior g) ou o complemento de um contador de inserções (LIFO). Na bucket queue cada camada tem uma lista
+   por valor de h (menor h, e como o custo da camada é fixo também maior g), ou uma única lista utilizada
+   como pilha (LIFO) ou fila (sem critério). No algoritmo A* preferir o maior g aproxima a procura do objetivo
+   dentro de um plateau de f e reduz o número de nós expandidos.
   
    Funcionalidades:
     - Inserir elemento: adiciona um novo elemento ao heap, mantendo a propriedade do min-heap.
     - Extrair mínimo: remove e retorna o elemento mínimo do heap.
     - Remover nó: remove um nó específico do heap.
     - Atualizar custo: atualiza o custo de um nó específico no heap e reorganiza a estrutura.
+    - Indexação: opcionalmente o heap escreve a posição de cada elemento num campo `size_t` dos
+      próprios dados (o "handle"), sempre que o elemento muda de posição. Desta forma é possível
+      atualizar o custo ou remover um elemento em O(log(N)) sem procurar no array. Na bucket queue o handle
+      identifica o elemento mas não corresponde a uma posição do array `data`. Em alternativa os dados podem
+      ser índices (32 bits) e as posições são guardadas num array externo, ver `min_heap_set_positions()`.
   
    Utilização:
-   1. Crie um min-heap usando a função `min_heap_create()`.
+   1. Crie um min-heap usando a função `min_heap_create()`, indicando o tipo de heap, a política de desempate e o offset do
+      handle nos dados (ex: `offsetof(a_star_node_t, index_in_open_set)`) ou `MIN_HEAP_NO_INDEX`.
    2. Insira elementos usando a função `min_heap_insert()`.
    3. Extraia o elemento mínimo usando a função `min_heap_pop()`.
    4. Remova um nó específico usando a função `min_heap_remove()`.
@@ -22,10 +45,10 @@
   
    Exemplo de uso:
    ```
-   min_heap_t* heap = min_heap_create();
-   min_heap_insert(heap, 5, NULL);
-   min_heap_insert(heap, 10, NULL);
-   min_heap_insert(heap, 3, NULL);
+   min_heap_t* heap = min_heap_create(MIN_HEAP_4ARY, MIN_HEAP_TIE_NONE, MIN_HEAP_NO_INDEX);
+   min_heap_insert(heap, 5, 0, NULL);
+   min_heap_insert(heap, 10, 0, NULL);
+   min_heap_insert(heap, 3, 0, NULL);
    heap_node_t min_node = min_heap_pop(heap);
    min_heap_remove(heap, 10, NULL);
    min_heap_update(heap, 3, 7, NULL);
@@ -34,10 +57,18 @@
   
    Estrutura de Dados:
    O min-heap é implementado como uma estrutura `min_heap_t` contendo o tamanho atual do heap
-   e um array de `heap_node_t`. Cada `heap_node_t` possui um custo (inteiro) e um ponteiro para um estado (void*).
+   e um array de `heap_node_t` alinhado à linha de cache. Cada `heap_node_t` possui uma chave de 64 bits e um
+   ponteiro para um estado (void*). A chave junta o custo (32 bits mais significativos) e um critério de
+   desempate (32 bits menos significativos), assim uma única comparação de inteiros sem sinal ordena os
+   elementos. O custo de uma chave obtém-se com `min_heap_cost()`.
+   Quando o heap é indexado, cada troca de posição escreve a nova posição no handle do elemento, e quando
+   um elemento sai do heap (pop, remoção ou limpeza) o handle fica com o valor `SIZE_MAX`.
   
    Limitações:
     - Não há verificação de erros para operações inválidas, como remover ou atualizar um nó inexistente.
+    - Sem indexação, `min_heap_remove()` e `min_heap_update()` têm de procurar o elemento em O(N).
+    - A bucket queue reserva memória proporcional ao intervalo de custos e de heurísticas em uso, não é
+      adequada para custos muito dispersos.
   
    Observações:
    
@@ -49,31 +80,95 @@
 */
 #ifndef MIN_HEAP_H
 #define MIN_HEAP_H
+#include "memory_usage.h"
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+// Valor a utilizar em min_heap_create quando os dados não têm um handle para a posição no heap
+#define MIN_HEAP_NO_INDEX SIZE_MAX
+
+// Tipos de heap suportados (número de filhos por nó)
+enum min_heap_type_e
+{
+  MIN_HEAP_BINARY = 2,
+  MIN_HEAP_4ARY = 4,
+  MIN_HEAP_8ARY = 8,
+  MIN_HEAP_BUCKET = 1, // Bucket queue indexada pelo custo e pela heurística
+};
+
+// Políticas de desempate entre elementos com o mesmo custo
+enum min_heap_tie_e
+{
+  MIN_HEAP_TIE_NONE, // Sem critério, a ordem depende da estrutura (na bucket queue o mais antigo)
+  MIN_HEAP_TIE_HIGH_G, // Maior g (custo - h) primeiro
+  MIN_HEAP_TIE_LOW_H, // Menor h primeiro
+  MIN_HEAP_TIE_LIFO, // O último elemento inserido primeiro
+};
+
+// Estrutura interna da bucket queue
+typedef struct min_heap_buckets_t min_heap_buckets_t;
 
 // Estrutura para representar um nó do heap
 typedef struct
 {
-  int cost;
+  uint64_t key; // Custo e critério de desempate, ver min_heap_key()
   void* data;
 } heap_node_t;
 
+// Compõe a chave de um elemento, o custo é mapeado para que a ordem dos inteiros com sinal se mantenha
+static inline uint64_t min_heap_key(int cost, uint32_t tie)
+{
+  return ((uint64_t)((uint32_t)cost ^ 0x80000000u) << 32) | tie;
+}
+
+// Retorna o custo de uma chave
+static inline int min_heap_cost(uint64_t key)
+{
+  return (int)((uint32_t)(key >> 32) ^ 0x80000000u);
+}
+
 // Estrutura para representar o min-heap
 typedef struct
 {
   heap_node_t* data;
   size_t capacity;
   size_t size;
+  size_t index_offset; // Offset do handle (size_t) dentro dos dados, ou MIN_HEAP_NO_INDEX
+  uint32_t** positions; // Array externo com a posição de cada elemento, indexado pelos dados (ou NULL)
+  unsigned arity_shift; // log2 do número de filhos por nó
+  enum min_heap_tie_e tie; // Política de desempate
+  uint32_t counter; // Contador de inserções, utilizado pela política LIFO
+  void* memory; // Bloco alocado para o array (data está deslocado para alinhar os filhos)
+  min_heap_buckets_t* buckets; // Apenas no tipo MIN_HEAP_BUCKET, nesse caso data não é utilizado
 } min_heap_t;
 
-// Cria um novo min-heap
-min_heap_t* min_heap_create();\
+// Cria um novo min-heap do tipo e política de desempate indicados, index_offset indica onde se encontra o handle
+// dentro dos dados
+min_heap_t* min_heap_create(enum min_heap_type_e type, enum min_heap_tie_e tie, size_t index_offset);
+
+// Os dados dos elementos passam a ser índices (convertidos para void*) e a posição de cada elemento é escrita
+// em (*positions)[índice], UINT32_MAX quando o elemento sai do heap. O array pode ser realocado entre operações
+void min_heap_set_positions(min_heap_t* heap, uint32_t** positions);
 
 // Destroi o min-heap e liberta a memória
 void min_heap_destroy(min_heap_t* heap);
 
-// Insere um novo elemento no heap
-size_t min_heap_insert(min_heap_t* heap, int cost, void* data);
+// Soma a memória do heap: o array (ou, na bucket queue, os elementos e o índice por custo) reservado e a parte
+// ocupada pelos elementos atuais
+void min_heap_memory(min_heap_t* heap, memory_usage_t* usage);
+
+// Obtém o tipo de heap a partir do nome ("binary", "4ary", "8ary" ou "bucket"), retorna falso se não existir
+bool min_heap_type_from_name(const char* name, enum min_heap_type_e* type);
+
+// Obtém a política de desempate a partir do nome ("none", "high-g", "low-h" ou "lifo"), retorna falso se não existir
+bool min_heap_tie_from_name(const char* name, enum min_heap_tie_e* tie);
+
+// Retorna o nome da política de desempate
+const char* min_heap_tie_name(enum min_heap_tie_e tie);
+
+// Insere um novo elemento no heap com o custo e heurística indicados, retorna a posição final do elemento
+size_t min_heap_insert(min_heap_t* heap, int cost, int h, void* data);
 
 // Extrai e retorna o elemento de custo mínimo do heap
 heap_node_t min_heap_pop(min_heap_t* heap);
@@ -81,11 +176,18 @@ heap_node_t min_heap_pop(min_heap_t* heap);
 // Remove um elemento específico do heap
 void min_heap_remove(min_heap_t* heap, int cost, void* data);
 
-// Atualiza o custo de um nó específico no heap
+// Remove o elemento que se encontra na posição indicada
+void min_heap_remove_at(min_heap_t* heap, size_t index);
+
+// Atualiza o custo de um nó específico no heap, o critério de desempate mantém-se
 void min_heap_update(min_heap_t* heap, int old_cost, int new_cost, void* data);
 
-// Atualiza o custo de um nó específico no heap
-void min_heap_update_cost(min_heap_t* heap, int index, int cost);
+// Atualiza o custo e a heurística do nó que se encontra na posição indicada (aumentar ou diminuir). Retorna falso
+// se a bucket queue não tiver memória para a nova posição, nesse caso o elemento sai do heap
+bool min_heap_update_cost(min_heap_t* heap, size_t index, int cost, int h);
+
+// Retorna o custo do elemento mínimo sem o remover, INT_MAX se o heap estiver vazio
+int min_heap_top_cost(min_heap_t* heap);
 
 // Limpa a min_heap
 void min_heap_clean(min_heap_t* heap);
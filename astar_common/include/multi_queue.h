@@ -0,0 +1,67 @@
+/*
+  MultiQueue
+
+  Fila prioritária relaxada partilhada por várias threads: é composta por vários min-heaps, cada um com o seu
+  mutex. Uma inserção escolhe um heap aleatório e uma extração escolhe dois heaps aleatórios e retira o mínimo do
+  que tiver o melhor mínimo. O elemento extraído não é necessariamente o mínimo global, mas está próximo dele, e
+  as threads raramente disputam o mesmo heap (com c heaps por thread).
+
+  O custo mínimo de cada heap é mantido numa variável atómica, assim a escolha entre os dois heaps é feita sem
+  mutexes. Os heaps estão alinhados à linha de cache para que threads em heaps diferentes não disputem as mesmas
+  linhas. Os heaps não são indexados (MIN_HEAP_NO_INDEX): para atualizar o custo de um elemento insere-se uma nova
+  entrada e a antiga é ignorada quando for extraída.
+
+  Utilização:
+  1. Crie a fila com multi_queue_create(), indicando o número de heaps, o tipo de heap e a política de desempate.
+  2. Cada thread utiliza a sua semente para os números aleatórios (qualquer valor diferente de 0).
+  3. Insira elementos com multi_queue_push() e extraia com multi_queue_pop().
+  4. Limpe a fila com multi_queue_clean() e liberte a memória com multi_queue_destroy().
+*/
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+
+#include "memory_usage.h"
+#include "min_heap.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Tamanho de uma linha de cache
+#define MULTI_QUEUE_CACHE_LINE_SIZE 64
+
+// Um dos heaps da fila
+typedef struct
+{
+  _Alignas(MULTI_QUEUE_CACHE_LINE_SIZE) pthread_mutex_t lock; // Protege o heap
+  min_heap_t* heap;
+  atomic_int top_cost; // Custo do mínimo do heap, INT_MAX se estiver vazio
+} multi_queue_heap_t;
+
+// Estrutura da MultiQueue
+typedef struct
+{
+  multi_queue_heap_t* heaps;
+  size_t num_heaps;
+} multi_queue_t;
+
+// Cria uma fila com o número de heaps indicado
+multi_queue_t* multi_queue_create(size_t num_heaps, enum min_heap_type_e type, enum min_heap_tie_e tie);
+
+// Liberta a fila
+void multi_queue_destroy(multi_queue_t* queue);
+
+// Insere um elemento num heap aleatório, retorna falso se o heap não puder crescer
+bool multi_queue_push(multi_queue_t* queue, int cost, int h, void* data, uint64_t* seed);
+
+// Extrai o mínimo do melhor de dois heaps aleatórios, retorna falso se não encontrou elementos
+bool multi_queue_pop(multi_queue_t* queue, heap_node_t* element, uint64_t* seed);
+
+// Descarta todos os elementos (nenhuma thread pode estar a utilizar a fila)
+void multi_queue_clean(multi_queue_t* queue);
+
+// Soma a memória dos heaps
+void multi_queue_memory(multi_queue_t* queue, memory_usage_t* usage);
+
+#endif // MULTI_QUEUE_H
@@ -23,11 +23,11 @@ struct a_star_node_t
   size_t index_in_open_set;
 };
 
-// Estrutura que contem o estado do algoritmo A*
+// Estrutura que contem o estado do algoritmo A*. Os nós não têm memória nem indexação próprias, cada nó
+// ocupa a zona reservada a seguir ao seu estado (o gestor de estados tem de ser criado com
+// node_size = sizeof(a_star_node_t)), assim a procura do estado já dá acesso ao nó
 struct node_allocator_t
 {
-  allocator_t* allocator;
-  hashtable_t* nodes;
   print_function print_func;
 };
 
@@ -40,7 +40,7 @@ void node_allocator_destroy(node_allocator_t* alloc);
 // Cria um novo nó para o estado
 a_star_node_t* node_allocator_new(node_allocator_t* alloc, state_t* state);
 
-// Verifica se já existe uma nó para o estado
+// Verifica se já existe uma nó para o estado, não utiliza a hashtable
 a_star_node_t* node_allocator_get(node_allocator_t* alloc, state_t* state);
 
 #endif
\ No newline at end of file
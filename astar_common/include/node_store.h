@@ -0,0 +1,83 @@
+/******************************************************************************
+ * Nós compactos para o Algoritmo A*
+
+   Alternativa aos nós embutidos nos registos dos estados (ver node.h): a informação dos nós é guardada em
+   arrays separados (estrutura de arrays), indexados por um identificador de 32 bits em vez de ponteiros.
+   O identificador de um nó é o índice do registo do estado no alocador mais 1 (ver allocator_index_of()),
+   assim não é preciso guardar a correspondência entre estados e nós e o identificador 0 (NODE_NONE) fica
+   livre para indicar a ausência de nó (por exemplo o pai do nó inicial).
+
+   Cada nó ocupa 16 bytes (g, h, pai e posição nos nós abertos), metade do nó embutido (32 bytes), que
+   deixa de ser reservado junto dos estados. A posição nos nós abertos é mantida pelo min-heap (ver
+   min_heap_set_positions()).
+
+   Utilização:
+   1. Crie os estados com um gestor de estados sem zona reservada (node_size = 0) e crie os nós com
+      node_store_create(), indicando o alocador dos registos dos estados.
+   2. Obtenha o identificador do nó de um estado com node_store_id(), o nó existe se node_store_exists().
+   3. A memória dos arrays obtém-se com node_store_memory().
+   4. Para resolver outro problema descarte os nós com node_store_reset() depois de descartar os estados.
+   5. Liberte a memória com node_store_destroy().
+
+   Limitações e Considerações:
+   - Apenas para utilização por uma thread (algoritmo sequencial), os arrays são realocados quando crescem.
+   - Suporta no máximo UINT32_MAX - 1 estados.
+*/
+#ifndef NODE_STORE_H
+#define NODE_STORE_H
+
+#include "allocator.h"
+#include "state.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Identificador de um nó compacto
+typedef uint32_t node_id_t;
+
+// Ausência de nó
+#define NODE_NONE 0
+
+// Valor de g dos estados que ainda não têm nó
+#define NODE_STORE_NO_G INT_MAX
+
+// Estrutura com os nós compactos, cada array é indexado pelo identificador do nó
+typedef struct
+{
+  int* g; // Custo desde o estado inicial, NODE_STORE_NO_G se o estado ainda não tem nó
+  int* h; // Heurística
+  node_id_t* parent; // Nó pai, NODE_NONE no nó inicial
+  uint32_t* open_index; // Posição no conjunto de nós abertos, UINT32_MAX fora deste
+  size_t capacity; // Número de identificadores que cabem nos arrays
+  size_t used; // Maior identificador utilizado mais 1, apenas esta parte é limpa no reset
+  allocator_t* allocator; // Alocador dos registos dos estados
+} node_store_t;
+
+// Cria os nós compactos dos estados do alocador indicado
+node_store_t* node_store_create(allocator_t* allocator);
+
+// Liberta os nós compactos
+void node_store_destroy(node_store_t* store);
+
+// Descarta todos os nós, mantendo a memória dos arrays
+void node_store_reset(node_store_t* store);
+
+// Soma a memória dos arrays, a utilizada é a dos identificadores até ao maior utilizado
+void node_store_memory(node_store_t* store, memory_usage_t* usage);
+
+// Identificador do nó de um estado, os arrays crescem para o incluir. Retorna NODE_NONE se não for possível
+node_id_t node_store_id(node_store_t* store, state_t* state);
+
+// Verifica se o estado do identificador já tem nó
+static inline bool node_store_exists(node_store_t* store, node_id_t id)
+{
+  return store->g[id] != NODE_STORE_NO_G;
+}
+
+// Estado do identificador
+static inline state_t* node_store_state(node_store_t* store, node_id_t id)
+{
+  return (state_t*)allocator_at(store->allocator, id - 1);
+}
+
+#endif
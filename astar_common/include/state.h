@@ -5,15 +5,24 @@
    - Criar um gestor de estados
    - Destruir um gestor de estado
    - Alocar um novo estado caso os dados seja novos, ou retornar um estado existente 
+   - Reservar junto de cada estado uma zona de memória (por exemplo o nó do algoritmo A*), assim uma
+     única procura na hashtable dá acesso ao estado e a essa zona
+
+   Cada estado é um registo contíguo alocado do alocador de memória: o cabeçalho (state_t), a zona
+   reservada e os dados do estado. Procurar um estado que já existe não aloca memória.
 
    Utilização:
    1. Inclua o arquivo de cabeçalho "state.h" em seu código.
    2. Crie um nove gestor pela função state_allocator_create(), especificando o tamanho da struct com os dados
-   3. Aloque novos estados ou obtenha acesso estados existentes com a função state_allocator_new().
+      e o tamanho da zona reservada junto de cada estado (0 se não for necessária)
+   3. Aloque novos estados ou obtenha acesso estados existentes com a função state_allocator_new(). Para
+      vários estados de seguida, calcule primeiro os hashes de todos com state_allocator_prefetch() e só
+      depois obtenha os estados com state_allocator_new_hashed(), assim os acessos à hashtable sobrepõem-se.
+   4. Para resolver outro problema com o mesmo gestor, descarte os estados com state_allocator_reset().
    5. Liberte a memória utilizada pelo alocador com a função state_allocator_destroy().
 
    Limitações e Considerações:
-   - Esta implementação não lida com situações de concorrência.
+   - Várias threads podem criar estados em simultâneo, estados iguais resultam sempre no mesmo ponteiro.
    - Esta estrutura foi desenvolvida como parte de um projeto universitário com o objetivo de
      fornecer uma implementação simples e didática, mas pode não ser adequada para todos os casos
      de uso ou requisitos de desempenho.
@@ -32,29 +41,45 @@
 typedef struct state_t state_t;
 struct state_t
 {
-  size_t hash;
-  size_t struct_size;
-  void* data;
+  size_t hash; // Hash completo (64 bits) dos dados, calculado uma vez na criação do estado
+  void* data; // Dados do estado, guardados no mesmo registo a seguir à zona reservada
 };
 
 /*
  * Estrutura que representa um gestor de estados.
- * O gestor mantém um conjunto de estados e 2 alocadores de memória
+ * O gestor mantém a hashtable dos estados e um alocador de memória, cada estado é um único registo com o
+ * cabeçalho, a zona reservada (o nó embutido) e os dados
  */
 typedef struct
 {
   size_t struct_size;
-  allocator_t* allocator;
+  size_t node_size; // Tamanho da zona reservada a seguir a cada estado (múltiplo de 8), inicializada a zeros
+  allocator_t* allocator; // Registos dos estados (cabeçalho, zona reservada e dados)
   hashtable_t* states;
 } state_allocator_t;
 
 // Cria e inicializa um novo gestor de estados.
-state_allocator_t* state_allocator_create(size_t struct_size);
+state_allocator_t* state_allocator_create(size_t struct_size, size_t node_size);
 
 // Liberta um gestor de estado (incluindo a memória)
 void state_allocator_destroy(state_allocator_t* allocator);
 
+// Descarta todos os estados, mantendo a memória e a hashtable para os estados seguintes
+void state_allocator_reset(state_allocator_t* allocator);
+
 // Aloca ou retorna um estado novo
 state_t* state_allocator_new(state_allocator_t* allocator, void* state_data);
 
+// Calcula o hash dos dados e antecipa o acesso à hashtable, retorna o hash para state_allocator_new_hashed()
+size_t state_allocator_prefetch(state_allocator_t* allocator, const void* state_data);
+
+// Aloca ou retorna um estado novo, com o hash dos dados já calculado
+state_t* state_allocator_new_hashed(state_allocator_t* allocator, void* state_data, size_t hash);
+
+// Zona de memória reservada a seguir ao estado (node_size bytes)
+static inline void* state_node(state_t* state)
+{
+  return state + 1;
+}
+
 #endif
@@ -0,0 +1,76 @@
+#ifndef SUCCESSORS_H
+#define SUCCESSORS_H
+
+#include "state.h"
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Capacidade inicial do buffer de sucessores, suficiente para a maioria dos problemas
+#define SUCCESSORS_DEFAULT_CAPACITY 16
+
+// Indica que o custo do arco ou a variação da heurística de um sucessor não foram fornecidos pela função de visita,
+// nesse caso o algoritmo utiliza as funções de distância e de heurística
+#define SUCCESSOR_UNKNOWN INT_MIN
+
+// Sucessor gerado na expansão de um estado
+typedef struct
+{
+  state_t* state; // Estado sucessor
+  int cost; // Custo do arco do estado expandido até ao sucessor
+  int h_delta; // Heurística do sucessor menos a heurística do estado expandido
+} successor_t;
+
+// Buffer com os sucessores gerados na expansão de um estado
+//
+// Cada versão do algoritmo (ou cada trabalhador) cria um buffer e reutiliza-o em todas as expansões: a função
+// de visita acrescenta os sucessores e o algoritmo limpa o buffer depois de os processar. A memória só é
+// realocada quando um estado tem mais sucessores do que a capacidade atual, o que deixa de acontecer após as
+// primeiras expansões, pelo que as expansões não fazem alocações.
+//
+// Com staging ativo, os sucessores acrescentados com successors_add_data() ficam pendentes: os dados são
+// copiados, o hash é calculado e o acesso à hashtable dos estados é antecipado, e só em successors_resolve()
+// os estados são obtidos. Desta forma os acessos à memória dos sucessores de uma ou várias expansões
+// sobrepõem-se em vez de esperarem um a um.
+typedef struct
+{
+  successor_t* items; // Sucessores gerados, pela ordem em que foram acrescentados (pendentes com state NULL)
+  size_t size; // Número de sucessores no buffer
+  size_t capacity; // Número de sucessores que cabem no buffer sem realocar
+
+  // Sucessores pendentes, pela mesma ordem dos sucessores com state NULL
+  bool staging; // Os sucessores de successors_add_data() ficam pendentes até successors_resolve()
+  char* pending_data; // Cópia dos dados de cada sucessor pendente
+  size_t* pending_hashes; // Hash dos dados de cada sucessor pendente
+  size_t num_pending;
+  size_t pending_capacity;
+  size_t struct_size; // Tamanho dos dados dos estados
+} successors_t;
+
+// Cria um buffer com a capacidade indicada (0 para a capacidade predefinida)
+successors_t* successors_create(size_t capacity);
+
+// Liberta o buffer (os estados pertencem ao gestor de estados e não são libertados)
+void successors_destroy(successors_t* successors);
+
+// Acrescenta um sucessor ao buffer, o custo e a heurística são calculados pelo algoritmo. Retorna falso se não for
+// possível alocar memória, nesse caso o sucessor não é acrescentado e a procura não pode continuar
+bool successors_add(successors_t* successors, state_t* state);
+
+// Acrescenta um sucessor com o custo do arco e a variação da heurística já calculados (qualquer um pode ser
+// SUCCESSOR_UNKNOWN). A variação só pode ser fornecida se a heurística depender apenas do estado. Retorna falso se
+// não for possível alocar memória
+bool successors_add_with_costs(successors_t* successors, state_t* state, int cost, int h_delta);
+
+// Acrescenta um sucessor a partir dos dados do estado. Sem staging o estado é obtido imediatamente do gestor de
+// estados, com staging fica pendente até successors_resolve(). Retorna falso se não for possível alocar memória
+// (para o buffer ou, sem staging, para o estado)
+bool successors_add_data(successors_t* successors, state_allocator_t* allocator, void* state_data, int cost, int h_delta);
+
+// Obtém os estados de todos os sucessores pendentes, retorna falso se não for possível alocar algum dos estados
+bool successors_resolve(successors_t* successors, state_allocator_t* allocator);
+
+// Esvazia o buffer, mantendo a memória para a próxima expansão
+void successors_clear(successors_t* successors);
+
+#endif // SUCCESSORS_H
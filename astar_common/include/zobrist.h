@@ -0,0 +1,28 @@
+/*
+  Hashing de Zobrist abstrato
+
+  O hash de Zobrist de um estado é o XOR de uma chave aleatória por cada característica do estado (por exemplo a
+  posição de cada peça). No hashing abstrato apenas se utilizam características de uma abstração do estado (por
+  exemplo a região do tabuleiro em vez da posição exata), assim os sucessores que só alteram características
+  ignoradas pela abstração têm o mesmo hash que o estado de onde vieram. No algoritmo paralelo este hash atribui os
+  estados aos trabalhadores (ver a_star_parallel_set_owner()), e a maioria dos sucessores fica no trabalhador que
+  os gerou.
+
+  As chaves não são guardadas numa tabela: a chave de cada par (característica, valor) é obtida com uma função de
+  mistura, é sempre a mesma e não precisa de ser criada nem libertada.
+*/
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+
+// Chave aleatória do valor de uma característica (finalizador splitmix64)
+static inline uint64_t zobrist_key(uint32_t feature, uint32_t value)
+{
+  uint64_t x = ((uint64_t)feature << 32 | value) + 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+#endif // ZOBRIST_H
@@ -1,21 +1,84 @@
 #include "allocator.h"
 #include <stdlib.h>
+#include <sys/mman.h>
+
+// O cursor partilhado guarda o índice da página nos bits mais significativos e o deslocamento do próximo
+// bloco nos CURSOR_OFFSET_BITS menos significativos. Os fetch-add que passam o fim da página continuam a
+// somar ao deslocamento, as páginas têm de ser bastante menores que o limite
+#define CURSOR_OFFSET_BITS 40
+#define CURSOR_OFFSET_MASK ((UINT64_C(1) << CURSOR_OFFSET_BITS) - 1)
+#define MAX_PAGE_SIZE (UINT64_C(1) << (CURSOR_OFFSET_BITS - 2))
+
+// Bloco de um alocador utilizado por uma thread
+typedef struct
+{
+  uint64_t id; // Identificador do alocador, 0 se o bloco não está a ser utilizado
+  uint64_t generation; // Geração do alocador quando o bloco foi entregue
+  char* next; // Próxima estrutura
+  char* end; // Fim das estruturas que cabem no bloco
+} allocator_cache_t;
+
+// Blocos da thread atual, o bloco de um alocador fica de preferência na posição indicada pelo seu identificador,
+// ou noutra posição caso esta esteja ocupada por outro alocador
+static _Thread_local allocator_cache_t thread_caches[ALLOCATOR_THREAD_CACHES];
+
+// Próxima posição substituída quando um alocador não tem bloco e nenhuma posição está livre
+static _Thread_local size_t thread_cache_victim;
+
+// Próximo identificador de alocador
+static _Atomic uint64_t next_id = 1;
 
 // Inicializa o alocador de memória
 allocator_t* allocator_create(size_t struct_size)
 {
+  return allocator_create_paged(struct_size, 0, 0);
+}
+
+// Inicializa o alocador de memória com um tamanho de página e opções das páginas
+allocator_t* allocator_create_paged(size_t struct_size, size_t page_size, unsigned flags)
+{
+  if(page_size == 0)
+  {
+    page_size = ALLOCATOR_PAGE_SIZE;
+  }
+  page_size = (page_size + ALLOCATOR_COMMIT_CHUNK - 1) / ALLOCATOR_COMMIT_CHUNK * ALLOCATOR_COMMIT_CHUNK;
+
+  // Uma estrutura maior que a página nunca caberia numa página
+  if(struct_size == 0 || struct_size > page_size || page_size > MAX_PAGE_SIZE)
+  {
+    return NULL;
+  }
+
   allocator_t* allocator = (allocator_t*)malloc(sizeof(allocator_t));
   if(allocator == NULL)
   {
     return NULL; // Erro de alocação
   }
 
+  // O array de páginas não cresce, assim pode ser lido sem locks (apenas as posições utilizadas ocupam memória)
+  allocator->pages = calloc(ALLOCATOR_MAX_PAGES, sizeof(void*));
+  allocator->sorted_pages = calloc(ALLOCATOR_MAX_PAGES, sizeof(size_t));
+  if(allocator->pages == NULL || allocator->sorted_pages == NULL)
+  {
+    free(allocator->pages);
+    free(allocator->sorted_pages);
+    free(allocator);
+    return NULL;
+  }
+
   allocator->struct_size = struct_size;
-  allocator->page_size = 1 * 1024 * 1024 * 1024; // 1 gigabyte
-  allocator->pages = NULL;
+  allocator->page_size = page_size;
+  allocator->chunk_size = (struct_size + ALLOCATOR_COMMIT_CHUNK - 1) / ALLOCATOR_COMMIT_CHUNK * ALLOCATOR_COMMIT_CHUNK;
+  allocator->chunk_structs = allocator->chunk_size / struct_size;
+  allocator->page_structs = page_size / allocator->chunk_size * allocator->chunk_structs;
+  allocator->flags = flags;
+  allocator->id = atomic_fetch_add(&next_id, 1);
+  allocator->generation = 0;
   allocator->num_pages = 0;
-  allocator->current_page = 0;
-  allocator->offset = 0;
+  allocator->max_chunks = 0;
+
+  // Sem páginas o cursor indica uma página cheia, o primeiro bloco reserva a primeira página
+  atomic_init(&allocator->cursor, page_size);
   pthread_mutex_init(&allocator->mutex, NULL);
 
   return allocator;
@@ -26,52 +89,263 @@ void allocator_destroy(allocator_t* allocator)
 {
   for(size_t i = 0; i < allocator->num_pages; i++)
   {
-    free(allocator->pages[i]);
+    munmap(allocator->pages[i], allocator->page_size);
   }
   free(allocator->pages);
+  free(allocator->sorted_pages);
   allocator->pages = NULL;
+  allocator->sorted_pages = NULL;
   allocator->num_pages = 0;
-  allocator->current_page = 0;
-  allocator->offset = 0;
   pthread_mutex_destroy(&allocator->mutex);
   free(allocator);
 }
 
-// Aloca uma estrutura de memória no alocador
-void* allocator_alloc(allocator_t* allocator)
+// Número de blocos entregues desde o último reset, calculado a partir do cursor
+static size_t chunks_used(allocator_t* allocator)
 {
-  // Bloqueia o acesso ao alocador
-  pthread_mutex_lock(&allocator->mutex);
-
-  // Se não houver páginas alocadas, alocar a primeira página
   if(allocator->num_pages == 0)
   {
-    allocator->num_pages++;
-    allocator->pages = malloc(allocator->num_pages * sizeof(void*));
-    allocator->pages[0] = malloc(allocator->page_size);
+    return 0;
   }
 
-  // Se não houver espaço na página atual, alocar uma nova página
-  if(allocator->offset + allocator->struct_size > allocator->page_size)
+  // Os fetch-add que passam o fim da página não entregam blocos
+  uint64_t cursor = atomic_load(&allocator->cursor);
+  size_t page_chunks = allocator->page_size / allocator->chunk_size;
+  size_t offset_chunks = (cursor & CURSOR_OFFSET_MASK) / allocator->chunk_size;
+  return (cursor >> CURSOR_OFFSET_BITS) * page_chunks + (offset_chunks < page_chunks ? offset_chunks : page_chunks);
+}
+
+// Descarta todas as estruturas alocadas mantendo as páginas
+void allocator_reset(allocator_t* allocator)
+{
+  // Os blocos entregues continuam disponíveis depois do reset
+  size_t used = chunks_used(allocator);
+  if(used > allocator->max_chunks)
   {
-    allocator->current_page++;
-    allocator->offset = 0;
+    allocator->max_chunks = used;
+  }
 
-    // Se não houver páginas suficientes alocadas, alocar mais uma página
-    if(allocator->current_page >= allocator->num_pages)
+  // Uma nova geração invalida os blocos que as threads tinham deste alocador, o identificador (e a posição dos
+  // blocos nas threads) mantém-se
+  allocator->generation++;
+
+  // O cursor volta ao início da primeira página, as páginas seguintes são reutilizadas à medida que são precisas
+  atomic_store(&allocator->cursor, allocator->num_pages == 0 ? allocator->page_size : 0);
+}
+
+// Reserva os endereços de uma nova página, retorna NULL em caso de erro
+static void* page_reserve(allocator_t* allocator)
+{
+  // As páginas grandes explícitas ficam reservadas no mmap (sem MAP_NORESERVE um acesso sem páginas grandes
+  // livres seria um SIGBUS) e não é preciso disponibilizar blocos. Se não existirem páginas grandes livres
+  // no sistema passamos a utilizar páginas normais
+  if(allocator->flags & ALLOCATOR_HUGETLB)
+  {
+#ifdef MAP_HUGETLB
+    void* page = mmap(NULL, allocator->page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                      -1, 0);
+    if(page != MAP_FAILED)
     {
-      allocator->num_pages++;
-      allocator->pages = realloc(allocator->pages, allocator->num_pages * sizeof(void*));
-      allocator->pages[allocator->current_page] = malloc(allocator->page_size);
+      return page;
     }
+#endif
+    allocator->flags &= ~ALLOCATOR_HUGETLB;
+  }
+
+  // Apenas endereços, sem memória, os blocos são disponibilizados à medida que são entregues
+  void* page = mmap(NULL, allocator->page_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if(page == MAP_FAILED)
+  {
+    return NULL;
   }
 
-  // Calcular o endereço de retorno e atualizar o offset
-  void* ptr = (char*)allocator->pages[allocator->current_page] + allocator->offset;
-  allocator->offset += allocator->struct_size;
+#ifdef MADV_HUGEPAGE
+  if(allocator->flags & ALLOCATOR_HUGE_PAGES)
+  {
+    madvise(page, allocator->page_size, MADV_HUGEPAGE);
+  }
+#endif
 
-  // Liberta o acesso ao alocador
+  return page;
+}
+
+// Acrescenta a nova página ao array de páginas e ao índice ordenado pelo endereço, as páginas são poucas e
+// raramente reservadas, a inserção desloca os índices seguintes
+static void page_add(allocator_t* allocator, void* page)
+{
+  size_t position = allocator->num_pages;
+  while(position > 0 && (char*)allocator->pages[allocator->sorted_pages[position - 1]] > (char*)page)
+  {
+    allocator->sorted_pages[position] = allocator->sorted_pages[position - 1];
+    position--;
+  }
+  allocator->sorted_pages[position] = allocator->num_pages;
+  allocator->pages[allocator->num_pages++] = page;
+}
+
+// Passa o cursor para a página seguinte caso continue a apontar para o fim da página cheia, a página seguinte
+// pode já existir (depois de allocator_reset), retorna falso em caso de erro
+static bool page_next(allocator_t* allocator, uint64_t full_page)
+{
+  bool ok = true;
+
+  // Bloqueia o acesso às páginas
+  pthread_mutex_lock(&allocator->mutex);
+
+  // Outra thread pode já ter mudado de página
+  uint64_t cursor = atomic_load(&allocator->cursor);
+  if(cursor >> CURSOR_OFFSET_BITS == full_page && (cursor & CURSOR_OFFSET_MASK) + allocator->chunk_size > allocator->page_size)
+  {
+    // Sem páginas o cursor aponta para o fim da página 0, que ainda não existe
+    size_t next = allocator->num_pages == 0 ? 0 : full_page + 1;
+    if(next == allocator->num_pages)
+    {
+      void* page = allocator->num_pages < ALLOCATOR_MAX_PAGES ? page_reserve(allocator) : NULL;
+      if(page == NULL)
+      {
+        ok = false;
+      }
+      else
+      {
+        page_add(allocator, page);
+      }
+    }
+
+    // A página é publicada antes do cursor que a utiliza
+    if(ok)
+    {
+      atomic_store(&allocator->cursor, (uint64_t)next << CURSOR_OFFSET_BITS);
+    }
+  }
+
+  // Liberta o acesso às páginas
   pthread_mutex_unlock(&allocator->mutex);
 
-  return ptr;
+  return ok;
+}
+
+// Entrega um novo bloco à thread atual e aloca a primeira estrutura, retorna NULL em caso de erro
+static void* chunk_refill(allocator_t* allocator, allocator_cache_t* cache)
+{
+  for(;;)
+  {
+    uint64_t cursor = atomic_fetch_add(&allocator->cursor, allocator->chunk_size);
+    uint64_t page_index = cursor >> CURSOR_OFFSET_BITS;
+    uint64_t offset = cursor & CURSOR_OFFSET_MASK;
+
+    if(offset + allocator->chunk_size > allocator->page_size)
+    {
+      // A página está cheia (ou ainda não existe nenhuma)
+      if(!page_next(allocator, page_index))
+      {
+        return NULL;
+      }
+      continue;
+    }
+
+    // O bloco só é disponibilizado pela thread que o recebe, os blocos não se sobrepõem (nas páginas grandes
+    // explícitas o bloco já está disponível e o mprotect não tem efeito)
+    char* chunk = (char*)allocator->pages[page_index] + offset;
+    if(mprotect(chunk, allocator->chunk_size, PROT_READ | PROT_WRITE) != 0)
+    {
+      return NULL;
+    }
+
+    cache->id = allocator->id;
+    cache->generation = allocator->generation;
+    cache->next = chunk + allocator->struct_size;
+    cache->end = chunk + allocator->chunk_size / allocator->struct_size * allocator->struct_size;
+    return chunk;
+  }
+}
+
+// Posição com o bloco do alocador na thread atual. Sem bloco é utilizada uma posição livre ou, com todas ocupadas,
+// as posições são substituídas por ordem, assim dois alocadores na mesma posição inicial não se substituem
+// um ao outro em cada alocação
+static allocator_cache_t* cache_find(allocator_t* allocator)
+{
+  size_t home = allocator->id & (ALLOCATOR_THREAD_CACHES - 1);
+  allocator_cache_t* free_cache = NULL;
+  for(size_t i = 0; i < ALLOCATOR_THREAD_CACHES; i++)
+  {
+    allocator_cache_t* cache = &thread_caches[(home + i) & (ALLOCATOR_THREAD_CACHES - 1)];
+    if(cache->id == allocator->id)
+    {
+      return cache;
+    }
+    if(cache->id == 0 && free_cache == NULL)
+    {
+      free_cache = cache;
+    }
+  }
+
+  if(free_cache != NULL)
+  {
+    return free_cache;
+  }
+  return &thread_caches[thread_cache_victim++ & (ALLOCATOR_THREAD_CACHES - 1)];
+}
+
+// Aloca uma estrutura de memória no alocador
+void* allocator_alloc(allocator_t* allocator)
+{
+  // Caminho rápido: avançar no bloco da thread, na posição inicial do alocador
+  allocator_cache_t* cache = &thread_caches[allocator->id & (ALLOCATOR_THREAD_CACHES - 1)];
+  if(cache->id != allocator->id)
+  {
+    cache = cache_find(allocator);
+  }
+  if(cache->id == allocator->id && cache->generation == allocator->generation && cache->next < cache->end)
+  {
+    void* ptr = cache->next;
+    cache->next += allocator->struct_size;
+    return ptr;
+  }
+
+  // A thread ainda não tem bloco deste alocador ou o bloco está cheio
+  return chunk_refill(allocator, cache);
+}
+
+// Soma a memória do alocador
+void allocator_memory(allocator_t* allocator, memory_usage_t* usage)
+{
+  size_t used = chunks_used(allocator);
+  size_t reserved = used > allocator->max_chunks ? used : allocator->max_chunks;
+  usage->reserved += sizeof(allocator_t) + reserved * allocator->chunk_size;
+  usage->used += used * allocator->chunk_size;
+}
+
+// Índice de uma estrutura alocada
+size_t allocator_index_of(allocator_t* allocator, const void* ptr)
+{
+  // Pesquisa binária da última página que começa antes do ponteiro
+  size_t low = 0;
+  size_t high = allocator->num_pages;
+  while(low < high)
+  {
+    size_t middle = low + (high - low) / 2;
+    if((const char*)allocator->pages[allocator->sorted_pages[middle]] <= (const char*)ptr)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+  if(low == 0)
+  {
+    return SIZE_MAX;
+  }
+
+  size_t page = allocator->sorted_pages[low - 1];
+  const char* start = (const char*)allocator->pages[page];
+  if((const char*)ptr >= start + allocator->page_size)
+  {
+    return SIZE_MAX;
+  }
+
+  size_t offset = (size_t)((const char*)ptr - start);
+  return page * allocator->page_structs + offset / allocator->chunk_size * allocator->chunk_structs +
+         offset % allocator->chunk_size / allocator->struct_size;
 }
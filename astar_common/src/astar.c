@@ -3,6 +3,42 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
+
+void a_star_options_default(a_star_options_t* options)
+{
+  options->open_set_type = MIN_HEAP_4ARY;
+  options->tie_policy = MIN_HEAP_TIE_HIGH_G;
+  options->expansion_batch = 0;
+  options->compact_nodes = false;
+  options->outbox_size = 64;
+  options->outbox_expansions = 16;
+  options->steal_batch = 0;
+}
+
+// Limpa a solução, o estado a atingir e as estatísticas
+static void a_star_reset_search(a_star_t* a_star)
+{
+  free(a_star->solution_path);
+  a_star->solution_path = NULL;
+  a_star->solution = NULL;
+  a_star->goal_state = NULL;
+  atomic_store(&a_star->allocation_error, false);
+
+  // Reinicia as estatísticas
+  a_star->generated = 0;
+  a_star->expanded = 0;
+  a_star->max_min_heap_size = 0;
+  a_star->nodes_new = 0;
+  a_star->nodes_reinserted = 0;
+  a_star->paths_better = 0;
+  a_star->paths_worst_or_equals = 0;
+  a_star->num_solutions = 0;
+  a_star->num_worst_solutions = 0;
+  a_star->num_better_solutions = 0;
+  a_star->execution_time = 0;
+  memset(&a_star->memory, 0, sizeof(a_star->memory));
+}
 
 // Funções internas do algoritmo
 a_star_t* a_star_create(size_t struct_size,
@@ -10,7 +46,8 @@ a_star_t* a_star_create(size_t struct_size,
                         visit_function visit_func,
                         heuristic_function h_func,
                         distance_function d_func,
-                        print_function print_func)
+                        print_function print_func,
+                        const a_star_options_t* options)
 {
   a_star_t* a_star = (a_star_t*)malloc(sizeof(a_star_t));
   if(a_star == NULL)
@@ -21,15 +58,38 @@ a_star_t* a_star_create(size_t struct_size,
   // Garante que a memória fique limpa
   a_star->state_allocator = NULL;
   a_star->node_allocator = NULL;
+  a_star->node_store = NULL;
+  a_star->solution_path = NULL;
+
+  // Guarda as opções de configuração
+  if(options != NULL)
+  {
+    a_star->options = *options;
+  }
+  else
+  {
+    a_star_options_default(&a_star->options);
+  }
 
-  // Inicializa os nossos gestores de nós e estados
-  a_star->state_allocator = state_allocator_create(struct_size);
+  // Inicializa os nossos gestores de nós e estados, os nós compactos não ocupam espaço junto dos estados
+  size_t node_size = a_star->options.compact_nodes ? 0 : sizeof(a_star_node_t);
+  a_star->state_allocator = state_allocator_create(struct_size, node_size);
   if(a_star->state_allocator == NULL)
   {
     a_star_destroy(a_star);
     return NULL;
   }
 
+  if(a_star->options.compact_nodes)
+  {
+    a_star->node_store = node_store_create(a_star->state_allocator->allocator);
+    if(a_star->node_store == NULL)
+    {
+      a_star_destroy(a_star);
+      return NULL;
+    }
+  }
+
   a_star->node_allocator = node_allocator_create(print_func);
   if(a_star->node_allocator == NULL)
   {
@@ -43,25 +103,26 @@ a_star_t* a_star_create(size_t struct_size,
   a_star->h_func = h_func;
   a_star->d_func = d_func;
 
-  // Limpa solução e estado a atingir
-  a_star->solution = NULL;
-  a_star->goal_state = NULL;
-
-  // Reinicia as estatísticas
-  a_star->generated = 0;
-  a_star->expanded = 0;
-  a_star->max_min_heap_size = 0;
-  a_star->nodes_new = 0;
-  a_star->nodes_reinserted = 0;
-  a_star->paths_better = 0;
-  a_star->paths_worst_or_equals = 0;
-  a_star->num_solutions = 0;
-  a_star->num_worst_solutions = 0;
-  a_star->num_better_solutions = 0;
+  // Limpa solução, estado a atingir e estatísticas
+  a_star_reset_search(a_star);
 
   return a_star;
 }
 
+// Prepara a instância para resolver outro problema
+void a_star_reset(a_star_t* a_star)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  // Os nós estão junto dos estados, descartar os estados também descarta os nós
+  state_allocator_reset(a_star->state_allocator);
+  node_store_reset(a_star->node_store);
+  a_star_reset_search(a_star);
+}
+
 void a_star_destroy(a_star_t* a_star)
 {
   if(a_star == NULL)
@@ -72,10 +133,97 @@ void a_star_destroy(a_star_t* a_star)
   // Limpamos a nossas estruturas
   state_allocator_destroy(a_star->state_allocator);
   node_allocator_destroy(a_star->node_allocator);
+  node_store_destroy(a_star->node_store);
+  free(a_star->solution_path);
   // Destruímos o nosso algoritmo
   free(a_star);
 }
 
+// Guarda a solução encontrada com nós compactos
+bool a_star_set_compact_solution(a_star_t* a_star, node_id_t goal)
+{
+  node_store_t* store = a_star->node_store;
+
+  // Comprimento do caminho até ao nó inicial
+  size_t length = 0;
+  for(node_id_t id = goal; id != NODE_NONE; id = store->parent[id])
+  {
+    length++;
+  }
+
+  a_star_node_t* path = (a_star_node_t*)malloc(length * sizeof(a_star_node_t));
+  if(path == NULL)
+  {
+    return false;
+  }
+
+  // O primeiro nó é o objetivo, cada nó aponta para o seguinte
+  size_t i = 0;
+  for(node_id_t id = goal; id != NODE_NONE; id = store->parent[id], i++)
+  {
+    path[i].g = store->g[id];
+    path[i].h = store->h[id];
+    path[i].parent = i + 1 < length ? &path[i + 1] : NULL;
+    path[i].state = node_store_state(store, id);
+    path[i].index_in_open_set = SIZE_MAX;
+  }
+
+  free(a_star->solution_path);
+  a_star->solution_path = path;
+  a_star->solution = path;
+  return true;
+}
+
+// Mede a memória dos estados, da hashtable e dos nós
+void a_star_measure_memory(a_star_t* a_star)
+{
+  a_star_memory_t* memory = &a_star->memory;
+  memset(memory, 0, sizeof(*memory));
+
+  state_allocator_t* state_allocator = a_star->state_allocator;
+  memory->num_states = hashtable_count(state_allocator->states);
+
+  // A memória utilizada dos estados são os registos existentes, o resto dos blocos está livre
+  allocator_memory(state_allocator->allocator, &memory->states);
+  memory->states.reserved += sizeof(state_allocator_t);
+  memory->states.used = memory->num_states * state_allocator->allocator->struct_size;
+
+  hashtable_memory(state_allocator->states, &memory->hashtable);
+  if(a_star->node_store != NULL)
+  {
+    node_store_memory(a_star->node_store, &memory->nodes);
+  }
+}
+
+// Memória total de todas as partes do algoritmo
+static memory_usage_t memory_total(const a_star_memory_t* memory)
+{
+  memory_usage_t total = { 0, 0 };
+  memory_usage_add(&total, &memory->states);
+  memory_usage_add(&total, &memory->hashtable);
+  memory_usage_add(&total, &memory->nodes);
+  memory_usage_add(&total, &memory->open_set);
+  memory_usage_add(&total, &memory->channel);
+  return total;
+}
+
+// Pico da memória residente do processo em KB, 0 se não for possível obter
+static long peak_rss_kb(void)
+{
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0)
+  {
+    return 0;
+  }
+  return usage.ru_maxrss;
+}
+
+// Imprime uma linha com a memória de uma parte do algoritmo
+static void print_memory(const char* name, const memory_usage_t* usage)
+{
+  printf("- %s: %.2f MB reservados, %.2f MB utilizados\n", name, usage->reserved / 1048576.0, usage->used / 1048576.0);
+}
+
 // Imprime estatísticas do algoritmo sequencial no formato desejado
 void a_star_print_statistics(a_star_t* a_star, bool csv, bool show_solution)
 {
@@ -92,17 +240,25 @@ void a_star_print_statistics(a_star_t* a_star, bool csv, bool show_solution)
     }
   }
 
+  memory_usage_t total = memory_total(&a_star->memory);
+  double bytes_per_state = a_star->memory.num_states ? (double)total.reserved / a_star->memory.num_states : 0;
+
   if(!csv)
   {
     if(a_star->solution)
     {
       printf("Resultado do algoritmo: Solução encontrada, custo: %d\n", a_star->solution->g);
     }
+    else if(atomic_load(&a_star->allocation_error))
+    {
+      printf("Resultado do algoritmo: Procura interrompida por falta de memória.\n");
+    }
     else
     {
       printf("Resultado do algoritmo: Solução não encontrada.\n");
     }
     printf("Estatísticas Globais:\n");
+    printf("- Desempate nós abertos: %s\n", min_heap_tie_name(a_star->options.tie_policy));
     printf("- Estados gerados: %d\n", a_star->generated);
     printf("- Estados expandidos: %d\n", a_star->expanded);
     printf("- Max nós min_heap: %ld\n", a_star->max_min_heap_size);
@@ -113,11 +269,26 @@ void a_star_print_statistics(a_star_t* a_star, bool csv, bool show_solution)
     printf("- Soluções encontradas: %d\n", a_star->num_solutions);
     printf("- Soluções piores encontradas (não atualizadas): %d\n", a_star->num_worst_solutions);
     printf("- Soluções melhores encontradas (atualizadas): %d\n", a_star->num_better_solutions);
+    printf("Memória:\n");
+    print_memory("Estados", &a_star->memory.states);
+    print_memory("Hashtable dos estados", &a_star->memory.hashtable);
+    if(a_star->node_store != NULL)
+    {
+      print_memory("Nós compactos", &a_star->memory.nodes);
+    }
+    print_memory("Nós abertos", &a_star->memory.open_set);
+    if(a_star->memory.channel.reserved > 0)
+    {
+      print_memory("Canal", &a_star->memory.channel);
+    }
+    print_memory("Total", &total);
+    printf("- Memória por estado: %.1f bytes (%zu estados)\n", bytes_per_state, a_star->memory.num_states);
+    printf("- Pico de memória do processo (RSS): %.2f MB\n", peak_rss_kb() / 1024.0);
   }
   else
   {
-    printf("\"%s\";%d;%d;%d;%ld;%d;%d;%d;%d;%d;%d;%d;%.6f\n",
-           a_star->solution ? "sim" : "não",
+    printf("\"%s\";%d;%d;%d;%ld;%d;%d;%d;%d;%d;%d;%d;%.6f;%zu;%zu;%.1f;%ld\n",
+           a_star->solution ? "sim" : (atomic_load(&a_star->allocation_error) ? "erro" : "não"),
            a_star->solution ? a_star->solution->g : 0,
            a_star->generated,
            a_star->expanded,
@@ -129,6 +300,10 @@ void a_star_print_statistics(a_star_t* a_star, bool csv, bool show_solution)
            a_star->num_solutions,
            a_star->num_worst_solutions,
            a_star->num_better_solutions,
-           a_star->execution_time);
+           a_star->execution_time,
+           total.reserved,
+           total.used,
+           bytes_per_state,
+           peak_rss_kb());
   }
 }
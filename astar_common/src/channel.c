@@ -1,6 +1,20 @@
 #include "channel.h"
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+// Liberta os buffers e a sincronização das primeiras filas do canal
+static void destroy_queues(channel_t* channel, size_t num_queues)
+{
+  for(size_t i = 0; i < num_queues; i++)
+  {
+    channel_queue_t* queue = &channel->queues[i];
+    free(queue->write_buffer);
+    free(queue->read_buffer);
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->cond);
+  }
+}
 
 // Inicializa o canal com o número especificado de filas
 channel_t* channel_create(size_t num_queues, size_t struct_size)
@@ -11,59 +25,29 @@ channel_t* channel_create(size_t num_queues, size_t struct_size)
     return NULL;
   }
 
-  // Aloca espaço para o array de filas
-  channel->queues = malloc(num_queues * sizeof(void*));
+  // As filas ocupam linhas de cache separadas, o tamanho da estrutura já é múltiplo da linha de cache
+  channel->queues = (channel_queue_t*)aligned_alloc(CHANNEL_CACHE_LINE_SIZE, num_queues * sizeof(channel_queue_t));
   if(channel->queues == NULL)
   {
     free(channel);
     return NULL;
   }
 
-  channel->queue_pos = (size_t*)malloc(num_queues * sizeof(size_t));
-  if(channel->queue_pos == NULL)
-  {
-    free(channel->queues);
-    free(channel);
-    return NULL;
-  }
-
-  channel->queue_size = (size_t*)malloc(num_queues * sizeof(size_t));
-  if(channel->queue_size == NULL)
-  {
-    free(channel->queue_size);
-    free(channel->queues);
-    free(channel);
-    return NULL;
-  }
-
-  channel->queue_lock = (pthread_mutex_t*)malloc(num_queues * sizeof(pthread_mutex_t));
-  if(channel->queue_lock == NULL)
-  {
-    free(channel->queue_lock);
-    free(channel->queue_size);
-    free(channel->queues);
-    free(channel);
-    return NULL;
-  }
-
-  // // Inicializa cada fila
+  // Inicializa cada fila
   for(size_t i = 0; i < num_queues; i++)
   {
-    channel->queues[i] = malloc(QUEUE_BUFFER_SIZE * struct_size);
-    channel->queue_pos[i] = 0;
-    channel->queue_size[i] = QUEUE_BUFFER_SIZE;
-    pthread_mutex_init(&channel->queue_lock[i], NULL);
-    if(channel->queues[i] == NULL)
+    channel_queue_t* queue = &channel->queues[i];
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    queue->write_buffer = (char*)malloc(QUEUE_BUFFER_SIZE * struct_size);
+    queue->read_buffer = (char*)malloc(QUEUE_BUFFER_SIZE * struct_size);
+    atomic_init(&queue->write_count, 0);
+    queue->write_capacity = QUEUE_BUFFER_SIZE;
+    queue->read_capacity = QUEUE_BUFFER_SIZE;
+    if(queue->write_buffer == NULL || queue->read_buffer == NULL)
     {
       // Em caso de falha, destrói as filas já criadas e liberta a memória alocada
-      for(size_t j = 0; j < i; j++)
-      {
-        free(channel->queues[j]);
-        pthread_mutex_destroy(&(channel->queue_lock[j]));
-      }
-      free(channel->queue_lock);
-      free(channel->queue_size);
-      free(channel->queue_pos);
+      destroy_queues(channel, i + 1);
       free(channel->queues);
       free(channel);
       return NULL;
@@ -72,38 +56,69 @@ channel_t* channel_create(size_t num_queues, size_t struct_size)
 
   channel->num_queues = num_queues;
   channel->struct_size = struct_size;
+  channel->closed = false;
   return channel;
 }
 
 // Envia uma mensagem para uma fila específica no canal
-void channel_send(channel_t* channel, size_t queue_index, void* data)
+bool channel_send(channel_t* channel, size_t queue_index, void* data)
+{
+  return channel_send_batch(channel, queue_index, data, 1);
+}
+
+// Envia um bloco de mensagens para uma fila específica no canal
+bool channel_send_batch(channel_t* channel, size_t queue_index, void* data, size_t count)
 {
   // Verifica se o índice da fila é válido
   if(queue_index >= channel->num_queues)
   {
-    return; // Índice inválido
+    return false; // Índice inválido
+  }
+
+  if(count == 0)
+  {
+    return true;
   }
 
-  pthread_mutex_lock(&(channel->queue_lock[queue_index]));
+  channel_queue_t* queue = &channel->queues[queue_index];
+  pthread_mutex_lock(&queue->lock);
 
-  if(channel->queues[queue_index])
+  size_t size = atomic_load_explicit(&queue->write_count, memory_order_relaxed);
+  if(size + count > queue->write_capacity)
   {
-    if(channel->queue_pos[queue_index] + 1 > channel->queue_size[queue_index])
+    // Buffer de escrita cheio, duplicamos a capacidade até caberem as mensagens
+    size_t capacity = queue->write_capacity;
+    while(size + count > capacity)
     {
-      channel->queue_size[queue_index] *= 2;
-      channel->queues[queue_index] =
-          realloc(channel->queues[queue_index], channel->struct_size * channel->queue_size[queue_index]);
+      capacity *= 2;
     }
+    char* buffer = (char*)realloc(queue->write_buffer, capacity * channel->struct_size);
+    if(buffer == NULL)
+    {
+      pthread_mutex_unlock(&queue->lock);
+      return false;
+    }
+    queue->write_buffer = buffer;
+    queue->write_capacity = capacity;
+  }
 
-    memcpy(&(channel->queues[queue_index][channel->queue_pos[queue_index] * channel->struct_size]), data, channel->struct_size);
-    channel->queue_pos[queue_index]++;
+  memcpy(queue->write_buffer + size * channel->struct_size, data, count * channel->struct_size);
+  atomic_store_explicit(&queue->write_count, size + count, memory_order_relaxed);
+
+  // Acorda a thread da fila caso esteja bloqueada à espera de mensagens
+  if(size == 0)
+  {
+    pthread_cond_signal(&queue->cond);
   }
 
-  pthread_mutex_unlock(&(channel->queue_lock[queue_index]));
+  pthread_mutex_unlock(&queue->lock);
+  return true;
 }
 
+// Recebe todas as mensagens da fila, trocando os buffers de escrita e de leitura
 void* channel_receive(channel_t* channel, size_t queue_index, size_t* len)
 {
+  *len = 0;
   if(channel == NULL)
   {
     return NULL;
@@ -115,51 +130,143 @@ void* channel_receive(channel_t* channel, size_t queue_index, size_t* len)
     return NULL; // Índice inválido
   }
 
-  pthread_mutex_lock(&(channel->queue_lock[queue_index]));
+  channel_queue_t* queue = &channel->queues[queue_index];
+  pthread_mutex_lock(&queue->lock);
 
-  *len = channel->queue_pos[queue_index];
-  if( channel->queue_pos[queue_index] == 0)
+  size_t count = atomic_load_explicit(&queue->write_count, memory_order_relaxed);
+  if(count == 0)
   {
+    pthread_mutex_unlock(&queue->lock);
     return NULL;
   }
 
-  void* queue_data = malloc(channel->struct_size * channel->queue_pos[queue_index]);
+  // As mensagens da receção anterior já não são utilizadas, o seu buffer passa a ser o de escrita
+  char* buffer = queue->write_buffer;
+  size_t capacity = queue->write_capacity;
+  queue->write_buffer = queue->read_buffer;
+  queue->write_capacity = queue->read_capacity;
+  queue->read_buffer = buffer;
+  queue->read_capacity = capacity;
+  atomic_store_explicit(&queue->write_count, 0, memory_order_relaxed);
 
-  if(!queue_data)
+  pthread_mutex_unlock(&queue->lock);
+
+  *len = count;
+  return buffer;
+}
+
+// Bloqueia até existirem mensagens na fila ou o canal ser fechado
+bool channel_wait(channel_t* channel, size_t queue_index)
+{
+  if(channel == NULL || queue_index >= channel->num_queues)
   {
-    *len = 0;
-    return NULL;
+    return false;
   }
 
-  // Copia os dados e limpa a memoria, e coloca a posicao a 0
-  memcpy(queue_data, channel->queues[queue_index], channel->struct_size * channel->queue_pos[queue_index]);
-  channel->queue_pos[queue_index] = 0;
+  channel_queue_t* queue = &channel->queues[queue_index];
+  pthread_mutex_lock(&queue->lock);
+  while(atomic_load_explicit(&queue->write_count, memory_order_relaxed) == 0 && !channel->closed)
+  {
+    pthread_cond_wait(&queue->cond, &queue->lock);
+  }
+  bool closed = channel->closed;
+  pthread_mutex_unlock(&queue->lock);
 
-  pthread_mutex_unlock(&(channel->queue_lock[queue_index]));
-  return queue_data;
+  return !closed;
 }
 
-// Liberta a memória alocada para o canal
-void channel_destroy(channel_t* channel)
+// Bloqueia até existirem mensagens na fila, o canal ser fechado ou passar o tempo indicado
+bool channel_wait_timed(channel_t* channel, size_t queue_index, long timeout_ns)
+{
+  if(channel == NULL || queue_index >= channel->num_queues)
+  {
+    return false;
+  }
+
+  // O tempo limite das variáveis de condição é absoluto
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += timeout_ns / 1000000000L;
+  deadline.tv_nsec += timeout_ns % 1000000000L;
+  if(deadline.tv_nsec >= 1000000000L)
+  {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+
+  channel_queue_t* queue = &channel->queues[queue_index];
+  pthread_mutex_lock(&queue->lock);
+  while(atomic_load_explicit(&queue->write_count, memory_order_relaxed) == 0 && !channel->closed)
+  {
+    if(pthread_cond_timedwait(&queue->cond, &queue->lock, &deadline) != 0)
+    {
+      break; // Tempo esgotado
+    }
+  }
+  bool closed = channel->closed;
+  pthread_mutex_unlock(&queue->lock);
+
+  return !closed;
+}
+
+// Fecha o canal e acorda todas as threads bloqueadas
+void channel_close(channel_t* channel)
+{
+  if(channel == NULL)
+  {
+    return;
+  }
+
+  // O estado é alterado com o mutex de cada fila, assim nenhuma thread perde o aviso entre verificar e bloquear
+  for(size_t i = 0; i < channel->num_queues; i++)
+  {
+    channel_queue_t* queue = &channel->queues[i];
+    pthread_mutex_lock(&queue->lock);
+    channel->closed = true;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+  }
+}
+
+// Descarta as mensagens de todas as filas, mantendo a memória das filas
+void channel_reset(channel_t* channel)
 {
   if(channel == NULL)
   {
     return;
   }
 
-  // Liberta cada fila e o array de filas
   for(size_t i = 0; i < channel->num_queues; i++)
   {
-    pthread_mutex_lock(&channel->queue_lock[i]);
-    free(channel->queues[i]);
-    channel->queue_pos[i] = 0;
-    channel->queue_size[i] = 0;
-    pthread_mutex_unlock(&channel->queue_lock[i]);
-    pthread_mutex_destroy(&channel->queue_lock[i]);
+    channel_queue_t* queue = &channel->queues[i];
+    pthread_mutex_lock(&queue->lock);
+    atomic_store_explicit(&queue->write_count, 0, memory_order_relaxed);
+    pthread_mutex_unlock(&queue->lock);
+  }
+  channel->closed = false;
+}
+
+// Soma a memória das filas do canal
+void channel_memory(channel_t* channel, memory_usage_t* usage)
+{
+  usage->reserved += sizeof(channel_t) + channel->num_queues * sizeof(channel_queue_t);
+  for(size_t i = 0; i < channel->num_queues; i++)
+  {
+    channel_queue_t* queue = &channel->queues[i];
+    usage->reserved += (queue->write_capacity + queue->read_capacity) * channel->struct_size;
+    usage->used += atomic_load_explicit(&queue->write_count, memory_order_relaxed) * channel->struct_size;
   }
-  free(channel->queue_lock);
-  free(channel->queue_size);
-  free(channel->queue_pos);
+}
+
+// Liberta a memória alocada para o canal
+void channel_destroy(channel_t* channel)
+{
+  if(channel == NULL)
+  {
+    return;
+  }
+
+  destroy_queues(channel, channel->num_queues);
   free(channel->queues);
   free(channel);
 }
@@ -177,5 +284,6 @@ bool channel_has_messages(channel_t* channel, size_t queue_index)
     return false; // Índice inválido
   }
 
-  return channel->queue_pos[queue_index];
+  // Leitura sem o mutex, a mensagem é obtida mais tarde com channel_receive()
+  return atomic_load_explicit(&channel->queues[queue_index].write_count, memory_order_relaxed) > 0;
 }
@@ -1,29 +1,363 @@
 #include "hashtable.h"
+#include <sched.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Função de hashing utilizada
-size_t hash_function(const void* data, size_t size, size_t mod)
+// Número de bits do hash utilizados para escolher a partição (HASH_MAX_MUTEXES é uma potência de 2)
+#define SHARD_BITS 13
+
+// Ocupação máxima de uma partição (numerador e denominador) antes de duplicar o seu tamanho
+#define MAX_LOAD_NUM 3
+#define MAX_LOAD_DEN 4
+
+// Hash de uma entrada livre
+#define EMPTY_HASH 0
+
+// Constantes utilizadas pela função de hash (as mesmas do wyhash)
+#define HASH_SECRET_0 0xa0761d6478bd642fULL
+#define HASH_SECRET_1 0xe7037ed1a0b428dbULL
+#define HASH_SECRET_2 0x8ebc6af09c88c6e3ULL
+#define HASH_SECRET_3 0x589965cc75374cc3ULL
+
+// Multiplicação de 64 bits com resultado de 128 bits, retorna as duas metades misturadas
+static inline uint64_t hash_mix(uint64_t a, uint64_t b)
 {
-  const unsigned char* bytes = (const unsigned char*)data;
+  __uint128_t r = (__uint128_t)a * b;
+  return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+// Leituras sem restrições de alinhamento
+static inline uint64_t read64(const unsigned char* p)
+{
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
 
-  // Calcula o valor hash inicial
-  size_t hash_value = 0;
-  size_t mul = 1;
-  for(size_t i = 0; i < size; ++i)
+static inline uint64_t read32(const unsigned char* p)
+{
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Função de hashing utilizada, segue a estrutura do wyhash: os dados são consumidos 16 bytes de cada vez
+// (48 bytes em 3 acumuladores independentes para dados grandes) e cada passo é uma multiplicação de 128 bits
+size_t hash_function(const void* data, size_t size)
+{
+  const unsigned char* p = (const unsigned char*)data;
+  uint64_t seed = hash_mix(HASH_SECRET_0, HASH_SECRET_1);
+  uint64_t a, b;
+
+  if(size <= 16)
   {
-    mul = (i % 4 == 0) ? 1 : mul * 256;
-    hash_value += bytes[i] * mul;
+    if(size >= 4)
+    {
+      // Duas leituras de 4 bytes em cada ponta, que se sobrepõem quando size < 8
+      size_t middle = (size >> 3) << 2;
+      a = (read32(p) << 32) | read32(p + middle);
+      b = (read32(p + size - 4) << 32) | read32(p + size - 4 - middle);
+    }
+    else if(size > 0)
+    {
+      a = ((uint64_t)p[0] << 16) | ((uint64_t)p[size >> 1] << 8) | p[size - 1];
+      b = 0;
+    }
+    else
+    {
+      a = b = 0;
+    }
+  }
+  else
+  {
+    size_t remaining = size;
+    if(remaining > 48)
+    {
+      uint64_t seed1 = seed, seed2 = seed;
+      do
+      {
+        seed = hash_mix(read64(p) ^ HASH_SECRET_1, read64(p + 8) ^ seed);
+        seed1 = hash_mix(read64(p + 16) ^ HASH_SECRET_2, read64(p + 24) ^ seed1);
+        seed2 = hash_mix(read64(p + 32) ^ HASH_SECRET_3, read64(p + 40) ^ seed2);
+        p += 48;
+        remaining -= 48;
+      } while(remaining > 48);
+      seed ^= seed1 ^ seed2;
+    }
+
+    while(remaining > 16)
+    {
+      seed = hash_mix(read64(p) ^ HASH_SECRET_1, read64(p + 8) ^ seed);
+      p += 16;
+      remaining -= 16;
+    }
+
+    // Os últimos 16 bytes (que se podem sobrepor aos anteriores)
+    a = read64(p + remaining - 16);
+    b = read64(p + remaining - 8);
   }
 
-  // Retorna o índice do bucket
-  return hash_value % mod;
+  // Mistura final
+  __uint128_t r = (__uint128_t)(a ^ HASH_SECRET_1) * (b ^ seed);
+  return (size_t)hash_mix((uint64_t)r ^ HASH_SECRET_0 ^ size, (uint64_t)(r >> 64) ^ HASH_SECRET_1);
 }
 
-// Função para calcular o índice do bucket na hashtable
+// Função de hash por defeito, utiliza todos os bytes da struct
 static size_t hash(hashtable_t* hashtable, const void* data)
 {
-  return hash_function(data, hashtable->struct_size, hashtable->capacity);
+  return hash_function(data, hashtable->struct_size);
+}
+
+// Mistura os bits do hash fornecido (finalizador do MurmurHash3), desta forma funções de hash fornecidas
+// com valores pequenos ou pouco distribuídos continuam a espalhar as entradas pelas partições e posições.
+// O valor 0 indica uma entrada livre e não pode ser utilizado
+static inline size_t mix(size_t value)
+{
+  uint64_t h = (uint64_t)value;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h == EMPTY_HASH ? 1 : (size_t)h;
+}
+
+// Partição onde se encontra um hash
+static inline hashtable_shard_t* shard_of(hashtable_t* hashtable, size_t hash_value)
+{
+  return &hashtable->shards[hash_value & (HASH_MAX_MUTEXES - 1)];
+}
+
+// Posição inicial de um hash dentro de um array, utiliza bits diferentes dos da partição
+static inline size_t slot_of(hashtable_array_t* array, size_t hash_value)
+{
+  return (hash_value >> SHARD_BITS) & (array->capacity - 1);
+}
+
+// Verifica se os dados de uma entrada (com o mesmo hash) são iguais aos dados procurados
+static inline bool equals(hashtable_t* hashtable, const void* entry_data, const void* data)
+{
+  // Se não fornecemos um comparador utilizamos o comparador por defeito
+  if(hashtable->cmp_func == NULL)
+  {
+    return memcmp(entry_data, data, hashtable->struct_size) == 0;
+  }
+
+  // utiliza o comparador fornecido para verificar se os elementos são iguais
+  return hashtable->cmp_func(hashtable, entry_data, data);
+}
+
+// Dados de uma entrada ocupada, o hash é ocupado antes de os dados serem publicados e nesse
+// intervalo esperamos pela thread que está a inserir
+static inline void* entry_data(hashtable_entry_t* entry)
+{
+  void* data;
+  while((data = atomic_load_explicit(&entry->data, memory_order_acquire)) == NULL)
+  {
+    sched_yield();
+  }
+  return data;
+}
+
+// Procura os dados num array, sem locks
+static void* array_find(hashtable_t* hashtable, hashtable_array_t* array, size_t hash_value, const void* data)
+{
+  size_t mask = array->capacity - 1;
+  size_t index = slot_of(array, hash_value);
+
+  for(;;)
+  {
+    hashtable_entry_t* entry = &array->entries[index];
+    size_t entry_hash = atomic_load_explicit(&entry->hash, memory_order_acquire);
+    if(entry_hash == EMPTY_HASH)
+    {
+      return NULL;
+    }
+    if(entry_hash == hash_value)
+    {
+      void* found = entry_data(entry);
+      if(equals(hashtable, found, data))
+      {
+        return found;
+      }
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+// Insere os dados num array caso ainda não existam, retorna os dados existentes ou os dados inseridos.
+// Duas threads com os mesmos dados percorrem as mesmas posições, a que perde o compare-and-swap de uma
+// entrada livre volta a verificar essa entrada e encontra os dados da outra
+static void* array_insert(hashtable_t* hashtable, hashtable_array_t* array, size_t hash_value, void* data)
+{
+  size_t mask = array->capacity - 1;
+  size_t index = slot_of(array, hash_value);
+
+  for(;;)
+  {
+    hashtable_entry_t* entry = &array->entries[index];
+    size_t entry_hash = atomic_load_explicit(&entry->hash, memory_order_acquire);
+    if(entry_hash == EMPTY_HASH)
+    {
+      if(atomic_compare_exchange_strong_explicit(
+             &entry->hash, &entry_hash, hash_value, memory_order_acq_rel, memory_order_acquire))
+      {
+        atomic_store_explicit(&entry->data, data, memory_order_release);
+        return data;
+      }
+      // entry_hash tem agora o hash de quem ocupou a entrada
+    }
+    if(entry_hash == hash_value)
+    {
+      void* found = entry_data(entry);
+      if(equals(hashtable, found, data))
+      {
+        return found;
+      }
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+// Coloca uma entrada transferida na primeira posição livre do array, os dados transferidos não existem
+// no array (as inserções verificam primeiro o array anterior) e não é necessário compará-los
+static void array_place(hashtable_array_t* array, size_t hash_value, void* data)
+{
+  size_t mask = array->capacity - 1;
+  size_t index = slot_of(array, hash_value);
+
+  for(;;)
+  {
+    hashtable_entry_t* entry = &array->entries[index];
+    size_t expected = EMPTY_HASH;
+    if(atomic_compare_exchange_strong_explicit(
+           &entry->hash, &expected, hash_value, memory_order_acq_rel, memory_order_acquire))
+    {
+      atomic_store_explicit(&entry->data, data, memory_order_release);
+      return;
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+// Aloca um array vazio
+static hashtable_array_t* array_create(size_t capacity, hashtable_array_t* prev)
+{
+  hashtable_array_t* array =
+      (hashtable_array_t*)calloc(1, sizeof(hashtable_array_t) + capacity * sizeof(hashtable_entry_t));
+  if(array == NULL)
+  {
+    return NULL;
+  }
+
+  array->capacity = capacity;
+  atomic_init(&array->size, 0);
+  atomic_init(&array->writers, 0);
+  atomic_init(&array->ready, prev == NULL);
+  atomic_init(&array->prev, prev);
+  return array;
+}
+
+// Transfere até steps posições do array anterior para o array atual (o mutex da partição tem de estar
+// bloqueado). Os hashes estão guardados e não é necessário voltar a calculá-los. O array anterior não é
+// alterado para que as procuras continuem a funcionar até a transferência terminar
+static void shard_migrate(hashtable_array_t* array, size_t steps)
+{
+  hashtable_array_t* prev = atomic_load_explicit(&array->prev, memory_order_relaxed);
+  if(prev == NULL)
+  {
+    return;
+  }
+
+  size_t end = prev->capacity;
+  if(steps < end - array->migrate_pos)
+  {
+    end = array->migrate_pos + steps;
+  }
+
+  for(size_t i = array->migrate_pos; i < end; i++)
+  {
+    size_t entry_hash = atomic_load_explicit(&prev->entries[i].hash, memory_order_acquire);
+    if(entry_hash != EMPTY_HASH)
+    {
+      array_place(array, entry_hash, entry_data(&prev->entries[i]));
+    }
+  }
+  array->migrate_pos = end;
+
+  if(array->migrate_pos == prev->capacity)
+  {
+    // As procuras que ainda estejam a ler o array anterior continuam válidas, o array só é libertado no fim
+    prev->retired = array->retired;
+    array->retired = prev;
+    atomic_store_explicit(&array->prev, NULL, memory_order_release);
+  }
+}
+
+// Array atual da partição, alocado na primeira inserção
+static hashtable_array_t* shard_array(hashtable_t* hashtable, hashtable_shard_t* shard)
+{
+  hashtable_array_t* array = atomic_load_explicit(&shard->array, memory_order_acquire);
+  if(array != NULL)
+  {
+    return array;
+  }
+
+  pthread_mutex_lock(&shard->mutex);
+  array = atomic_load_explicit(&shard->array, memory_order_acquire);
+  if(array == NULL)
+  {
+    array = array_create(hashtable->shard_capacity, NULL);
+    if(array != NULL)
+    {
+      // A partição passa a ter entradas a limpar em hashtable_reset
+      hashtable->used_shards[atomic_fetch_add(&hashtable->num_used_shards, 1)] = (uint16_t)(shard - hashtable->shards);
+    }
+    atomic_store_explicit(&shard->array, array, memory_order_release);
+  }
+  pthread_mutex_unlock(&shard->mutex);
+
+  return array;
+}
+
+// Substitui o array atual da partição por um com o dobro do tamanho, caso ainda não tenha sido substituído
+static void shard_grow(hashtable_shard_t* shard, hashtable_array_t* array)
+{
+  pthread_mutex_lock(&shard->mutex);
+
+  if(atomic_load(&shard->array) != array)
+  {
+    // Outra thread já fez crescer a partição
+    pthread_mutex_unlock(&shard->mutex);
+    return;
+  }
+
+  // Um crescimento anterior ainda por terminar é concluído
+  shard_migrate(array, SIZE_MAX);
+
+  hashtable_array_t* grown = array_create(array->capacity * 2, array);
+  if(grown == NULL)
+  {
+    pthread_mutex_unlock(&shard->mutex);
+    return;
+  }
+  grown->retired = array->retired;
+  array->retired = NULL;
+
+  // A partir daqui as inserções novas utilizam o novo array, esperamos que as que ainda estão a decorrer
+  // no array anterior terminem, depois disso o array anterior já não é alterado
+  atomic_store(&shard->array, grown);
+  while(atomic_load(&array->writers) != 0)
+  {
+    sched_yield();
+  }
+
+  // As entradas do array anterior ficam reservadas no novo array antes de este aceitar inserções
+  atomic_store_explicit(&grown->size, atomic_load(&array->size), memory_order_relaxed);
+  atomic_store_explicit(&grown->ready, true, memory_order_release);
+
+  pthread_mutex_unlock(&shard->mutex);
 }
 
 // Inicializa uma nova hashtable
@@ -38,16 +372,24 @@ hashtable_t* hashtable_create(size_t struct_size, hashtable_compare_func cmp_fun
   // Define o tamanho da struct
   hashtable->struct_size = struct_size;
 
-  // Define a capacidade inicial da hashtable
-  hashtable->capacity = HASH_CAPACITY;
+  // A capacidade inicial é dividida pelas partições, cada partição só aloca entradas quando é utilizada
+  hashtable->shard_capacity = 8;
+  while(hashtable->shard_capacity * HASH_MAX_MUTEXES < HASH_CAPACITY)
+  {
+    hashtable->shard_capacity *= 2;
+  }
 
-  // Aloca memória para os buckets da hashtable
-  hashtable->buckets = (entry_t**)calloc(hashtable->capacity, sizeof(entry_t*));
-  if(hashtable->buckets == NULL)
+  // Aloca memória para as partições da hashtable
+  hashtable->shards = (hashtable_shard_t*)calloc(HASH_MAX_MUTEXES, sizeof(hashtable_shard_t));
+  hashtable->used_shards = (uint16_t*)malloc(HASH_MAX_MUTEXES * sizeof(uint16_t));
+  if(hashtable->shards == NULL || hashtable->used_shards == NULL)
   {
+    free(hashtable->shards);
+    free(hashtable->used_shards);
     free(hashtable);
     return NULL;
   }
+  atomic_init(&hashtable->num_used_shards, 0);
 
   hashtable->cmp_func = cmp_func;
   hashtable->hash_func = hash_func;
@@ -56,204 +398,249 @@ hashtable_t* hashtable_create(size_t struct_size, hashtable_compare_func cmp_fun
     hashtable->hash_func = hash;
   }
 
-  // Inicializa os mutexes para cada bucket
-  hashtable->mutexes = (pthread_mutex_t*)malloc(HASH_MAX_MUTEXES * sizeof(pthread_mutex_t));
-  if(hashtable->mutexes == NULL)
-  {
-    free(hashtable->buckets);
-    free(hashtable);
-    return NULL;
-  }
+  // Inicializa as partições
   for(size_t i = 0; i < HASH_MAX_MUTEXES; ++i)
   {
-    pthread_mutex_init(&hashtable->mutexes[i], NULL);
+    atomic_init(&hashtable->shards[i].array, NULL);
+    pthread_mutex_init(&hashtable->shards[i].mutex, NULL);
   }
 
   return hashtable;
 }
 
-// Insere uma struct na hashtable
+// Insere uma struct na hashtable, caso já exista uma igual a struct não é inserida
 void hashtable_insert(hashtable_t* hashtable, void* data)
 {
-  // Calcula o índice do bucket
-  size_t index = hashtable->hash_func(hashtable, data);
+  hashtable_insert_if_absent(hashtable, data);
+}
+
+// Verifica se uma struct já está na hashtable, retorna o ponteira para os
+// dados caso exista, NULL caso não exista
+void* hashtable_contains(hashtable_t* hashtable, const void* data)
+{
+  // Calcula o hash e a partição correspondente
+  size_t hash_value = mix(hashtable->hash_func(hashtable, data));
+  hashtable_shard_t* shard = shard_of(hashtable, hash_value);
 
-  // Cria uma nova entrada
-  entry_t* entry = (entry_t*)malloc(sizeof(entry_t));
-  if(entry == NULL)
+  hashtable_array_t* array = atomic_load_explicit(&shard->array, memory_order_acquire);
+  if(array == NULL)
   {
-    return;
+    return NULL;
   }
 
-  // Copia os dados da struct para a entrada
-  entry->data = data;
-
-  // Calcula o mutex para este índice
-  int mutex_id = index % HASH_MAX_MUTEXES;
+  // O array anterior é lido antes de procurar no atual: se a transferência já tinha terminado, todas as
+  // entradas estão no array atual
+  hashtable_array_t* prev = atomic_load_explicit(&array->prev, memory_order_acquire);
+  void* found = array_find(hashtable, array, hash_value, data);
+  if(found == NULL && prev != NULL)
+  {
+    found = array_find(hashtable, prev, hash_value, data);
+  }
 
-  // bloqueia o respetivo bucket
-  pthread_mutex_lock(&hashtable->mutexes[mutex_id]);
+  return found;
+}
 
-  // Insere a entrada no início do bucket
-  entry->next = hashtable->buckets[index];
-  hashtable->buckets[index] = entry;
+// Antecipa o acesso à posição onde se encontram (ou seriam inseridos) os dados com o hash indicado
+void hashtable_prefetch(hashtable_t* hashtable, size_t hash_value)
+{
+  hash_value = mix(hash_value);
+  hashtable_array_t* array = atomic_load_explicit(&shard_of(hashtable, hash_value)->array, memory_order_acquire);
+  if(array != NULL)
+  {
+    __builtin_prefetch(&array->entries[slot_of(array, hash_value)]);
+  }
+}
 
-  // Desbloqueia o bucket
-  pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
+// Liberta os arrays substituídos de um array
+static void array_free_retired(hashtable_array_t* array)
+{
+  while(array->retired != NULL)
+  {
+    hashtable_array_t* retired = array->retired;
+    array->retired = retired->retired;
+    free(retired);
+  }
 }
 
-// Verifica se uma struct já está na hashtable, retorna o ponteira para os
-// dados caso exista, NULL caso não exista
-void* hashtable_contains(hashtable_t* hashtable, const void* data)
+// Remove todas as entradas mantendo os arrays das partições
+void hashtable_reset(hashtable_t* hashtable)
 {
-  // Calcula o índice do bucket
-  size_t index = hashtable->hash_func(hashtable, data);
+  size_t num_used = atomic_load(&hashtable->num_used_shards);
+  for(size_t i = 0; i < num_used; i++)
+  {
+    hashtable_array_t* array = atomic_load(&hashtable->shards[hashtable->used_shards[i]].array);
+
+    // O array atual fica com a capacidade que a partição atingiu, os anteriores já não são precisos
+    free(atomic_load(&array->prev));
+    atomic_store(&array->prev, NULL);
+    array_free_retired(array);
+    array->migrate_pos = 0;
 
-  // Calcula o mutex para este índice
-  int mutex_id = index % HASH_MAX_MUTEXES;
+    // Arrays sem entradas não precisam de ser limpos
+    if(atomic_load(&array->size) > 0)
+    {
+      memset(array->entries, 0, array->capacity * sizeof(hashtable_entry_t));
+      atomic_store(&array->size, 0);
+    }
+    atomic_store(&array->ready, true);
+  }
+}
+
+// Número de entradas na hashtable
+size_t hashtable_count(hashtable_t* hashtable)
+{
+  size_t count = 0;
+  size_t num_used = atomic_load(&hashtable->num_used_shards);
+  for(size_t i = 0; i < num_used; i++)
+  {
+    // O tamanho do array atual já inclui as entradas por transferir do array anterior
+    hashtable_array_t* array = atomic_load(&hashtable->shards[hashtable->used_shards[i]].array);
+    count += atomic_load(&array->size);
+  }
+  return count;
+}
 
-  // bloqueia o respetivo bucket
-  pthread_mutex_lock(&hashtable->mutexes[mutex_id]);
+// Memória de um array de entradas
+static size_t array_bytes(hashtable_array_t* array)
+{
+  return sizeof(hashtable_array_t) + array->capacity * sizeof(hashtable_entry_t);
+}
 
-  // Percorre as entradas no bucket
-  entry_t* entry = hashtable->buckets[index];
+// Soma a memória da hashtable
+void hashtable_memory(hashtable_t* hashtable, memory_usage_t* usage)
+{
+  usage->reserved += sizeof(hashtable_t) + HASH_MAX_MUTEXES * (sizeof(hashtable_shard_t) + sizeof(uint16_t));
 
-  // Se não fornecemos um comparador utilizamos o comparador por defeito
-  if(hashtable->cmp_func == NULL)
+  size_t num_used = atomic_load(&hashtable->num_used_shards);
+  for(size_t i = 0; i < num_used; i++)
   {
-    while(entry != NULL)
-    {
-      // Compara os dados da struct
-      if(memcmp(entry->data, data, hashtable->struct_size) == 0)
-      {
-        // Desbloqueia o bucket
-        pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
+    hashtable_array_t* array = atomic_load(&hashtable->shards[hashtable->used_shards[i]].array);
+    usage->reserved += array_bytes(array);
+    usage->used += atomic_load(&array->size) * sizeof(hashtable_entry_t);
 
-        return entry->data;
-      }
-      entry = entry->next;
+    hashtable_array_t* prev = atomic_load(&array->prev);
+    if(prev != NULL)
+    {
+      usage->reserved += array_bytes(prev);
     }
-  }
-  else
-  {
-    while(entry != NULL)
+    for(hashtable_array_t* retired = array->retired; retired != NULL; retired = retired->retired)
     {
-      // utiliza o comparador fornecido para verificar se os elementos são iguais
-      if(hashtable->cmp_func(entry->data, data))
-      {
-        // Desbloqueia o bucket
-        pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
-
-        return entry->data;
-      }
-      entry = entry->next;
+      usage->reserved += array_bytes(retired);
     }
   }
-
-  // Desbloqueia o bucket
-  pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
-
-  return NULL;
 }
 
 // Liberta a memória utilizada pela hashtable, atenção, não liberta os dados apenas a hashtable
 void hashtable_destroy(hashtable_t* hashtable, bool free_data)
 {
-  // Percorre todos os buckets e Liberta as entradas
-  for(size_t i = 0; i < hashtable->capacity; ++i)
+  // Percorre todas as partições e liberta as entradas
+  for(size_t i = 0; i < HASH_MAX_MUTEXES; ++i)
   {
-    // Calcula o mutex para este índice
-    int mutex_id = i % HASH_MAX_MUTEXES;
-
-    // bloqueia o respetivo bucket
-    pthread_mutex_lock(&hashtable->mutexes[mutex_id]);
+    hashtable_shard_t* shard = &hashtable->shards[i];
+    hashtable_array_t* array = atomic_load(&shard->array);
 
-    entry_t* entry = hashtable->buckets[i];
-    while(entry != NULL)
+    if(array != NULL)
     {
-      entry_t* next = entry->next;
+      // No array anterior apenas as posições ainda não transferidas têm dados que não estão no array atual
+      hashtable_array_t* prev = atomic_load(&array->prev);
       if(free_data)
-        free(entry->data);
-      free(entry);
-      entry = next;
-    }
+      {
+        for(size_t j = 0; j < array->capacity; j++)
+        {
+          free(atomic_load_explicit(&array->entries[j].data, memory_order_relaxed));
+        }
+        for(size_t j = array->migrate_pos; prev != NULL && j < prev->capacity; j++)
+        {
+          free(atomic_load_explicit(&prev->entries[j].data, memory_order_relaxed));
+        }
+      }
 
-    // Desbloqueia o bucket
-    pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
+      array_free_retired(array);
+      free(prev);
+      free(array);
+    }
 
-    // Destroy the mutex
-    pthread_mutex_destroy(&hashtable->mutexes[mutex_id]);
+    pthread_mutex_destroy(&shard->mutex);
   }
 
-  // Liberta a memória dos mutexes, buckets e da hashtable
-  free(hashtable->mutexes);
-  free(hashtable->buckets);
+  // Liberta a memória das partições e da hashtable
+  free(hashtable->used_shards);
+  free(hashtable->shards);
   free(hashtable);
 }
 
-entry_t* hashtable_reserve(hashtable_t* hashtable, void* data)
+// Insere uma struct na hashtable caso ainda não exista uma igual, retorna os dados existentes ou os
+// dados inseridos (NULL em caso de erro de alocação)
+void* hashtable_insert_if_absent(hashtable_t* hashtable, void* data)
 {
-  // Calcula o índice do bucket
-  size_t index = hashtable->hash_func(hashtable, data);
-
-  // Calcula o mutex para este índice
-  int mutex_id = index % HASH_MAX_MUTEXES;
-
-  // bloqueia o respetivo bucket
-  pthread_mutex_lock(&hashtable->mutexes[mutex_id]);
+  if(data == NULL)
+  {
+    return NULL;
+  }
 
-  // Percorre as entradas no bucket
-  entry_t* entry = hashtable->buckets[index];
+  // Calcula o hash e a partição correspondente
+  size_t hash_value = mix(hashtable->hash_func(hashtable, data));
+  hashtable_shard_t* shard = shard_of(hashtable, hash_value);
 
-  // Se não fornecemos um comparador utilizamos o comparador por defeito
-  if(hashtable->cmp_func == NULL)
+  for(;;)
   {
-    while(entry != NULL)
+    hashtable_array_t* array = shard_array(hashtable, shard);
+    if(array == NULL)
     {
-      // Compara os dados da struct
-      if(memcmp(entry->data, data, hashtable->struct_size) == 0)
-      {
-        // Desbloqueia o bucket
-        pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
-
-        return entry;
-      }
-      entry = entry->next;
+      return NULL;
     }
-  }
-  else
-  {
-    while(entry != NULL)
+
+    // Registamo-nos no array, se entretanto foi substituído tentamos no novo array
+    atomic_fetch_add(&array->writers, 1);
+    if(atomic_load(&shard->array) != array)
     {
-      // utiliza o comparador fornecido para verificar se os elementos são iguais
-      if(hashtable->cmp_func(entry->data, data))
-      {
-        // Desbloqueia o bucket
-        pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
+      atomic_fetch_sub(&array->writers, 1);
+      continue;
+    }
 
-        return entry;
-      }
-      entry = entry->next;
+    // Logo após um crescimento esperamos que o array anterior deixe de receber inserções
+    while(!atomic_load_explicit(&array->ready, memory_order_acquire))
+    {
+      sched_yield();
     }
-  }
 
-  // Cria uma nova entrada
-  entry = (entry_t*)malloc(sizeof(entry_t));
-  if(entry == NULL)
-  {
-    pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
-    return NULL;
-  }
+    // Os dados podem estar no array anterior, que já não é alterado
+    hashtable_array_t* prev = atomic_load_explicit(&array->prev, memory_order_acquire);
+    void* found = prev != NULL ? array_find(hashtable, prev, hash_value, data) : NULL;
+    if(found != NULL)
+    {
+      atomic_fetch_sub(&array->writers, 1);
+      return found;
+    }
 
-  // Copia os dados da struct para a entrada
-  entry->data = data;
+    // Reserva uma entrada, acima da ocupação máxima a partição tem de crescer primeiro
+    size_t size = atomic_fetch_add(&array->size, 1) + 1;
+    if(size * MAX_LOAD_DEN > array->capacity * MAX_LOAD_NUM)
+    {
+      atomic_fetch_sub(&array->size, 1);
+      atomic_fetch_sub(&array->writers, 1);
+      shard_grow(shard, array);
+      continue;
+    }
 
-  // Insere a entrada no início do bucket
-  entry->next = hashtable->buckets[index];
-  hashtable->buckets[index] = entry;
+    found = array_insert(hashtable, array, hash_value, data);
+    if(found != data)
+    {
+      // Os dados já existiam, a entrada reservada não foi utilizada
+      atomic_fetch_sub(&array->size, 1);
+    }
+    atomic_fetch_sub(&array->writers, 1);
 
-  // Desbloqueia o bucket
-  pthread_mutex_unlock(&hashtable->mutexes[mutex_id]);
+    // Avança a transferência do array anterior, se outra thread já o está a fazer não esperamos
+    if(prev != NULL && pthread_mutex_trylock(&shard->mutex) == 0)
+    {
+      if(atomic_load(&shard->array) == array)
+      {
+        shard_migrate(array, HASH_MIGRATE_STEP);
+      }
+      pthread_mutex_unlock(&shard->mutex);
+    }
 
-  return entry;
+    return found;
+  }
 }
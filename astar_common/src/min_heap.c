@@ -1,4 +1,5 @@
 #include "min_heap.h"
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -6,7 +7,559 @@
 
 #define INITIAL_CAPACITY 8196
 
-min_heap_t* min_heap_create()
+// Tamanho de uma linha de cache
+#define CACHE_LINE_SIZE 64
+
+// Número de elementos que antecedem o índice 1 na primeira linha de cache, com este deslocamento
+// os filhos de um nó (índices (i * aridade) + 1 ... (i * aridade) + aridade) ficam alinhados
+#define ALIGN_PADDING (CACHE_LINE_SIZE / sizeof(heap_node_t) - 1)
+
+// Aloca um array de elementos alinhado de forma a que os filhos de cada nó partilhem linhas de cache
+static bool allocate_data(min_heap_t* heap, size_t capacity)
+{
+  size_t bytes = (capacity + ALIGN_PADDING) * sizeof(heap_node_t);
+  bytes = (bytes + CACHE_LINE_SIZE - 1) & ~((size_t)CACHE_LINE_SIZE - 1);
+
+  void* memory = aligned_alloc(CACHE_LINE_SIZE, bytes);
+  if(memory == NULL)
+  {
+    return false;
+  }
+
+  heap_node_t* data = (heap_node_t*)memory + ALIGN_PADDING;
+
+  // Copia os elementos existentes para o novo array
+  if(heap->memory != NULL)
+  {
+    memcpy(data, heap->data, heap->size * sizeof(heap_node_t));
+    free(heap->memory);
+  }
+
+  heap->memory = memory;
+  heap->data = data;
+  heap->capacity = capacity;
+
+  return true;
+}
+
+// Verifica se o heap mantém a posição dos elementos (handle nos dados ou array de posições)
+static inline bool indexed(min_heap_t* heap)
+{
+  return heap->index_offset != MIN_HEAP_NO_INDEX || heap->positions != NULL;
+}
+
+// Escreve a posição do elemento no seu handle, caso o heap seja indexado
+static inline void set_index(min_heap_t* heap, void* data, size_t index)
+{
+  if(heap->positions != NULL)
+  {
+    // Os dados são o índice do elemento no array de posições, SIZE_MAX passa a UINT32_MAX
+    (*heap->positions)[(uintptr_t)data] = (uint32_t)index;
+  }
+  else if(heap->index_offset != MIN_HEAP_NO_INDEX && data != NULL)
+  {
+    *(size_t*)((char*)data + heap->index_offset) = index;
+  }
+}
+
+// Lê a posição do elemento do seu handle (o heap tem de ser indexado)
+static inline size_t get_index(min_heap_t* heap, void* data)
+{
+  if(heap->positions != NULL)
+  {
+    uint32_t index = (*heap->positions)[(uintptr_t)data];
+    return index == UINT32_MAX ? SIZE_MAX : index;
+  }
+  return *(size_t*)((char*)data + heap->index_offset);
+}
+
+// Valor que indica a ausência de elemento numa lista da bucket queue
+#define BUCKET_NIL UINT32_MAX
+
+// Valor do campo prev de um elemento que não está na bucket queue
+#define BUCKET_FREE (UINT32_MAX - 1)
+
+// Número inicial de camadas (custos) e de listas por camada (heurísticas)
+#define BUCKET_INITIAL_LAYERS 256
+#define BUCKET_INITIAL_LISTS 16
+
+// Elemento da bucket queue, ligado aos restantes elementos com o mesmo custo e heurística
+typedef struct
+{
+  uint64_t key;
+  void* data;
+  uint32_t prev;
+  uint32_t next;
+} bucket_slot_t;
+
+// Lista duplamente ligada de elementos (índices de bucket_slot_t)
+typedef struct
+{
+  uint32_t head;
+  uint32_t tail;
+} bucket_list_t;
+
+// Camada com os elementos de um custo, com uma lista por valor da heurística
+typedef struct
+{
+  bucket_list_t* lists;
+  size_t num_lists;
+  int h_base; // Heurística da primeira lista
+  size_t min_list; // Nenhuma lista antes desta tem elementos
+  size_t size;
+} bucket_layer_t;
+
+struct min_heap_buckets_t
+{
+  // Elementos, os que são removidos ficam numa lista de livres para serem reutilizados
+  bucket_slot_t* slots;
+  size_t num_slots;
+  size_t slots_capacity;
+  uint32_t free_slot;
+
+  // Camadas indexadas por (custo - f_base)
+  bucket_layer_t* layers;
+  size_t num_layers;
+  int f_base;
+  size_t min_layer; // Nenhuma camada antes desta tem elementos
+
+  // As listas são utilizadas como pilhas em vez de filas (política LIFO)
+  bool lifo;
+};
+
+// Garante que um array indexado por (valor - base) tem uma posição para value, o array cresce para qualquer
+// um dos lados e as novas posições são preenchidas com o byte fill, retorna a posição ou SIZE_MAX em caso de erro
+static size_t bucket_reserve(void** array, size_t* count, size_t elem_size, int* base, int value, int fill, size_t initial)
+{
+  if(*count == 0)
+  {
+    void* memory = malloc(initial * elem_size);
+    if(memory == NULL)
+    {
+      return SIZE_MAX;
+    }
+
+    memset(memory, fill, initial * elem_size);
+    free(*array);
+    *array = memory;
+    *count = initial;
+    *base = value;
+    return 0;
+  }
+
+  int64_t offset = (int64_t)value - *base;
+  if(offset >= 0 && (size_t)offset < *count)
+  {
+    return (size_t)offset;
+  }
+
+  // O array duplica de tamanho até conter o valor
+  size_t needed = offset < 0 ? *count + (size_t)(-offset) : (size_t)offset + 1;
+  size_t new_count = *count * 2;
+  while(new_count < needed)
+  {
+    new_count *= 2;
+  }
+
+  if(offset > 0)
+  {
+    void* memory = realloc(*array, new_count * elem_size);
+    if(memory == NULL)
+    {
+      return SIZE_MAX;
+    }
+
+    memset((char*)memory + *count * elem_size, fill, (new_count - *count) * elem_size);
+    *array = memory;
+    *count = new_count;
+    return (size_t)offset;
+  }
+
+  // Valor abaixo da base, as posições existentes são deslocadas para o fim do novo array
+  void* memory = malloc(new_count * elem_size);
+  if(memory == NULL)
+  {
+    return SIZE_MAX;
+  }
+
+  size_t shift = new_count - *count;
+  memset(memory, fill, shift * elem_size);
+  memcpy((char*)memory + shift * elem_size, *array, *count * elem_size);
+  free(*array);
+  *array = memory;
+  *count = new_count;
+  *base -= (int)shift;
+  return (size_t)((int64_t)value - *base);
+}
+
+static min_heap_buckets_t* buckets_create(bool lifo)
+{
+  min_heap_buckets_t* buckets = (min_heap_buckets_t*)malloc(sizeof(min_heap_buckets_t));
+  if(buckets == NULL)
+  {
+    return NULL;
+  }
+
+  buckets->slots = (bucket_slot_t*)malloc(INITIAL_CAPACITY * sizeof(bucket_slot_t));
+  if(buckets->slots == NULL)
+  {
+    free(buckets);
+    return NULL;
+  }
+
+  buckets->num_slots = 0;
+  buckets->slots_capacity = INITIAL_CAPACITY;
+  buckets->free_slot = BUCKET_NIL;
+  buckets->layers = NULL;
+  buckets->num_layers = 0;
+  buckets->f_base = 0;
+  buckets->min_layer = 0;
+  buckets->lifo = lifo;
+
+  return buckets;
+}
+
+// Liberta as camadas da bucket queue, que fica sem elementos
+static void buckets_free_layers(min_heap_buckets_t* buckets)
+{
+  for(size_t i = 0; i < buckets->num_layers; i++)
+  {
+    free(buckets->layers[i].lists);
+  }
+  free(buckets->layers);
+
+  buckets->layers = NULL;
+  buckets->num_layers = 0;
+  buckets->min_layer = 0;
+  buckets->num_slots = 0;
+  buckets->free_slot = BUCKET_NIL;
+}
+
+static void buckets_destroy(min_heap_buckets_t* buckets)
+{
+  if(buckets == NULL)
+  {
+    return;
+  }
+
+  buckets_free_layers(buckets);
+  free(buckets->slots);
+  free(buckets);
+}
+
+// Obtém um elemento livre, retorna BUCKET_NIL caso não seja possível
+static uint32_t buckets_alloc_slot(min_heap_buckets_t* buckets)
+{
+  if(buckets->free_slot != BUCKET_NIL)
+  {
+    uint32_t slot = buckets->free_slot;
+    buckets->free_slot = buckets->slots[slot].next;
+    return slot;
+  }
+
+  if(buckets->num_slots == buckets->slots_capacity)
+  {
+    // Os índices são de 32 bits, o último valor válido fica reservado
+    if(buckets->slots_capacity >= BUCKET_FREE)
+    {
+      return BUCKET_NIL;
+    }
+
+    bucket_slot_t* slots = (bucket_slot_t*)realloc(buckets->slots, buckets->slots_capacity * 2 * sizeof(bucket_slot_t));
+    if(slots == NULL)
+    {
+      return BUCKET_NIL;
+    }
+
+    buckets->slots = slots;
+    buckets->slots_capacity *= 2;
+  }
+
+  return (uint32_t)buckets->num_slots++;
+}
+
+static void buckets_free_slot(min_heap_buckets_t* buckets, uint32_t slot)
+{
+  buckets->slots[slot].prev = BUCKET_FREE;
+  buckets->slots[slot].next = buckets->free_slot;
+  buckets->free_slot = slot;
+}
+
+// Liga um elemento à lista correspondente ao seu custo e critério de desempate, no fim da lista ou no início
+// caso as listas sejam pilhas
+static bool buckets_link(min_heap_buckets_t* buckets, uint32_t slot)
+{
+  bucket_slot_t* node = &buckets->slots[slot];
+  int cost = min_heap_cost(node->key);
+  int h = (int)(uint32_t)node->key; // Índice da lista dentro da camada
+
+  // Camada do custo, se o array de camadas crescer para trás o cursor acompanha a deslocação
+  int old_f_base = buckets->f_base;
+  bool had_layers = buckets->num_layers > 0;
+  size_t layer_index = bucket_reserve((void**)&buckets->layers,
+                                      &buckets->num_layers,
+                                      sizeof(bucket_layer_t),
+                                      &buckets->f_base,
+                                      cost,
+                                      0,
+                                      BUCKET_INITIAL_LAYERS);
+  if(layer_index == SIZE_MAX)
+  {
+    return false;
+  }
+  buckets->min_layer = had_layers ? buckets->min_layer + (size_t)(old_f_base - buckets->f_base) : layer_index;
+
+  // Lista da heurística dentro da camada
+  bucket_layer_t* layer = &buckets->layers[layer_index];
+  int old_h_base = layer->h_base;
+  bool had_lists = layer->num_lists > 0;
+  size_t list_index = bucket_reserve((void**)&layer->lists,
+                                     &layer->num_lists,
+                                     sizeof(bucket_list_t),
+                                     &layer->h_base,
+                                     h,
+                                     0xFF,
+                                     BUCKET_INITIAL_LISTS);
+  if(list_index == SIZE_MAX)
+  {
+    return false;
+  }
+  if(had_lists)
+  {
+    layer->min_list += (size_t)(old_h_base - layer->h_base);
+  }
+
+  bucket_list_t* list = &layer->lists[list_index];
+  if(buckets->lifo)
+  {
+    node->prev = BUCKET_NIL;
+    node->next = list->head;
+    if(list->head != BUCKET_NIL)
+    {
+      buckets->slots[list->head].prev = slot;
+    }
+    else
+    {
+      list->tail = slot;
+    }
+    list->head = slot;
+  }
+  else
+  {
+    node->prev = list->tail;
+    node->next = BUCKET_NIL;
+    if(list->tail != BUCKET_NIL)
+    {
+      buckets->slots[list->tail].next = slot;
+    }
+    else
+    {
+      list->head = slot;
+    }
+    list->tail = slot;
+  }
+
+  // Atualiza os cursores do mínimo
+  if(layer->size == 0 || list_index < layer->min_list)
+  {
+    layer->min_list = list_index;
+  }
+  if(layer_index < buckets->min_layer)
+  {
+    buckets->min_layer = layer_index;
+  }
+  layer->size++;
+
+  return true;
+}
+
+// Desliga um elemento da lista onde se encontra
+static void buckets_unlink(min_heap_buckets_t* buckets, uint32_t slot)
+{
+  bucket_slot_t* node = &buckets->slots[slot];
+  bucket_layer_t* layer = &buckets->layers[min_heap_cost(node->key) - buckets->f_base];
+  bucket_list_t* list = &layer->lists[(int)(uint32_t)node->key - layer->h_base];
+
+  if(node->prev != BUCKET_NIL)
+  {
+    buckets->slots[node->prev].next = node->next;
+  }
+  else
+  {
+    list->head = node->next;
+  }
+
+  if(node->next != BUCKET_NIL)
+  {
+    buckets->slots[node->next].prev = node->prev;
+  }
+  else
+  {
+    list->tail = node->prev;
+  }
+
+  layer->size--;
+}
+
+// Verifica se o handle indicado corresponde a um elemento presente na bucket queue
+static inline bool buckets_valid(min_heap_buckets_t* buckets, size_t index)
+{
+  return index < buckets->num_slots && buckets->slots[index].prev != BUCKET_FREE;
+}
+
+// Calcula o critério de desempate de um elemento do heap segundo a política escolhida
+static inline uint32_t tie_value(min_heap_t* heap, int cost, int h)
+{
+  switch(heap->tie)
+  {
+  case MIN_HEAP_TIE_LOW_H:
+    return (uint32_t)h;
+  case MIN_HEAP_TIE_HIGH_G:
+    return UINT32_MAX - (uint32_t)(cost - h);
+  case MIN_HEAP_TIE_LIFO:
+    return UINT32_MAX - heap->counter++;
+  default:
+    return 0;
+  }
+}
+
+// Índice da lista de um elemento dentro da camada da bucket queue, com o custo fixo o menor h é o maior g
+static inline int bucket_tie_value(min_heap_t* heap, int h)
+{
+  return heap->tie == MIN_HEAP_TIE_LOW_H || heap->tie == MIN_HEAP_TIE_HIGH_G ? h : 0;
+}
+
+static size_t buckets_insert(min_heap_t* heap, int cost, int h, void* data)
+{
+  min_heap_buckets_t* buckets = heap->buckets;
+
+  uint32_t slot = buckets_alloc_slot(buckets);
+  if(slot == BUCKET_NIL)
+  {
+    return SIZE_MAX;
+  }
+
+  buckets->slots[slot].key = min_heap_key(cost, (uint32_t)bucket_tie_value(heap, h));
+  buckets->slots[slot].data = data;
+  if(!buckets_link(buckets, slot))
+  {
+    buckets_free_slot(buckets, slot);
+    return SIZE_MAX;
+  }
+
+  heap->size++;
+  set_index(heap, data, slot);
+  return slot;
+}
+
+// Primeira camada com elementos (a bucket queue não pode estar vazia)
+static bucket_layer_t* buckets_first_layer(min_heap_buckets_t* buckets)
+{
+  // Avança o cursor sobre as camadas vazias, estas já não são necessárias e libertamos as suas listas
+  bucket_layer_t* layer = &buckets->layers[buckets->min_layer];
+  while(layer->size == 0)
+  {
+    free(layer->lists);
+    layer->lists = NULL;
+    layer->num_lists = 0;
+    layer = &buckets->layers[++buckets->min_layer];
+  }
+  return layer;
+}
+
+static heap_node_t buckets_pop(min_heap_t* heap)
+{
+  min_heap_buckets_t* buckets = heap->buckets;
+  bucket_layer_t* layer = buckets_first_layer(buckets);
+
+  // Avança o cursor da camada sobre as listas vazias
+  while(layer->lists[layer->min_list].head == BUCKET_NIL)
+  {
+    layer->min_list++;
+  }
+
+  uint32_t slot = layer->lists[layer->min_list].head;
+  heap_node_t min_node = { buckets->slots[slot].key, buckets->slots[slot].data };
+
+  buckets_unlink(buckets, slot);
+  buckets_free_slot(buckets, slot);
+  heap->size--;
+  set_index(heap, min_node.data, SIZE_MAX);
+
+  return min_node;
+}
+
+static void buckets_remove_at(min_heap_t* heap, size_t index)
+{
+  if(!buckets_valid(heap->buckets, index))
+  {
+    return;
+  }
+
+  set_index(heap, heap->buckets->slots[index].data, SIZE_MAX);
+  buckets_unlink(heap->buckets, (uint32_t)index);
+  buckets_free_slot(heap->buckets, (uint32_t)index);
+  heap->size--;
+}
+
+static bool buckets_update_cost(min_heap_t* heap, size_t index, int cost, int h)
+{
+  if(!buckets_valid(heap->buckets, index))
+  {
+    return true;
+  }
+
+  buckets_unlink(heap->buckets, (uint32_t)index);
+  heap->buckets->slots[index].key = min_heap_key(cost, (uint32_t)bucket_tie_value(heap, h));
+  if(!buckets_link(heap->buckets, (uint32_t)index))
+  {
+    // Sem memória para a nova posição o elemento sai da bucket queue
+    set_index(heap, heap->buckets->slots[index].data, SIZE_MAX);
+    buckets_free_slot(heap->buckets, (uint32_t)index);
+    heap->size--;
+    return false;
+  }
+  return true;
+}
+
+// Procura um elemento na bucket queue, utiliza o handle caso seja indexada
+static size_t buckets_find_index(min_heap_t* heap, int cost, void* data)
+{
+  min_heap_buckets_t* buckets = heap->buckets;
+
+  if(indexed(heap) && data != NULL)
+  {
+    size_t index = get_index(heap, data);
+    if(buckets_valid(buckets, index) && buckets->slots[index].data == data)
+    {
+      return index;
+    }
+    return SIZE_MAX;
+  }
+
+  // Sem handle temos de percorrer as listas da camada do custo
+  int64_t layer_index = (int64_t)cost - buckets->f_base;
+  if(layer_index < 0 || (size_t)layer_index >= buckets->num_layers)
+  {
+    return SIZE_MAX;
+  }
+
+  bucket_layer_t* layer = &buckets->layers[layer_index];
+  for(size_t i = 0; i < layer->num_lists; i++)
+  {
+    for(uint32_t slot = layer->lists[i].head; slot != BUCKET_NIL; slot = buckets->slots[slot].next)
+    {
+      if(buckets->slots[slot].data == data)
+      {
+        return slot;
+      }
+    }
+  }
+
+  return SIZE_MAX;
+}
+
+min_heap_t* min_heap_create(enum min_heap_type_e type, enum min_heap_tie_e tie, size_t index_offset)
 {
   // Aloca memória para a estrutura min_heap_t
   min_heap_t* heap = (min_heap_t*)malloc(sizeof(min_heap_t));
@@ -16,16 +569,109 @@ min_heap_t* min_heap_create()
     return NULL;
   }
 
-  // Aloca memória para o array de elementos heap_node_t
-  heap->data = (heap_node_t*)malloc(INITIAL_CAPACITY * sizeof(heap_node_t));
+  // Número de filhos por nó, guardamos o log2 para podermos usar shifts
+  switch(type)
+  {
+  case MIN_HEAP_BUCKET:
+    heap->arity_shift = 0;
+    break;
+  case MIN_HEAP_8ARY:
+    heap->arity_shift = 3;
+    break;
+  case MIN_HEAP_4ARY:
+    heap->arity_shift = 2;
+    break;
+  default:
+    heap->arity_shift = 1;
+    break;
+  }
 
-  // Inicializa a capacidade e o tamanho do heap
-  heap->capacity = INITIAL_CAPACITY;
+  // Inicializa o tamanho do heap
   heap->size = 0;
+  heap->index_offset = index_offset;
+  heap->positions = NULL;
+  heap->tie = tie;
+  heap->counter = 0;
+  heap->memory = NULL;
+  heap->data = NULL;
+  heap->buckets = NULL;
+
+  // A bucket queue tem a sua própria estrutura
+  if(type == MIN_HEAP_BUCKET)
+  {
+    heap->buckets = buckets_create(tie == MIN_HEAP_TIE_LIFO);
+    if(heap->buckets == NULL)
+    {
+      free(heap);
+      return NULL;
+    }
+
+    return heap;
+  }
+
+  // Aloca memória para o array de elementos heap_node_t
+  if(!allocate_data(heap, INITIAL_CAPACITY))
+  {
+    free(heap);
+    return NULL;
+  }
 
   return heap;
 }
 
+// Passa a guardar a posição de cada elemento no array de posições indicado
+void min_heap_set_positions(min_heap_t* heap, uint32_t** positions)
+{
+  heap->positions = positions;
+}
+
+bool min_heap_type_from_name(const char* name, enum min_heap_type_e* type)
+{
+  if(strcmp(name, "binary") == 0)
+    *type = MIN_HEAP_BINARY;
+  else if(strcmp(name, "4ary") == 0)
+    *type = MIN_HEAP_4ARY;
+  else if(strcmp(name, "8ary") == 0)
+    *type = MIN_HEAP_8ARY;
+  else if(strcmp(name, "bucket") == 0)
+    *type = MIN_HEAP_BUCKET;
+  else
+    return false;
+
+  return true;
+}
+
+bool min_heap_tie_from_name(const char* name, enum min_heap_tie_e* tie)
+{
+  if(strcmp(name, "none") == 0)
+    *tie = MIN_HEAP_TIE_NONE;
+  else if(strcmp(name, "high-g") == 0)
+    *tie = MIN_HEAP_TIE_HIGH_G;
+  else if(strcmp(name, "low-h") == 0)
+    *tie = MIN_HEAP_TIE_LOW_H;
+  else if(strcmp(name, "lifo") == 0)
+    *tie = MIN_HEAP_TIE_LIFO;
+  else
+    return false;
+
+  return true;
+}
+
+const char* min_heap_tie_name(enum min_heap_tie_e tie)
+{
+  switch(tie)
+  {
+  case MIN_HEAP_TIE_HIGH_G:
+    return "high-g";
+  case MIN_HEAP_TIE_LOW_H:
+    return "low-h";
+  case MIN_HEAP_TIE_LIFO:
+    return "lifo";
+  default:
+    return "none";
+  }
+}
+
 void min_heap_destroy(min_heap_t* heap)
 {
   if(heap == NULL)
@@ -33,100 +679,166 @@ void min_heap_destroy(min_heap_t* heap)
     return;
   }
 
-  // Liberta a memória alocada para o array de elementos heap_node_t
-  free(heap->data);
+  // Liberta a memória alocada para o array de elementos heap_node_t ou para a bucket queue
+  free(heap->memory);
+  buckets_destroy(heap->buckets);
 
   // Liberta a memória alocada para a estrutura min_heap_t
   free(heap);
 }
 
-void ensure_capacity(min_heap_t* heap)
+// Soma a memória do heap
+void min_heap_memory(min_heap_t* heap, memory_usage_t* usage)
 {
-  if(heap == NULL)
+  usage->reserved += sizeof(min_heap_t);
+
+  min_heap_buckets_t* buckets = heap->buckets;
+  if(buckets == NULL)
   {
+    usage->reserved += (heap->capacity + ALIGN_PADDING) * sizeof(heap_node_t);
+    usage->used += heap->size * sizeof(heap_node_t);
     return;
   }
 
-  // Verifica se o heap está cheio e aumenta sua capacidade se necessário
-  if(heap->size == heap->capacity)
+  // Na bucket queue os elementos estão nos slots, as camadas e as listas são o índice por custo e heurística
+  usage->reserved += sizeof(min_heap_buckets_t) + buckets->slots_capacity * sizeof(bucket_slot_t) +
+                     buckets->num_layers * sizeof(bucket_layer_t);
+  for(size_t i = 0; i < buckets->num_layers; i++)
   {
-    // Dobra a capacidade do heap
-    heap->capacity *= 2;
-
-    // Realoca memória para o array de elementos heap_node_t com a nova capacidade
-    heap->data = (heap_node_t*)realloc(heap->data, heap->capacity * sizeof(heap_node_t));
+    usage->reserved += buckets->layers[i].num_lists * sizeof(bucket_list_t);
   }
+  usage->used += heap->size * sizeof(bucket_slot_t);
 }
 
-void swap(heap_node_t* a, heap_node_t* b)
+static bool ensure_capacity(min_heap_t* heap)
 {
-  // Troca os valores de dois elementos heap_node_t
-  heap_node_t temp = *a;
-  *a = *b;
-  *b = temp;
+  // Verifica se o heap está cheio e dobra a sua capacidade se necessário
+  if(heap->size == heap->capacity)
+  {
+    return allocate_data(heap, heap->capacity * 2);
+  }
+
+  return true;
 }
 
-void heapify_up(min_heap_t* heap, size_t index)
+// Coloca um elemento numa posição do heap e atualiza o respetivo handle
+static inline void place(min_heap_t* heap, size_t index, heap_node_t node)
 {
-  // Move o elemento para cima no heap enquanto seu custo for menor que o custo do pai
-  if(index == 0)
-    return;
-
-  int parent_index = (index - 1) / 2;
+  heap->data[index] = node;
+  set_index(heap, node.data, index);
+}
 
-  // Se o custo do elemento atual for menor que o custo do pai, troca-os de posição
-  if(heap->data[index].cost < heap->data[parent_index].cost)
+// Sobe o elemento no heap enquanto a sua chave for menor que a chave do pai, os pais
+// descem para o "buraco" em vez de se fazerem trocas, retorna a posição final
+static size_t sift_up(min_heap_t* heap, size_t index, heap_node_t node)
+{
+  while(index > 0)
   {
-    swap(&(heap->data[index]), &(heap->data[parent_index]));
-    heapify_up(heap, parent_index);
+    size_t parent_index = (index - 1) >> heap->arity_shift;
+    if(heap->data[parent_index].key <= node.key)
+    {
+      break;
+    }
+
+    place(heap, index, heap->data[parent_index]);
+    index = parent_index;
   }
+
+  place(heap, index, node);
+  return index;
 }
 
-void heapify_down(min_heap_t* heap, size_t index)
+// Desce o elemento no heap enquanto a sua chave for maior que a menor chave dos filhos
+static size_t sift_down(min_heap_t* heap, size_t index, heap_node_t node)
 {
-  // Move o elemento para baixo no heap enquanto seu custo for maior que o custo dos filhos
-  size_t left_child_index = 2 * index + 1;
-  size_t right_child_index = 2 * index + 2;
-  size_t smallest = index;
+  size_t arity = (size_t)1 << heap->arity_shift;
+
+  for(;;)
+  {
+    size_t first_child = (index << heap->arity_shift) + 1;
+    if(first_child >= heap->size)
+    {
+      break;
+    }
+
+    // Procura o filho com menor chave, a seleção é feita sem saltos condicionais
+    size_t last_child = first_child + arity;
+    if(last_child > heap->size)
+    {
+      last_child = heap->size;
+    }
 
-  // Compara o custo do elemento atual com o custo dos filhos esquerdo e direito
-  if(left_child_index < heap->size && heap->data[left_child_index].cost < heap->data[smallest].cost)
-    smallest = left_child_index;
+    size_t smallest = first_child;
+    uint64_t smallest_key = heap->data[first_child].key;
+    for(size_t child = first_child + 1; child < last_child; child++)
+    {
+      uint64_t key = heap->data[child].key;
+      bool less = key < smallest_key;
+      smallest = less ? child : smallest;
+      smallest_key = less ? key : smallest_key;
+    }
+
+    if(node.key <= smallest_key)
+    {
+      break;
+    }
 
-  if(right_child_index < heap->size && heap->data[right_child_index].cost < heap->data[smallest].cost)
-    smallest = right_child_index;
+    place(heap, index, heap->data[smallest]);
+    index = smallest;
+  }
+
+  place(heap, index, node);
+  return index;
+}
+
+// Procura a posição de um elemento, utiliza o handle caso o heap seja indexado
+static size_t find_index(min_heap_t* heap, int cost, void* data)
+{
+  if(indexed(heap) && data != NULL)
+  {
+    size_t index = get_index(heap, data);
+    if(index < heap->size && heap->data[index].data == data)
+    {
+      return index;
+    }
+    return SIZE_MAX;
+  }
 
-  // Se o elemento atual não for o menor, troca-o com o menor filho e continua a verificação
-  if(smallest != index)
+  // Sem handle temos de procurar o elemento no heap
+  for(size_t i = 0; i < heap->size; i++)
   {
-    swap(&(heap->data[index]), &(heap->data[smallest]));
-    heapify_down(heap, smallest);
+    if(min_heap_cost(heap->data[i].key) == cost && heap->data[i].data == data)
+    {
+      return i;
+    }
   }
+
+  return SIZE_MAX;
 }
 
-size_t min_heap_insert(min_heap_t* heap, int cost, void* data)
+size_t min_heap_insert(min_heap_t* heap, int cost, int h, void* data)
 {
   if(heap == NULL)
   {
     return SIZE_MAX;
   }
 
-  // Garante que o heap tem capacidade suficiente para inserir um novo elemento
-  ensure_capacity(heap);
-
-  size_t index = heap->size;
+  if(heap->buckets != NULL)
+  {
+    return buckets_insert(heap, cost, h, data);
+  }
 
-  // Insere o novo elemento no final do heap
-  heap->data[index].cost = cost;
-  heap->data[index].data = data;
+  // Garante que o heap tem capacidade suficiente para inserir um novo elemento
+  if(!ensure_capacity(heap))
+  {
+    return SIZE_MAX;
+  }
 
-  // incrementa o tamanho da nossa heap
+  // Insere o novo elemento no final do heap e sobe-o até à sua posição
+  heap_node_t node = { min_heap_key(cost, tie_value(heap, cost, h)), data };
   heap->size++;
 
-  // Realiza o heapify-up para ajustar a posição do novo elemento no heap
-  heapify_up(heap, index);
-
-  return index;
+  return sift_up(heap, heap->size - 1, node);
 }
 
 heap_node_t min_heap_pop(min_heap_t* heap)
@@ -146,95 +858,142 @@ heap_node_t min_heap_pop(min_heap_t* heap)
     return empty_node;
   }
 
+  if(heap->buckets != NULL)
+  {
+    return buckets_pop(heap);
+  }
+
   // Armazena o valor mínimo
   heap_node_t min_node = heap->data[0];
-
-  // Substitui o valor mínimo pelo último elemento do heap
-  heap->data[0] = heap->data[heap->size - 1];
+  set_index(heap, min_node.data, SIZE_MAX);
 
   // Reduz o tamanho do heap
   heap->size--;
 
-  // Realiza o heapify-down para restaurar as propriedades do heap
-  heapify_down(heap, 0);
+  // O último elemento do heap desce a partir da raiz para restaurar as propriedades do heap
+  if(heap->size > 0)
+  {
+    sift_down(heap, 0, heap->data[heap->size]);
+  }
 
   // Retorna o valor mínimo extraído
   return min_node;
 }
 
-void min_heap_remove(min_heap_t* heap, int cost, void* data)
+// Retorna o custo do elemento mínimo sem o remover
+int min_heap_top_cost(min_heap_t* heap)
 {
-  if(heap == NULL)
+  if(heap == NULL || heap->size == 0)
   {
-    return;
+    return INT_MAX;
+  }
+
+  if(heap->buckets != NULL)
+  {
+    // As camadas são indexadas por (custo - f_base)
+    buckets_first_layer(heap->buckets);
+    return heap->buckets->f_base + (int)heap->buckets->min_layer;
   }
 
-  size_t index = SIZE_MAX;
+  return min_heap_cost(heap->data[0].key);
+}
 
-  // Procura o elemento no heap
-  for(size_t i = 0; i < heap->size; i++)
+// Recoloca um elemento cuja chave mudou, este pode ter de subir ou descer no heap
+static void sift(min_heap_t* heap, size_t index, heap_node_t node)
+{
+  if(index > 0 && node.key < heap->data[(index - 1) >> heap->arity_shift].key)
   {
-    if(heap->data[i].cost == cost && heap->data[i].data == data)
-    {
-      index = i;
-      break;
-    }
+    sift_up(heap, index, node);
+  }
+  else
+  {
+    sift_down(heap, index, node);
   }
+}
 
-  if(index == SIZE_MAX)
+void min_heap_remove_at(min_heap_t* heap, size_t index)
+{
+  if(heap != NULL && heap->buckets != NULL)
+  {
+    buckets_remove_at(heap, index);
+    return;
+  }
+
+  if(heap == NULL || index >= heap->size)
+  {
     return;
+  }
 
-  // Move o último elemento para a posição do elemento a ser removido
-  heap->data[index] = heap->data[heap->size - 1];
+  set_index(heap, heap->data[index].data, SIZE_MAX);
   heap->size--;
-  //i-1/2
 
-  // Reorganiza o heap
-  heapify_up(heap, index);
+  // O elemento removido era o último, nada a reorganizar
+  if(index == heap->size)
+  {
+    return;
+  }
+
+  // Move o último elemento para a posição do elemento removido
+  sift(heap, index, heap->data[heap->size]);
 }
 
-void min_heap_update(min_heap_t* heap, int old_cost, int new_cost, void* data)
+void min_heap_remove(min_heap_t* heap, int cost, void* data)
 {
   if(heap == NULL)
   {
     return;
   }
 
-  size_t index = SIZE_MAX;
+  min_heap_remove_at(heap, heap->buckets != NULL ? buckets_find_index(heap, cost, data) : find_index(heap, cost, data));
+}
 
-  // Procura o elemento no heap
-  for(size_t i = 0; i < heap->size; i++)
+void min_heap_update(min_heap_t* heap, int old_cost, int new_cost, void* data)
+{
+  if(heap == NULL)
   {
-    if(heap->data[i].cost == old_cost && heap->data[i].data == data)
+    return;
+  }
+
+  // O critério de desempate (na bucket queue a heurística) mantém-se
+  if(heap->buckets != NULL)
+  {
+    size_t index = buckets_find_index(heap, old_cost, data);
+    if(index != SIZE_MAX)
     {
-      index = i;
-      break;
+      buckets_update_cost(heap, index, new_cost, (int)(uint32_t)heap->buckets->slots[index].key);
     }
+    return;
   }
 
+  size_t index = find_index(heap, old_cost, data);
+
   if(index == SIZE_MAX)
   {
     return;
   }
 
-  // Atualiza o custo do elemento
-  heap->data[index].cost = new_cost;
-
-  // Reorganiza o heap
-  heapify_up(heap, index);
+  heap_node_t node = heap->data[index];
+  node.key = min_heap_key(new_cost, (uint32_t)node.key);
+  sift(heap, index, node);
 }
 
-void min_heap_update_cost(min_heap_t* heap, int index, int cost)
+bool min_heap_update_cost(min_heap_t* heap, size_t index, int cost, int h)
 {
-  if(heap == NULL)
+  if(heap != NULL && heap->buckets != NULL)
   {
-    return;
+    return buckets_update_cost(heap, index, cost, h);
   }
 
-  // Atualiza o custo do elemento
-  heap->data[index].cost = cost;
+  if(heap == NULL || index >= heap->size)
+  {
+    return true;
+  }
 
-  heapify_up(heap, index);
+  // Atualiza o custo e o critério de desempate do elemento e reorganiza o heap
+  heap_node_t node = heap->data[index];
+  node.key = min_heap_key(cost, tie_value(heap, cost, h));
+  sift(heap, index, node);
+  return true;
 }
 
 // Limpa a min_heap
@@ -245,5 +1004,30 @@ void min_heap_clean(min_heap_t* heap)
     return;
   }
 
+  // Na bucket queue percorremos os elementos ocupados e libertamos as camadas
+  if(heap->buckets != NULL)
+  {
+    for(size_t i = 0; i < heap->buckets->num_slots && indexed(heap); i++)
+    {
+      if(heap->buckets->slots[i].prev != BUCKET_FREE)
+      {
+        set_index(heap, heap->buckets->slots[i].data, SIZE_MAX);
+      }
+    }
+
+    buckets_free_layers(heap->buckets);
+    heap->size = 0;
+    return;
+  }
+
+  // Os elementos deixam de estar no heap, os seus handles têm de o refletir
+  if(indexed(heap))
+  {
+    for(size_t i = 0; i < heap->size; i++)
+    {
+      set_index(heap, heap->data[i].data, SIZE_MAX);
+    }
+  }
+
   heap->size = 0;
 }
@@ -0,0 +1,186 @@
+#include "multi_queue.h"
+#include <limits.h>
+#include <stdlib.h>
+
+// Número aleatório (xorshift64), a semente não pode ser 0
+static inline uint64_t next_random(uint64_t* seed)
+{
+  uint64_t x = *seed;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *seed = x;
+  return x;
+}
+
+// Heap aleatório da fila
+static inline multi_queue_heap_t* random_heap(multi_queue_t* queue, uint64_t* seed)
+{
+  return &queue->heaps[(size_t)(((next_random(seed) >> 32) * queue->num_heaps) >> 32)];
+}
+
+// Retira o mínimo de um heap, o mutex do heap já está obtido
+static bool pop_locked(multi_queue_heap_t* heap, heap_node_t* element)
+{
+  if(heap->heap->size == 0)
+  {
+    return false;
+  }
+
+  *element = min_heap_pop(heap->heap);
+  atomic_store_explicit(&heap->top_cost, min_heap_top_cost(heap->heap), memory_order_relaxed);
+  return true;
+}
+
+// Cria uma fila com o número de heaps indicado
+multi_queue_t* multi_queue_create(size_t num_heaps, enum min_heap_type_e type, enum min_heap_tie_e tie)
+{
+  if(num_heaps == 0)
+  {
+    return NULL;
+  }
+
+  multi_queue_t* queue = (multi_queue_t*)malloc(sizeof(multi_queue_t));
+  if(queue == NULL)
+  {
+    return NULL;
+  }
+
+  // O tamanho da estrutura de cada heap já é múltiplo da linha de cache
+  queue->heaps =
+      (multi_queue_heap_t*)aligned_alloc(MULTI_QUEUE_CACHE_LINE_SIZE, num_heaps * sizeof(multi_queue_heap_t));
+  if(queue->heaps == NULL)
+  {
+    free(queue);
+    return NULL;
+  }
+
+  queue->num_heaps = num_heaps;
+  for(size_t i = 0; i < num_heaps; i++)
+  {
+    pthread_mutex_init(&queue->heaps[i].lock, NULL);
+    atomic_init(&queue->heaps[i].top_cost, INT_MAX);
+    queue->heaps[i].heap = min_heap_create(type, tie, MIN_HEAP_NO_INDEX);
+  }
+
+  for(size_t i = 0; i < num_heaps; i++)
+  {
+    if(queue->heaps[i].heap == NULL)
+    {
+      multi_queue_destroy(queue);
+      return NULL;
+    }
+  }
+
+  return queue;
+}
+
+// Liberta a fila
+void multi_queue_destroy(multi_queue_t* queue)
+{
+  if(queue == NULL)
+  {
+    return;
+  }
+
+  for(size_t i = 0; i < queue->num_heaps; i++)
+  {
+    min_heap_destroy(queue->heaps[i].heap);
+    pthread_mutex_destroy(&queue->heaps[i].lock);
+  }
+  free(queue->heaps);
+  free(queue);
+}
+
+// Insere um elemento num heap aleatório
+bool multi_queue_push(multi_queue_t* queue, int cost, int h, void* data, uint64_t* seed)
+{
+  // Se o heap escolhido estiver ocupado tentamos outro, com muitas tentativas falhadas esperamos pelo último
+  multi_queue_heap_t* heap = random_heap(queue, seed);
+  size_t attempt = 1;
+  while(pthread_mutex_trylock(&heap->lock) != 0)
+  {
+    heap = random_heap(queue, seed);
+    if(++attempt >= queue->num_heaps)
+    {
+      pthread_mutex_lock(&heap->lock);
+      break;
+    }
+  }
+
+  bool inserted = min_heap_insert(heap->heap, cost, h, data) != SIZE_MAX;
+  if(inserted && cost < atomic_load_explicit(&heap->top_cost, memory_order_relaxed))
+  {
+    atomic_store_explicit(&heap->top_cost, cost, memory_order_relaxed);
+  }
+  pthread_mutex_unlock(&heap->lock);
+  return inserted;
+}
+
+// Extrai o mínimo do melhor de dois heaps aleatórios
+bool multi_queue_pop(multi_queue_t* queue, heap_node_t* element, uint64_t* seed)
+{
+  for(size_t attempt = 0; attempt < queue->num_heaps; attempt++)
+  {
+    multi_queue_heap_t* first = random_heap(queue, seed);
+    multi_queue_heap_t* second = random_heap(queue, seed);
+    int first_cost = atomic_load_explicit(&first->top_cost, memory_order_relaxed);
+    int second_cost = atomic_load_explicit(&second->top_cost, memory_order_relaxed);
+    multi_queue_heap_t* heap = second_cost < first_cost ? second : first;
+    if((second_cost < first_cost ? second_cost : first_cost) == INT_MAX)
+    {
+      continue; // Os dois heaps estão vazios
+    }
+
+    // Um heap ocupado por outra thread é trocado por outra escolha
+    if(pthread_mutex_trylock(&heap->lock) != 0)
+    {
+      continue;
+    }
+    bool found = pop_locked(heap, element);
+    pthread_mutex_unlock(&heap->lock);
+    if(found)
+    {
+      return true;
+    }
+  }
+
+  // Com poucos elementos as escolhas aleatórias falham com frequência, procuramos em todos os heaps
+  for(size_t i = 0; i < queue->num_heaps; i++)
+  {
+    multi_queue_heap_t* heap = &queue->heaps[i];
+    if(atomic_load_explicit(&heap->top_cost, memory_order_relaxed) == INT_MAX)
+    {
+      continue;
+    }
+
+    pthread_mutex_lock(&heap->lock);
+    bool found = pop_locked(heap, element);
+    pthread_mutex_unlock(&heap->lock);
+    if(found)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Descarta todos os elementos
+void multi_queue_clean(multi_queue_t* queue)
+{
+  for(size_t i = 0; i < queue->num_heaps; i++)
+  {
+    min_heap_clean(queue->heaps[i].heap);
+    atomic_store(&queue->heaps[i].top_cost, INT_MAX);
+  }
+}
+
+// Soma a memória dos heaps
+void multi_queue_memory(multi_queue_t* queue, memory_usage_t* usage)
+{
+  usage->reserved += sizeof(multi_queue_t) + queue->num_heaps * sizeof(multi_queue_heap_t);
+  for(size_t i = 0; i < queue->num_heaps; i++)
+  {
+    min_heap_memory(queue->heaps[i].heap, usage);
+  }
+}
@@ -0,0 +1,143 @@
+#include "node_store.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Capacidade inicial dos arrays
+#define NODE_STORE_INITIAL_CAPACITY 4096
+
+// Tamanho de um nó nos arrays
+#define NODE_BYTES (2 * sizeof(int) + sizeof(node_id_t) + sizeof(uint32_t))
+
+// Aumenta os arrays para incluírem o identificador, os novos identificadores ficam sem nó
+static bool node_store_grow(node_store_t* store, size_t id)
+{
+  size_t capacity = store->capacity;
+  while(capacity <= id)
+  {
+    capacity *= 2;
+  }
+
+  int* g = (int*)realloc(store->g, capacity * sizeof(int));
+  if(g == NULL)
+  {
+    return false;
+  }
+  store->g = g;
+
+  int* h = (int*)realloc(store->h, capacity * sizeof(int));
+  if(h == NULL)
+  {
+    return false;
+  }
+  store->h = h;
+
+  node_id_t* parent = (node_id_t*)realloc(store->parent, capacity * sizeof(node_id_t));
+  if(parent == NULL)
+  {
+    return false;
+  }
+  store->parent = parent;
+
+  uint32_t* open_index = (uint32_t*)realloc(store->open_index, capacity * sizeof(uint32_t));
+  if(open_index == NULL)
+  {
+    return false;
+  }
+  store->open_index = open_index;
+
+  for(size_t i = store->capacity; i < capacity; i++)
+  {
+    store->g[i] = NODE_STORE_NO_G;
+  }
+  store->capacity = capacity;
+  return true;
+}
+
+// Cria os nós compactos
+node_store_t* node_store_create(allocator_t* allocator)
+{
+  node_store_t* store = (node_store_t*)malloc(sizeof(node_store_t));
+  if(store == NULL)
+  {
+    return NULL; // Erro de alocação
+  }
+
+  store->allocator = allocator;
+  store->capacity = NODE_STORE_INITIAL_CAPACITY;
+  store->used = 0;
+  store->g = (int*)malloc(store->capacity * sizeof(int));
+  store->h = (int*)malloc(store->capacity * sizeof(int));
+  store->parent = (node_id_t*)malloc(store->capacity * sizeof(node_id_t));
+  store->open_index = (uint32_t*)malloc(store->capacity * sizeof(uint32_t));
+  if(store->g == NULL || store->h == NULL || store->parent == NULL || store->open_index == NULL)
+  {
+    node_store_destroy(store);
+    return NULL;
+  }
+
+  for(size_t i = 0; i < store->capacity; i++)
+  {
+    store->g[i] = NODE_STORE_NO_G;
+  }
+
+  return store;
+}
+
+// Liberta os nós compactos
+void node_store_destroy(node_store_t* store)
+{
+  if(store == NULL)
+  {
+    return;
+  }
+
+  free(store->g);
+  free(store->h);
+  free(store->parent);
+  free(store->open_index);
+  free(store);
+}
+
+// Descarta todos os nós
+void node_store_reset(node_store_t* store)
+{
+  if(store == NULL)
+  {
+    return;
+  }
+
+  // Apenas os identificadores utilizados podem ter nó
+  for(size_t i = 0; i < store->used; i++)
+  {
+    store->g[i] = NODE_STORE_NO_G;
+  }
+  store->used = 0;
+}
+
+// Soma a memória dos arrays
+void node_store_memory(node_store_t* store, memory_usage_t* usage)
+{
+  usage->reserved += sizeof(node_store_t) + store->capacity * NODE_BYTES;
+  usage->used += store->used * NODE_BYTES;
+}
+
+// Identificador do nó de um estado
+node_id_t node_store_id(node_store_t* store, state_t* state)
+{
+  size_t index = allocator_index_of(store->allocator, state);
+  if(index == SIZE_MAX || index >= UINT32_MAX - 1)
+  {
+    return NODE_NONE;
+  }
+
+  size_t id = index + 1;
+  if(id >= store->capacity && !node_store_grow(store, id))
+  {
+    return NODE_NONE;
+  }
+  if(id >= store->used)
+  {
+    store->used = id + 1;
+  }
+  return (node_id_t)id;
+}
@@ -3,24 +3,33 @@
 #include <string.h>
 
 // Esta é a funcão que é utilizada pela hashtable para comparar se 2
-// estados são iguais
-bool compare_state_t(const void* state_a, const void* state_b)
+// estados são iguais, o tamanho dos dados é o tamanho da struct da hashtable
+static bool compare_state_t(hashtable_t* hashtable, const void* state_a, const void* state_b)
 {
-  size_t struct_size_a = ((state_t*)state_a)->struct_size;
-  size_t struct_size_b = ((state_t*)state_b)->struct_size;
-
-  // Os tamanhos tem de ser iguais
-  if(struct_size_a != struct_size_b)
+  // Os hashes tem de ser iguais
+  if(((state_t*)state_a)->hash != ((state_t*)state_b)->hash)
     return false;
 
   // Compara os estados
   void* state_data_a = ((state_t*)state_a)->data;
   void* state_data_b = ((state_t*)state_b)->data;
-  return memcmp(state_data_a, state_data_b, struct_size_a) == 0;
+  return memcmp(state_data_a, state_data_b, hashtable->struct_size) == 0;
+}
+
+// Função de hash utilizada pela hashtable, o hash dos dados já está guardado no estado
+static size_t state_hash(hashtable_t*, const void* state)
+{
+  return ((state_t*)state)->hash;
+}
+
+// Arredonda um tamanho para um múltiplo de 8, para que os registos mantenham o alinhamento
+static inline size_t align8(size_t size)
+{
+  return (size + 7) & ~(size_t)7;
 }
 
 // Aloca um novo gestor de estados
-state_allocator_t* state_allocator_create(size_t struct_size)
+state_allocator_t* state_allocator_create(size_t struct_size, size_t node_size)
 {
   state_allocator_t* allocator = (state_allocator_t*)malloc(sizeof(state_allocator_t));
 
@@ -31,13 +40,21 @@ state_allocator_t* state_allocator_create(size_t struct_size)
 
   // Configura o alocador
   allocator->struct_size = struct_size;
+  allocator->node_size = align8(node_size);
 
-  // Nos utilizamos 2 alocadores diferents, um para os estados, outro
-  // para os dados do estado (dependente do algoritmo)
-  allocator->allocator = allocator_create(struct_size);
+  // Cada registo tem o cabeçalho, a zona reservada e os dados do estado. Os estados são a maior parte da
+  // memória utilizada, pedimos páginas grandes para reduzir as falhas de TLB
+  allocator->allocator =
+      allocator_create_paged(align8(sizeof(state_t) + allocator->node_size + struct_size), 0, ALLOCATOR_HUGE_PAGES);
 
   // Para indexarmos os estados que já existem
-  allocator->states = hashtable_create(struct_size, compare_state_t, NULL);
+  allocator->states = hashtable_create(struct_size, compare_state_t, state_hash);
+
+  if(allocator->allocator == NULL || allocator->states == NULL)
+  {
+    state_allocator_destroy(allocator);
+    return NULL;
+  }
 
   return allocator;
 }
@@ -50,14 +67,32 @@ void state_allocator_destroy(state_allocator_t* allocator)
     return;
   }
 
-  // Limpamos a nossa memória
-  hashtable_destroy(allocator->states, true);
-  allocator_destroy(allocator->allocator);
+  // Os estados estão nas páginas do alocador, a hashtable não os liberta
+  if(allocator->states != NULL)
+  {
+    hashtable_destroy(allocator->states, false);
+  }
+  if(allocator->allocator != NULL)
+  {
+    allocator_destroy(allocator->allocator);
+  }
 
   // Libertamos o alocador
   free(allocator);
 }
 
+// Descarta todos os estados, mantendo a memória e a hashtable para os estados seguintes
+void state_allocator_reset(state_allocator_t* allocator)
+{
+  if(allocator == NULL)
+  {
+    return;
+  }
+
+  hashtable_reset(allocator->states);
+  allocator_reset(allocator->allocator);
+}
+
 // Aloca ou retorna um estado novo
 state_t* state_allocator_new(state_allocator_t* allocator, void* state_data)
 {
@@ -67,28 +102,41 @@ state_t* state_allocator_new(state_allocator_t* allocator, void* state_data)
     return NULL;
   }
 
-  state_t* new_state = (state_t*)malloc(sizeof(state_t));
-  if(new_state == NULL)
-  {
-    return NULL;
-  }
+  return state_allocator_new_hashed(allocator, state_data, hash_function(state_data, allocator->struct_size));
+}
 
-  new_state->struct_size = allocator->struct_size;
-  new_state->hash = hash_function(state_data, allocator->struct_size, HASH_CAPACITY);
-  new_state->data = state_data;
+// Calcula o hash dos dados e antecipa o acesso à hashtable
+size_t state_allocator_prefetch(state_allocator_t* allocator, const void* state_data)
+{
+  size_t hash = hash_function(state_data, allocator->struct_size);
+  hashtable_prefetch(allocator->states, hash);
+  return hash;
+}
 
-  // Verifica se o estado expandido já existe
-  state_t* old_state = (state_t*)hashtable_contains(allocator->states, new_state);
+// Aloca ou retorna um estado novo, com o hash dos dados já calculado
+state_t* state_allocator_new_hashed(state_allocator_t* allocator, void* state_data, size_t hash)
+{
+  // Procuramos primeiro com um estado temporário, os estados repetidos não alocam memória
+  state_t probe = { hash, state_data };
+  state_t* old_state = (state_t*)hashtable_contains(allocator->states, &probe);
   if(old_state)
   {
-    free(new_state);
-    return (state_t*)old_state;
+    return old_state;
+  }
+
+  // O estado, a zona reservada e os dados são alocados num único registo
+  state_t* new_state = (state_t*)allocator_alloc(allocator->allocator);
+  if(new_state == NULL)
+  {
+    return NULL;
   }
+  memset(state_node(new_state), 0, allocator->node_size);
 
-  // Guardamos os dados no nosso gestor de memória e indexamos o estado gerado
-  new_state->data = allocator_alloc(allocator->allocator);
+  new_state->hash = probe.hash;
+  new_state->data = (char*)state_node(new_state) + allocator->node_size;
   memcpy(new_state->data, state_data, allocator->struct_size);
-  hashtable_insert(allocator->states, new_state);
 
-  return new_state;
+  // Outra thread pode ter inserido o mesmo estado entretanto, nesse caso utilizamos o estado dela
+  // (o registo alocado fica no alocador até este ser destruído)
+  return (state_t*)hashtable_insert_if_absent(allocator->states, new_state);
 }
@@ -0,0 +1,170 @@
+#include "successors.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Cria um buffer com a capacidade indicada (0 para a capacidade predefinida)
+successors_t* successors_create(size_t capacity)
+{
+  successors_t* successors = (successors_t*)malloc(sizeof(successors_t));
+  if(successors == NULL)
+  {
+    // Falha na alocação de memória
+    return NULL;
+  }
+
+  successors->size = 0;
+  successors->capacity = capacity ? capacity : SUCCESSORS_DEFAULT_CAPACITY;
+  successors->staging = false;
+  successors->pending_data = NULL;
+  successors->pending_hashes = NULL;
+  successors->num_pending = 0;
+  successors->pending_capacity = 0;
+  successors->struct_size = 0;
+  successors->items = (successor_t*)malloc(successors->capacity * sizeof(successor_t));
+  if(successors->items == NULL)
+  {
+    free(successors);
+    return NULL;
+  }
+
+  return successors;
+}
+
+// Liberta o buffer (os estados pertencem ao gestor de estados e não são libertados)
+void successors_destroy(successors_t* successors)
+{
+  if(successors == NULL)
+  {
+    return;
+  }
+
+  free(successors->items);
+  free(successors->pending_data);
+  free(successors->pending_hashes);
+  free(successors);
+}
+
+// Acrescenta um sucessor ao buffer, o custo e a heurística são calculados pelo algoritmo
+bool successors_add(successors_t* successors, state_t* state)
+{
+  return successors_add_with_costs(successors, state, SUCCESSOR_UNKNOWN, SUCCESSOR_UNKNOWN);
+}
+
+// Garante que existe espaço para mais um sucessor
+static bool reserve_item(successors_t* successors)
+{
+  if(successors->size == successors->capacity)
+  {
+    // Só acontece enquanto o buffer não tem a capacidade máxima de sucessores do problema
+    successor_t* items = (successor_t*)realloc(successors->items, successors->capacity * 2 * sizeof(successor_t));
+    if(items == NULL)
+    {
+      return false;
+    }
+    successors->items = items;
+    successors->capacity *= 2;
+  }
+  return true;
+}
+
+// Garante que existe espaço para mais um sucessor pendente
+static bool reserve_pending(successors_t* successors, size_t struct_size)
+{
+  if(successors->num_pending == successors->pending_capacity || successors->struct_size != struct_size)
+  {
+    // Os dados pendentes são todos do mesmo tamanho, o buffer só muda de tamanho quando está vazio
+    if(successors->num_pending > 0 && successors->struct_size != struct_size)
+    {
+      return false;
+    }
+
+    size_t capacity = successors->pending_capacity ? successors->pending_capacity * 2 : successors->capacity;
+    char* data = (char*)realloc(successors->pending_data, capacity * struct_size);
+    if(data == NULL)
+    {
+      return false;
+    }
+    successors->pending_data = data;
+
+    size_t* hashes = (size_t*)realloc(successors->pending_hashes, capacity * sizeof(size_t));
+    if(hashes == NULL)
+    {
+      return false;
+    }
+    successors->pending_hashes = hashes;
+    successors->pending_capacity = capacity;
+    successors->struct_size = struct_size;
+  }
+  return true;
+}
+
+// Acrescenta um sucessor com o custo do arco e a variação da heurística já calculados
+bool successors_add_with_costs(successors_t* successors, state_t* state, int cost, int h_delta)
+{
+  if(state == NULL || !reserve_item(successors))
+  {
+    // Falha na alocação de memória
+    return false;
+  }
+
+  successor_t* successor = &successors->items[successors->size++];
+  successor->state = state;
+  successor->cost = cost;
+  successor->h_delta = h_delta;
+  return true;
+}
+
+// Acrescenta um sucessor a partir dos dados do estado
+bool successors_add_data(successors_t* successors, state_allocator_t* allocator, void* state_data, int cost, int h_delta)
+{
+  if(!successors->staging)
+  {
+    return successors_add_with_costs(successors, state_allocator_new(allocator, state_data), cost, h_delta);
+  }
+
+  if(!reserve_item(successors) || !reserve_pending(successors, allocator->struct_size))
+  {
+    // Falha na alocação de memória
+    return false;
+  }
+
+  // Guardamos os dados e o hash, o acesso à hashtable fica antecipado até o estado ser obtido
+  memcpy(successors->pending_data + successors->num_pending * successors->struct_size, state_data, successors->struct_size);
+  successors->pending_hashes[successors->num_pending++] = state_allocator_prefetch(allocator, state_data);
+
+  successor_t* successor = &successors->items[successors->size++];
+  successor->state = NULL;
+  successor->cost = cost;
+  successor->h_delta = h_delta;
+  return true;
+}
+
+// Obtém os estados de todos os sucessores pendentes
+bool successors_resolve(successors_t* successors, state_allocator_t* allocator)
+{
+  size_t next = 0;
+  for(size_t i = 0; i < successors->size && next < successors->num_pending; i++)
+  {
+    if(successors->items[i].state == NULL)
+    {
+      successors->items[i].state = state_allocator_new_hashed(
+          allocator, successors->pending_data + next * successors->struct_size, successors->pending_hashes[next]);
+      if(successors->items[i].state == NULL)
+      {
+        // Falha na alocação de memória, os sucessores ficam incompletos
+        successors->num_pending = 0;
+        return false;
+      }
+      next++;
+    }
+  }
+  successors->num_pending = 0;
+  return true;
+}
+
+// Esvazia o buffer, mantendo a memória para a próxima expansão
+void successors_clear(successors_t* successors)
+{
+  successors->size = 0;
+  successors->num_pending = 0;
+}
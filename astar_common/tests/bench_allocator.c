@@ -0,0 +1,133 @@
+/*
+  Benchmark do alocador com várias threads
+
+  Compara o alocador (blocos por thread, sem locks no caminho rápido) com a implementação anterior (um
+  mutex partilhado em todas as alocações) com 1 a 64 threads. Cada thread aloca o mesmo número de
+  estruturas do tamanho de um estado pequeno e escreve nelas, tal como os workers do algoritmo paralelo
+  ao gerar sucessores.
+
+  Utilização: bench_allocator [estruturas por thread] [máximo de threads]
+*/
+#include "allocator.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_STRUCTS 200000
+#define DEFAULT_MAX_THREADS 64
+#define STRUCT_SIZE 48
+#define LEGACY_PAGE_SIZE (64 * 1024 * 1024)
+
+// Implementação anterior do alocador (páginas com malloc e um mutex), utilizada como referência
+typedef struct
+{
+  void** pages;
+  size_t num_pages;
+  size_t offset;
+  pthread_mutex_t mutex;
+} legacy_allocator_t;
+
+static void* legacy_alloc(legacy_allocator_t* allocator)
+{
+  pthread_mutex_lock(&allocator->mutex);
+  if(allocator->num_pages == 0 || allocator->offset + STRUCT_SIZE > LEGACY_PAGE_SIZE)
+  {
+    allocator->pages = realloc(allocator->pages, (allocator->num_pages + 1) * sizeof(void*));
+    allocator->pages[allocator->num_pages++] = malloc(LEGACY_PAGE_SIZE);
+    allocator->offset = 0;
+  }
+  void* ptr = (char*)allocator->pages[allocator->num_pages - 1] + allocator->offset;
+  allocator->offset += STRUCT_SIZE;
+  pthread_mutex_unlock(&allocator->mutex);
+  return ptr;
+}
+
+typedef struct
+{
+  allocator_t* allocator;
+  legacy_allocator_t* legacy;
+  size_t count;
+  pthread_barrier_t* barrier;
+} bench_thread_t;
+
+static double elapsed(struct timespec start, struct timespec end)
+{
+  return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+static void* bench_thread(void* arg)
+{
+  bench_thread_t* thread = (bench_thread_t*)arg;
+  pthread_barrier_wait(thread->barrier);
+  for(size_t i = 0; i < thread->count; i++)
+  {
+    void* ptr = thread->allocator ? allocator_alloc(thread->allocator) : legacy_alloc(thread->legacy);
+    memset(ptr, (int)i, STRUCT_SIZE);
+  }
+  return NULL;
+}
+
+// Corre a carga num dos alocadores (allocator ou legacy), retorna o tempo total
+static double run(allocator_t* allocator, legacy_allocator_t* legacy, size_t count, size_t num_threads)
+{
+  pthread_t threads[num_threads];
+  bench_thread_t args[num_threads];
+  pthread_barrier_t barrier;
+  struct timespec start, end;
+
+  pthread_barrier_init(&barrier, NULL, (unsigned)num_threads + 1);
+  for(size_t t = 0; t < num_threads; t++)
+  {
+    args[t] = (bench_thread_t){ allocator, legacy, count, &barrier };
+    pthread_create(&threads[t], NULL, bench_thread, &args[t]);
+  }
+
+  pthread_barrier_wait(&barrier);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(size_t t = 0; t < num_threads; t++)
+  {
+    pthread_join(threads[t], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  pthread_barrier_destroy(&barrier);
+  return elapsed(start, end);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t count = DEFAULT_STRUCTS;
+  size_t max_threads = DEFAULT_MAX_THREADS;
+  if(argc > 1)
+  {
+    count = strtoul(argv[1], NULL, 10);
+  }
+  if(argc > 2)
+  {
+    max_threads = strtoul(argv[2], NULL, 10);
+  }
+
+  printf("Estruturas por thread: %zu (%d bytes)\n", count, STRUCT_SIZE);
+  for(size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+  {
+    legacy_allocator_t legacy = { NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER };
+    double legacy_time = run(NULL, &legacy, count, num_threads);
+    for(size_t i = 0; i < legacy.num_pages; i++)
+    {
+      free(legacy.pages[i]);
+    }
+    free(legacy.pages);
+
+    allocator_t* allocator = allocator_create(STRUCT_SIZE);
+    double time = run(allocator, NULL, count, num_threads);
+    allocator_destroy(allocator);
+
+    double total = (double)count * num_threads / 1e6;
+    printf("- %2zu threads: mutex %.6fs (%.2f Malloc/s), blocos por thread %.6fs (%.2f Malloc/s)\n", num_threads,
+           legacy_time, total / legacy_time, time, total / time);
+  }
+
+  return 0;
+}
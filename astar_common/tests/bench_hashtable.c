@@ -0,0 +1,146 @@
+/*
+  Benchmark da hashtable com várias threads
+
+  Mede a escalabilidade da hashtable com 1 a 64 threads numa carga semelhante à lista de estados do
+  algoritmo paralelo: cada thread insere (hashtable_insert_if_absent) uma fatia das chaves que se
+  sobrepõe à fatia da thread seguinte, assim metade das inserções encontram chaves inseridas por outra
+  thread, e depois procura (hashtable_contains) todas as chaves da sua fatia. Cada configuração é
+  verificada: cada chave tem de ser inserida exatamente uma vez.
+
+  Utilização: bench_hashtable [número de chaves] [máximo de threads]
+*/
+#include "hashtable.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_KEYS 4000000
+#define DEFAULT_MAX_THREADS 64
+
+typedef struct
+{
+  hashtable_t* hashtable;
+  uint64_t* keys; // Cópia das chaves desta thread
+  size_t num_keys;
+  size_t first; // Primeira chave da fatia da thread
+  size_t count; // Número de chaves da fatia
+  pthread_barrier_t* barrier;
+  atomic_size_t* inserted;
+  double insert_time;
+  double lookup_time;
+} bench_thread_t;
+
+static double elapsed(struct timespec start, struct timespec end)
+{
+  return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+static void* bench_thread(void* arg)
+{
+  bench_thread_t* thread = (bench_thread_t*)arg;
+  struct timespec start, end;
+  size_t inserted = 0;
+  size_t missing = 0;
+
+  pthread_barrier_wait(thread->barrier);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(size_t i = 0; i < thread->count; i++)
+  {
+    uint64_t* key = &thread->keys[(thread->first + i) % thread->num_keys];
+    inserted += hashtable_insert_if_absent(thread->hashtable, key) == key;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  thread->insert_time = elapsed(start, end);
+
+  pthread_barrier_wait(thread->barrier);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(size_t i = 0; i < thread->count; i++)
+  {
+    missing += hashtable_contains(thread->hashtable, &thread->keys[(thread->first + i) % thread->num_keys]) == NULL;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  thread->lookup_time = elapsed(start, end);
+
+  atomic_fetch_add(thread->inserted, inserted - missing);
+  return NULL;
+}
+
+// Corre a carga com num_threads threads, retorna falso se alguma chave foi inserida mais de uma vez ou perdida
+static bool run(uint64_t** keys, size_t num_keys, size_t num_threads)
+{
+  hashtable_t* hashtable = hashtable_create(sizeof(uint64_t), NULL, NULL);
+  pthread_t threads[num_threads];
+  bench_thread_t args[num_threads];
+  pthread_barrier_t barrier;
+  atomic_size_t inserted;
+
+  atomic_init(&inserted, 0);
+  pthread_barrier_init(&barrier, NULL, (unsigned)num_threads);
+
+  // A thread t trata os blocos t e t + 1 das chaves, com mais de uma thread cada chave é inserida duas
+  // vezes por threads vizinhas (que utilizam cópias diferentes das chaves)
+  for(size_t t = 0; t < num_threads; t++)
+  {
+    size_t first = t * num_keys / num_threads;
+    size_t end = num_threads == 1 ? num_keys : (t + 2) * num_keys / num_threads;
+    args[t] = (bench_thread_t){ hashtable, keys[t % 2], num_keys, first, end - first, &barrier, &inserted, 0, 0 };
+    pthread_create(&threads[t], NULL, bench_thread, &args[t]);
+  }
+
+  double insert_time = 0, lookup_time = 0;
+  size_t operations = 0;
+  for(size_t t = 0; t < num_threads; t++)
+  {
+    pthread_join(threads[t], NULL);
+    insert_time = args[t].insert_time > insert_time ? args[t].insert_time : insert_time;
+    lookup_time = args[t].lookup_time > lookup_time ? args[t].lookup_time : lookup_time;
+    operations += args[t].count;
+  }
+
+  bool valid = atomic_load(&inserted) == num_keys;
+  printf("- %2zu threads: inserções %.6fs (%.2f Mops/s), procuras %.6fs (%.2f Mops/s)%s\n", num_threads, insert_time,
+         operations / insert_time / 1e6, lookup_time, operations / lookup_time / 1e6, valid ? "" : " INVÁLIDO");
+
+  pthread_barrier_destroy(&barrier);
+  hashtable_destroy(hashtable, false);
+  return valid;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t num_keys = DEFAULT_KEYS;
+  size_t max_threads = DEFAULT_MAX_THREADS;
+  if(argc > 1)
+  {
+    num_keys = strtoul(argv[1], NULL, 10);
+  }
+  if(argc > 2)
+  {
+    max_threads = strtoul(argv[2], NULL, 10);
+  }
+
+  // Duas cópias das chaves, as threads vizinhas inserem chaves iguais com ponteiros diferentes
+  uint64_t* keys[2] = { malloc(num_keys * sizeof(uint64_t)), malloc(num_keys * sizeof(uint64_t)) };
+  if(keys[0] == NULL || keys[1] == NULL)
+  {
+    return 1;
+  }
+  for(size_t i = 0; i < num_keys; i++)
+  {
+    keys[0][i] = keys[1][i] = i * 0x9e3779b97f4a7c15ULL;
+  }
+
+  printf("Chaves: %zu\n", num_keys);
+  bool valid = true;
+  for(size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2)
+  {
+    valid &= run(keys, num_keys, num_threads);
+  }
+
+  free(keys[0]);
+  free(keys[1]);
+  return valid ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/*
+  Benchmark do min-heap
+
+  Compara os tipos de heap (binário, 4-ário, 8-ário e bucket queue) com a implementação anterior (heap binário
+  recursivo com elementos {int cost; void* data}) numa carga semelhante à do algoritmo A*: a fronteira
+  cresce até N elementos e depois alternam-se extrações com inserções de sucessores com custo igual
+  ou ligeiramente superior ao do nó extraído. Os novos heaps mantêm os handles tal como no algoritmo.
+
+  Utilização: bench_min_heap [número de elementos]
+*/
+#include "min_heap.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ELEMENTS 2000000
+#define BRANCHING 3
+
+typedef struct
+{
+  int cost;
+  size_t index;
+} bench_item_t;
+
+// Implementação anterior do heap, utilizada como referência
+typedef struct
+{
+  int cost;
+  void* data;
+} legacy_node_t;
+
+typedef struct
+{
+  legacy_node_t* data;
+  size_t capacity;
+  size_t size;
+} legacy_heap_t;
+
+static void legacy_heapify_up(legacy_heap_t* heap, size_t index)
+{
+  if(index == 0)
+    return;
+
+  size_t parent_index = (index - 1) / 2;
+  if(heap->data[index].cost < heap->data[parent_index].cost)
+  {
+    legacy_node_t temp = heap->data[index];
+    heap->data[index] = heap->data[parent_index];
+    heap->data[parent_index] = temp;
+    legacy_heapify_up(heap, parent_index);
+  }
+}
+
+static void legacy_heapify_down(legacy_heap_t* heap, size_t index)
+{
+  size_t left_child_index = 2 * index + 1;
+  size_t right_child_index = 2 * index + 2;
+  size_t smallest = index;
+
+  if(left_child_index < heap->size && heap->data[left_child_index].cost < heap->data[smallest].cost)
+    smallest = left_child_index;
+
+  if(right_child_index < heap->size && heap->data[right_child_index].cost < heap->data[smallest].cost)
+    smallest = right_child_index;
+
+  if(smallest != index)
+  {
+    legacy_node_t temp = heap->data[index];
+    heap->data[index] = heap->data[smallest];
+    heap->data[smallest] = temp;
+    legacy_heapify_down(heap, smallest);
+  }
+}
+
+static void legacy_insert(legacy_heap_t* heap, int cost, void* data)
+{
+  if(heap->size == heap->capacity)
+  {
+    heap->capacity *= 2;
+    heap->data = (legacy_node_t*)realloc(heap->data, heap->capacity * sizeof(legacy_node_t));
+  }
+
+  heap->data[heap->size].cost = cost;
+  heap->data[heap->size].data = data;
+  heap->size++;
+  legacy_heapify_up(heap, heap->size - 1);
+}
+
+static legacy_node_t legacy_pop(legacy_heap_t* heap)
+{
+  legacy_node_t min_node = heap->data[0];
+  heap->data[0] = heap->data[heap->size - 1];
+  heap->size--;
+  legacy_heapify_down(heap, 0);
+  return min_node;
+}
+
+static double elapsed(struct timespec start, struct timespec end)
+{
+  return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+// Corre a carga na implementação anterior
+static double run_legacy(bench_item_t* items, size_t num_items)
+{
+  legacy_heap_t heap = { malloc(8196 * sizeof(legacy_node_t)), 8196, 0 };
+  struct timespec start, end;
+  unsigned seed = 42;
+  size_t next = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  legacy_insert(&heap, 0, &items[next++]);
+  while(heap.size)
+  {
+    legacy_node_t top = legacy_pop(&heap);
+    for(int i = 0; i < BRANCHING && next < num_items; i++)
+    {
+      items[next].cost = top.cost + (int)(rand_r(&seed) % 3);
+      legacy_insert(&heap, items[next].cost, &items[next]);
+      next++;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  free(heap.data);
+  return elapsed(start, end);
+}
+
+// Corre a carga num dos tipos de heap, com handles
+static double run_heap(enum min_heap_type_e type, bench_item_t* items, size_t num_items)
+{
+  min_heap_t* heap = min_heap_create(type, MIN_HEAP_TIE_NONE, offsetof(bench_item_t, index));
+  struct timespec start, end;
+  unsigned seed = 42;
+  size_t next = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  min_heap_insert(heap, 0, 0, &items[next++]);
+  while(heap->size)
+  {
+    heap_node_t top = min_heap_pop(heap);
+    int cost = min_heap_cost(top.key);
+    for(int i = 0; i < BRANCHING && next < num_items; i++)
+    {
+      items[next].cost = cost + (int)(rand_r(&seed) % 3);
+      min_heap_insert(heap, items[next].cost, 0, &items[next]);
+      next++;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  min_heap_destroy(heap);
+  return elapsed(start, end);
+}
+
+int main(int argc, char* argv[])
+{
+  size_t num_items = DEFAULT_ELEMENTS;
+  if(argc > 1)
+  {
+    num_items = strtoul(argv[1], NULL, 10);
+  }
+
+  bench_item_t* items = (bench_item_t*)malloc(num_items * sizeof(bench_item_t));
+  if(items == NULL)
+  {
+    return 1;
+  }
+
+  printf("Elementos: %zu\n", num_items);
+  printf("- heap anterior (binário, recursivo): %.6fs\n", run_legacy(items, num_items));
+  printf("- heap binário: %.6fs\n", run_heap(MIN_HEAP_BINARY, items, num_items));
+  printf("- heap 4-ário: %.6fs\n", run_heap(MIN_HEAP_4ARY, items, num_items));
+  printf("- heap 8-ário: %.6fs\n", run_heap(MIN_HEAP_8ARY, items, num_items));
+  printf("- bucket queue: %.6fs\n", run_heap(MIN_HEAP_BUCKET, items, num_items));
+
+  free(items);
+  return 0;
+}
@@ -1,6 +1,8 @@
 #include "allocator.h"
 #include <check.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 typedef struct
 {
@@ -30,12 +32,207 @@ START_TEST(test_allocator_alloc)
 }
 END_TEST
 
+// Páginas pequenas: as estruturas ocupam várias páginas e vários blocos em cada página
+START_TEST(test_allocator_pages)
+{
+  const size_t count = 20000;
+  allocator_t* allocator = allocator_create_paged(1000, 3 * 1024 * 1024, ALLOCATOR_HUGE_PAGES);
+  ck_assert_ptr_nonnull(allocator);
+  ck_assert_uint_eq(allocator->page_size % ALLOCATOR_COMMIT_CHUNK, 0);
+
+  char** structs = (char**)malloc(count * sizeof(char*));
+  for(size_t i = 0; i < count; i++)
+  {
+    structs[i] = (char*)allocator_alloc(allocator);
+    ck_assert_ptr_nonnull(structs[i]);
+    memset(structs[i], (int)(i & 0xff), 1000);
+  }
+  ck_assert_uint_gt(allocator->num_pages, 1);
+
+  for(size_t i = 0; i < count; i++)
+  {
+    ck_assert_int_eq(structs[i][0], (char)(i & 0xff));
+    ck_assert_int_eq(structs[i][999], (char)(i & 0xff));
+  }
+
+  free(structs);
+  allocator_destroy(allocator);
+
+  // Com páginas grandes explícitas (utiliza páginas normais se o sistema não as tiver)
+  allocator = allocator_create_paged(sizeof(my_struct_t), 0, ALLOCATOR_HUGETLB);
+  my_struct_t* my_struct = (my_struct_t*)allocator_alloc(allocator);
+  ck_assert_ptr_nonnull(my_struct);
+  my_struct->id = 3;
+  ck_assert_int_eq(my_struct->id, 3);
+  allocator_destroy(allocator);
+
+  // Estruturas maiores que a página não são aceites
+  ck_assert_ptr_null(allocator_create_paged(ALLOCATOR_COMMIT_CHUNK + 1, ALLOCATOR_COMMIT_CHUNK, 0));
+}
+END_TEST
+
+#define THREADS 8
+#define THREAD_STRUCTS 50000
+
+// Cada thread aloca estruturas e marca-as com o seu número e o índice da estrutura
+static void* alloc_thread(void* arg)
+{
+  allocator_t* allocator = ((void**)arg)[0];
+  my_struct_t** structs = ((void**)arg)[1];
+  int thread = (int)(size_t)((void**)arg)[2];
+
+  for(int i = 0; i < THREAD_STRUCTS; i++)
+  {
+    structs[i] = (my_struct_t*)allocator_alloc(allocator);
+    structs[i]->id = thread * THREAD_STRUCTS + i;
+  }
+  return NULL;
+}
+
+// Várias threads a alocar do mesmo alocador (páginas pequenas para mudar de página muitas vezes), as
+// estruturas não se podem sobrepor
+START_TEST(test_allocator_threads)
+{
+  allocator_t* allocator = allocator_create_paged(sizeof(my_struct_t), ALLOCATOR_COMMIT_CHUNK * 2, 0);
+  pthread_t threads[THREADS];
+  void* args[THREADS][3];
+  my_struct_t** structs = (my_struct_t**)malloc(THREADS * THREAD_STRUCTS * sizeof(my_struct_t*));
+
+  for(int t = 0; t < THREADS; t++)
+  {
+    args[t][0] = allocator;
+    args[t][1] = &structs[t * THREAD_STRUCTS];
+    args[t][2] = (void*)(size_t)t;
+    pthread_create(&threads[t], NULL, alloc_thread, args[t]);
+  }
+  for(int t = 0; t < THREADS; t++)
+  {
+    pthread_join(threads[t], NULL);
+  }
+
+  for(int i = 0; i < THREADS * THREAD_STRUCTS; i++)
+  {
+    ck_assert_ptr_nonnull(structs[i]);
+    ck_assert_int_eq(structs[i]->id, i);
+  }
+
+  free(structs);
+  allocator_destroy(allocator);
+}
+END_TEST
+
+// Depois de reiniciar, as estruturas voltam a ser alocadas das páginas já existentes
+START_TEST(test_allocator_reset)
+{
+  allocator_t* allocator = allocator_create_paged(1000, ALLOCATOR_COMMIT_CHUNK * 2, 0);
+  const size_t count = 10000;
+
+  void* first = allocator_alloc(allocator);
+  for(size_t i = 1; i < count; i++)
+  {
+    memset(allocator_alloc(allocator), 1, 1000);
+  }
+  size_t num_pages = allocator->num_pages;
+  ck_assert_uint_gt(num_pages, 1);
+
+  // Cada bloco leva 2097 estruturas
+  size_t chunks = (count + 2096) / 2097;
+  memory_usage_t usage = { 0, 0 };
+  allocator_memory(allocator, &usage);
+  ck_assert_uint_eq(usage.used, chunks * ALLOCATOR_COMMIT_CHUNK);
+  ck_assert_uint_eq(usage.reserved, sizeof(allocator_t) + chunks * ALLOCATOR_COMMIT_CHUNK);
+
+  // Depois do reset os blocos continuam reservados, o identificador mantém-se
+  uint64_t id = allocator->id;
+  allocator_reset(allocator);
+  ck_assert_uint_eq(allocator->id, id);
+  usage = (memory_usage_t){ 0, 0 };
+  allocator_memory(allocator, &usage);
+  ck_assert_uint_eq(usage.used, 0);
+  ck_assert_uint_eq(usage.reserved, sizeof(allocator_t) + chunks * ALLOCATOR_COMMIT_CHUNK);
+
+  ck_assert_ptr_eq(allocator_alloc(allocator), first);
+  for(size_t i = 1; i < count; i++)
+  {
+    memset(allocator_alloc(allocator), 2, 1000);
+  }
+  ck_assert_uint_eq(allocator->num_pages, num_pages);
+
+  allocator_destroy(allocator);
+}
+END_TEST
+
+// Os índices das estruturas são consecutivos e permitem voltar a obter cada estrutura
+START_TEST(test_allocator_index)
+{
+  // Estruturas que não dividem o bloco, as últimas posições de cada bloco ficam por utilizar
+  allocator_t* allocator = allocator_create_paged(1000, ALLOCATOR_COMMIT_CHUNK * 2, 0);
+  const size_t count = 10000;
+
+  for(size_t i = 0; i < count; i++)
+  {
+    void* ptr = allocator_alloc(allocator);
+    ck_assert_uint_eq(allocator_index_of(allocator, ptr), i);
+    ck_assert_ptr_eq(allocator_at(allocator, i), ptr);
+  }
+  ck_assert_uint_gt(allocator->num_pages, 1);
+
+  // O índice das páginas está ordenado pelo endereço
+  for(size_t i = 1; i < allocator->num_pages; i++)
+  {
+    ck_assert((char*)allocator->pages[allocator->sorted_pages[i - 1]] < (char*)allocator->pages[allocator->sorted_pages[i]]);
+  }
+
+  int outside;
+  ck_assert_uint_eq(allocator_index_of(allocator, &outside), SIZE_MAX);
+
+  allocator_destroy(allocator);
+}
+END_TEST
+
+// Dois alocadores com a mesma posição inicial nos blocos da thread, alocações alternadas não podem substituir
+// o bloco do outro alocador
+START_TEST(test_allocator_cache_collision)
+{
+  const size_t count = 200000;
+  allocator_t* first = allocator_create(64);
+  allocator_t* second = allocator_create(64);
+  while(((first->id ^ second->id) & (ALLOCATOR_THREAD_CACHES - 1)) != 0)
+  {
+    allocator_destroy(second);
+    second = allocator_create(64);
+  }
+
+  for(size_t i = 0; i < count; i++)
+  {
+    ck_assert_ptr_nonnull(allocator_alloc(first));
+    ck_assert_ptr_nonnull(allocator_alloc(second));
+  }
+
+  // Cada alocador só utiliza os blocos necessários para as suas estruturas, numa única página
+  size_t chunks = (count + first->chunk_structs - 1) / first->chunk_structs;
+  memory_usage_t usage = { 0, 0 };
+  allocator_memory(first, &usage);
+  ck_assert_uint_eq(usage.used, chunks * ALLOCATOR_COMMIT_CHUNK);
+  ck_assert_uint_eq(first->num_pages, 1);
+  ck_assert_uint_eq(second->num_pages, 1);
+
+  allocator_destroy(first);
+  allocator_destroy(second);
+}
+END_TEST
+
 Suite* allocator_suite()
 {
   Suite* suite = suite_create("allocator_t");
   TCase* test_case = tcase_create("allocation");
 
   tcase_add_test(test_case, test_allocator_alloc);
+  tcase_add_test(test_case, test_allocator_pages);
+  tcase_add_test(test_case, test_allocator_threads);
+  tcase_add_test(test_case, test_allocator_reset);
+  tcase_add_test(test_case, test_allocator_index);
+  tcase_add_test(test_case, test_allocator_cache_collision);
 
   suite_add_tcase(suite, test_case);
 
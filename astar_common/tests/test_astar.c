@@ -11,9 +11,9 @@ typedef struct
 
 START_TEST(test_astar)
 {
-  state_allocator_t* allocator = state_allocator_create(sizeof(my_struct_t));
+  state_allocator_t* allocator = state_allocator_create(sizeof(my_struct_t), sizeof(a_star_node_t));
 
-  a_star_t* a_star = a_star_create(sizeof(my_struct_t), NULL, NULL, NULL, NULL, NULL);
+  a_star_t* a_star = a_star_create(sizeof(my_struct_t), NULL, NULL, NULL, NULL, NULL, NULL);
 
   my_struct_t state_data_1 = { 2, 2 };
   my_struct_t state_data_2 = { 3, 3 };
@@ -74,12 +74,56 @@ START_TEST(test_astar)
 }
 END_TEST
 
+// Com nós compactos a solução é copiada para nós normais, do objetivo até ao estado inicial
+START_TEST(test_astar_compact_solution)
+{
+  a_star_options_t options;
+  a_star_options_default(&options);
+  options.compact_nodes = true;
+
+  a_star_t* a_star = a_star_create(sizeof(my_struct_t), NULL, NULL, NULL, NULL, NULL, &options);
+  ck_assert_ptr_nonnull(a_star->node_store);
+  ck_assert_int_eq(a_star->state_allocator->node_size, 0);
+
+  node_store_t* store = a_star->node_store;
+  node_id_t ids[3];
+  for(int i = 0; i < 3; i++)
+  {
+    my_struct_t data = { i, i };
+    ids[i] = node_store_id(store, state_allocator_new(a_star->state_allocator, &data));
+    store->g[ids[i]] = i;
+    store->h[ids[i]] = 2 - i;
+    store->parent[ids[i]] = i > 0 ? ids[i - 1] : NODE_NONE;
+  }
+
+  ck_assert(a_star_set_compact_solution(a_star, ids[2]));
+  a_star_node_t* node = a_star->solution;
+  for(int i = 2; i >= 0; i--)
+  {
+    ck_assert_ptr_nonnull(node);
+    ck_assert_int_eq(node->g, i);
+    ck_assert_int_eq(node->h, 2 - i);
+    ck_assert_int_eq(((my_struct_t*)node->state->data)->x, i);
+    node = node->parent;
+  }
+  ck_assert_ptr_null(node);
+
+  // O reset descarta a solução e os nós
+  a_star_reset(a_star);
+  ck_assert_ptr_null(a_star->solution);
+  ck_assert(!node_store_exists(store, ids[0]));
+
+  a_star_destroy(a_star);
+}
+END_TEST
+
 Suite* allocator_suite()
 {
   Suite* suite = suite_create("astar_t");
   TCase* test_case = tcase_create("astar test");
 
   tcase_add_test(test_case, test_astar);
+  tcase_add_test(test_case, test_astar_compact_solution);
 
   suite_add_tcase(suite, test_case);
 
@@ -1,5 +1,6 @@
 #include "channel.h"
 #include <check.h>
+#include <pthread.h>
 #include <stdlib.h>
 
 // Teste de criação do canal
@@ -41,7 +42,126 @@ START_TEST(test_channel_send_receive)
   ck_assert_int_eq(data[0], data1);
   ck_assert_int_eq(data[1], data2);
 
-  free(data);
+  channel_destroy(channel);
+}
+END_TEST
+
+// Teste da receção sem cópias: os buffers de escrita e de leitura alternam e crescem quando estão cheios
+START_TEST(test_channel_buffers)
+{
+  channel_t* channel = channel_create(1, sizeof(int));
+  size_t len;
+
+  ck_assert_ptr_null(channel_receive(channel, 0, &len));
+  ck_assert_uint_eq(len, 0);
+
+  int data = 1;
+  channel_send(channel, 0, &data);
+  int* first = (int*)channel_receive(channel, 0, &len);
+  ck_assert_uint_eq(len, 1);
+
+  // A segunda receção é no outro buffer, a primeira continua válida até à terceira
+  data = 2;
+  channel_send(channel, 0, &data);
+  int* second = (int*)channel_receive(channel, 0, &len);
+  ck_assert_ptr_ne(first, second);
+  ck_assert_int_eq(first[0], 1);
+  ck_assert_int_eq(second[0], 2);
+
+  data = 3;
+  channel_send(channel, 0, &data);
+  ck_assert_ptr_eq(channel_receive(channel, 0, &len), first);
+  ck_assert_int_eq(first[0], 3);
+
+  // Mais mensagens do que a capacidade inicial, recebidas por ordem
+  int count = 3 * QUEUE_BUFFER_SIZE;
+  for(int i = 0; i < count; i++)
+  {
+    ck_assert(channel_send(channel, 0, &i));
+  }
+  int* messages = (int*)channel_receive(channel, 0, &len);
+  ck_assert_uint_eq(len, count);
+  for(int i = 0; i < count; i++)
+  {
+    ck_assert_int_eq(messages[i], i);
+  }
+  ck_assert(!channel_has_messages(channel, 0));
+
+  channel_destroy(channel);
+}
+END_TEST
+
+// Teste do envio de blocos de mensagens, acrescentados por ordem às mensagens já enviadas
+START_TEST(test_channel_send_batch)
+{
+  channel_t* channel = channel_create(2, sizeof(int));
+  int single = -1;
+  int block[3 * QUEUE_BUFFER_SIZE];
+  for(int i = 0; i < 3 * QUEUE_BUFFER_SIZE; i++)
+  {
+    block[i] = i;
+  }
+
+  channel_send(channel, 1, &single);
+  ck_assert(channel_send_batch(channel, 1, block, 3 * QUEUE_BUFFER_SIZE));
+  ck_assert(channel_send_batch(channel, 1, block, 0));
+  ck_assert(!channel_has_messages(channel, 0));
+
+  size_t len;
+  int* data = (int*)channel_receive(channel, 1, &len);
+  ck_assert_uint_eq(len, 3 * QUEUE_BUFFER_SIZE + 1);
+  ck_assert_int_eq(data[0], single);
+  for(int i = 0; i < 3 * QUEUE_BUFFER_SIZE; i++)
+  {
+    ck_assert_int_eq(data[i + 1], i);
+  }
+
+  channel_destroy(channel);
+}
+END_TEST
+
+// Thread que bloqueia à espera de mensagens na fila 1
+static void* wait_queue(void* arg)
+{
+  channel_t* channel = (channel_t*)arg;
+  return channel_wait(channel, 1) ? channel : NULL;
+}
+
+// Teste do bloqueio à espera de mensagens: acorda com uma mensagem ou quando o canal é fechado
+START_TEST(test_channel_wait)
+{
+  channel_t* channel = channel_create(2, sizeof(int));
+  int data = 10;
+  void* result;
+  pthread_t thread;
+
+  // Acorda com uma mensagem na sua fila
+  pthread_create(&thread, NULL, wait_queue, channel);
+  channel_send(channel, 1, &data);
+  pthread_join(thread, &result);
+  ck_assert_ptr_eq(result, channel);
+
+  // Com mensagens na fila não bloqueia
+  ck_assert(channel_wait(channel, 1));
+
+  // Sem mensagens, acorda quando o canal é fechado
+  size_t len;
+  channel_receive(channel, 1, &len);
+  pthread_create(&thread, NULL, wait_queue, channel);
+  channel_close(channel);
+  pthread_join(thread, &result);
+  ck_assert_ptr_null(result);
+  ck_assert(!channel_wait(channel, 0));
+
+  ck_assert(!channel_wait_timed(channel, 0, 1000000));
+
+  // O reset volta a abrir o canal, a espera com tempo limite termina sem mensagens
+  channel_reset(channel);
+  ck_assert(channel_wait_timed(channel, 0, 1000000));
+  ck_assert(!channel_has_messages(channel, 0));
+  channel_send(channel, 0, &data);
+  ck_assert(channel_wait(channel, 0));
+  ck_assert(channel_wait_timed(channel, 0, 1000000));
 
   channel_destroy(channel);
 }
@@ -56,6 +176,9 @@ int main(void)
   // Adiciona os testes ao caso de teste
   tcase_add_test(testcase, test_channel_create);
   tcase_add_test(testcase, test_channel_send_receive);
+  tcase_add_test(testcase, test_channel_buffers);
+  tcase_add_test(testcase, test_channel_send_batch);
+  tcase_add_test(testcase, test_channel_wait);
 
   // Adiciona o caso de teste à suíte
   suite_add_tcase(suite, testcase);
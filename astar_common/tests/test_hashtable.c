@@ -1,7 +1,9 @@
 #include "hashtable.h"
 #include <check.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Struct de exemplo
 typedef struct
@@ -42,9 +44,211 @@ START_TEST(test_hashtable)
 }
 END_TEST
 
-// TODO: Escrever teste para quando se usam ponteiros e precisamos de libertar dados
+// Comparador que apenas considera o identificador
+static bool compare_person_id(hashtable_t* hashtable, const void* a, const void* b)
+{
+  (void)hashtable;
+  return ((const Person*)a)->id == ((const Person*)b)->id;
+}
+
+// Função de hash que gera muitas colisões, todas as pessoas caem num de 4 valores
+static size_t bad_person_hash(hashtable_t* hashtable, const void* data)
+{
+  (void)hashtable;
+  return ((const Person*)data)->id % 4;
+}
+
+// Teste com muitas entradas (a tabela cresce de forma incremental), colisões, comparador e dados libertados no fim
+START_TEST(test_hashtable_growth)
+{
+  hashtable_t* hashtable = hashtable_create(sizeof(Person), compare_person_id, bad_person_hash);
+  const int count = 20000;
+
+  for(int i = 0; i < count; i++)
+  {
+    Person* person = (Person*)malloc(sizeof(Person));
+    person->id = i;
+    person->name[0] = '\0';
+
+    // A primeira reserva insere, a segunda encontra a pessoa já inserida
+    ck_assert_ptr_eq(hashtable_insert_if_absent(hashtable, person), person);
+    Person copy = *person;
+    ck_assert_ptr_eq(hashtable_insert_if_absent(hashtable, &copy), person);
+
+    // Enquanto as partições crescem (transferência incremental) as entradas anteriores continuam visíveis
+    Person earlier = { i / 2, "" };
+    ck_assert_ptr_nonnull(hashtable_contains(hashtable, &earlier));
+  }
+
+  for(int i = 0; i < count; i++)
+  {
+    Person probe = { i, "" };
+    Person* found = (Person*)hashtable_contains(hashtable, &probe);
+    ck_assert_ptr_nonnull(found);
+    ck_assert_int_eq(found->id, i);
+  }
+
+  Person missing = { count, "" };
+  ck_assert_ptr_null(hashtable_contains(hashtable, &missing));
+
+  hashtable_destroy(hashtable, true);
+}
+END_TEST
+
+// Depois de reiniciar, a hashtable (com partições que cresceram) fica vazia e volta a aceitar as mesmas entradas
+START_TEST(test_hashtable_reset)
+{
+  hashtable_t* hashtable = hashtable_create(sizeof(Person), NULL, NULL);
+  const int count = 50000;
+  Person* people = (Person*)calloc(count, sizeof(Person));
+  for(int i = 0; i < count; i++)
+  {
+    people[i].id = i;
+  }
+
+  for(int round = 0; round < 3; round++)
+  {
+    // Na primeira ronda todas as entradas, nas seguintes apenas uma parte
+    int inserted = round == 0 ? count : count / (round * 10);
+    for(int i = 0; i < inserted; i++)
+    {
+      ck_assert_ptr_eq(hashtable_insert_if_absent(hashtable, &people[i]), &people[i]);
+    }
+    for(int i = 0; i < count; i++)
+    {
+      ck_assert_ptr_eq(hashtable_contains(hashtable, &people[i]), i < inserted ? &people[i] : NULL);
+    }
+    ck_assert_uint_eq(hashtable_count(hashtable), inserted);
+
+    // A memória utilizada são as entradas ocupadas, os arrays das partições são a maior parte da reservada
+    memory_usage_t usage = { 0, 0 };
+    hashtable_memory(hashtable, &usage);
+    ck_assert_uint_eq(usage.used, inserted * sizeof(hashtable_entry_t));
+    ck_assert_uint_ge(usage.reserved, usage.used);
+
+    hashtable_reset(hashtable);
+    ck_assert_uint_eq(hashtable_count(hashtable), 0);
+    for(int i = 0; i < count; i++)
+    {
+      ck_assert_ptr_null(hashtable_contains(hashtable, &people[i]));
+    }
+  }
+
+  hashtable_destroy(hashtable, false);
+  free(people);
+}
+END_TEST
 
-// TODO: Escrever teste para testar uso de comparador
+#define CONCURRENT_THREADS 8
+#define CONCURRENT_COUNT 5000
+
+// Dados de cada thread do teste concorrente, todas as threads inserem as mesmas pessoas (cópias próprias)
+typedef struct
+{
+  hashtable_t* hashtable;
+  Person* people;
+  Person** results;
+} concurrent_args_t;
+
+static void* concurrent_insert(void* arg)
+{
+  concurrent_args_t* args = (concurrent_args_t*)arg;
+  for(int i = 0; i < CONCURRENT_COUNT; i++)
+  {
+    args->results[i] = (Person*)hashtable_insert_if_absent(args->hashtable, &args->people[i]);
+  }
+  return NULL;
+}
+
+// Várias threads inserem as mesmas pessoas em simultâneo enquanto as partições crescem, cada pessoa
+// só pode ser inserida uma vez e todas as threads têm de receber o mesmo ponteiro
+START_TEST(test_hashtable_concurrent)
+{
+  hashtable_t* hashtable = hashtable_create(sizeof(Person), compare_person_id, bad_person_hash);
+  pthread_t threads[CONCURRENT_THREADS];
+  concurrent_args_t args[CONCURRENT_THREADS];
+
+  for(int t = 0; t < CONCURRENT_THREADS; t++)
+  {
+    args[t].hashtable = hashtable;
+    args[t].people = (Person*)calloc(CONCURRENT_COUNT, sizeof(Person));
+    args[t].results = (Person**)calloc(CONCURRENT_COUNT, sizeof(Person*));
+    for(int i = 0; i < CONCURRENT_COUNT; i++)
+    {
+      args[t].people[i].id = i;
+    }
+  }
+
+  for(int t = 0; t < CONCURRENT_THREADS; t++)
+  {
+    pthread_create(&threads[t], NULL, concurrent_insert, &args[t]);
+  }
+  for(int t = 0; t < CONCURRENT_THREADS; t++)
+  {
+    pthread_join(threads[t], NULL);
+  }
+
+  for(int i = 0; i < CONCURRENT_COUNT; i++)
+  {
+    Person probe = { i, "" };
+    Person* found = (Person*)hashtable_contains(hashtable, &probe);
+    ck_assert_ptr_nonnull(found);
+    ck_assert_int_eq(found->id, i);
+
+    // O ponteiro é de uma das threads e foi o que todas receberam
+    int owners = 0;
+    for(int t = 0; t < CONCURRENT_THREADS; t++)
+    {
+      ck_assert_ptr_eq(args[t].results[i], found);
+      owners += found == &args[t].people[i];
+    }
+    ck_assert_int_eq(owners, 1);
+  }
+
+  hashtable_destroy(hashtable, false);
+  for(int t = 0; t < CONCURRENT_THREADS; t++)
+  {
+    free(args[t].people);
+    free(args[t].results);
+  }
+}
+END_TEST
+
+// Teste da função de hash: determinista, independente do alinhamento e sensível a qualquer byte
+START_TEST(test_hash_function)
+{
+  unsigned char buffer[256 + 1];
+  for(size_t i = 0; i < sizeof(buffer); i++)
+  {
+    buffer[i] = (unsigned char)(i * 31 + 7);
+  }
+
+  for(size_t size = 0; size <= 200; size++)
+  {
+    size_t value = hash_function(buffer, size);
+    ck_assert_uint_eq(value, hash_function(buffer, size));
+
+    // Os mesmos dados num endereço desalinhado
+    unsigned char copy[256];
+    memcpy(copy + 1, buffer, size);
+    ck_assert_uint_eq(value, hash_function(copy + 1, size));
+
+    // Alterar qualquer byte altera o hash
+    for(size_t i = 0; i < size; i++)
+    {
+      buffer[i] ^= 1;
+      ck_assert_uint_ne(value, hash_function(buffer, size));
+      buffer[i] ^= 1;
+    }
+
+    // O tamanho também faz parte do hash
+    if(size > 0)
+    {
+      ck_assert_uint_ne(value, hash_function(buffer, size - 1));
+    }
+  }
+}
+END_TEST
 
 // Função principal dos testes
 int main(void)
@@ -55,6 +259,10 @@ int main(void)
   // Adiciona o teste à suite
   TCase* tcase = tcase_create("Core");
   tcase_add_test(tcase, test_hashtable);
+  tcase_add_test(tcase, test_hashtable_growth);
+  tcase_add_test(tcase, test_hashtable_concurrent);
+  tcase_add_test(tcase, test_hashtable_reset);
+  tcase_add_test(tcase, test_hash_function);
   suite_add_tcase(suite, tcase);
 
   // Cria um objeto de retorno do teste
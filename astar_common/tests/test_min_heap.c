@@ -1,24 +1,43 @@
 #include "min_heap.h"
 #include <check.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+// Elemento com handle para a posição no heap
+typedef struct
+{
+  int cost;
+  size_t index;
+} indexed_item_t;
+
+// Verifica se todos os handles correspondem à posição real no heap
+static void assert_indexes(min_heap_t* heap)
+{
+  for(size_t i = 0; i < heap->size; i++)
+  {
+    ck_assert_uint_eq(((indexed_item_t*)heap->data[i].data)->index, i);
+  }
+}
+
 // Caso de teste: Testar a inserção de elementos no min-heap
 START_TEST(test_insert)
 {
   // Criar um novo min-heap
-  min_heap_t* heap = min_heap_create();
+  min_heap_t* heap = min_heap_create(MIN_HEAP_BINARY, MIN_HEAP_TIE_NONE, MIN_HEAP_NO_INDEX);
 
   // Inserir elementos no heap
-  min_heap_insert(heap, 5, NULL);
-  min_heap_insert(heap, 10, NULL);
-  min_heap_insert(heap, 3, NULL);
+  min_heap_insert(heap, 5, 0, NULL);
+  min_heap_insert(heap, 10, 0, NULL);
+  min_heap_insert(heap, 3, 0, NULL);
 
   // Verificar o tamanho do heap após a inserção de elementos
   ck_assert_int_eq(heap->size, 3);
 
   // Verificar a propriedade do min-heap
-  ck_assert(heap->data[0].cost <= heap->data[1].cost);
-  ck_assert(heap->data[0].cost <= heap->data[2].cost);
+  ck_assert(heap->data[0].key <= heap->data[1].key);
+  ck_assert(heap->data[0].key <= heap->data[2].key);
 
   // Destruir o min-heap
   min_heap_destroy(heap);
@@ -29,18 +48,18 @@ END_TEST
 START_TEST(test_extract_min)
 {
   // Criar um novo min-heap
-  min_heap_t* heap = min_heap_create();
+  min_heap_t* heap = min_heap_create(MIN_HEAP_BINARY, MIN_HEAP_TIE_NONE, MIN_HEAP_NO_INDEX);
 
   // Inserir elementos no heap
-  min_heap_insert(heap, 5, NULL);
-  min_heap_insert(heap, 10, NULL);
-  min_heap_insert(heap, 3, NULL);
+  min_heap_insert(heap, 5, 0, NULL);
+  min_heap_insert(heap, 10, 0, NULL);
+  min_heap_insert(heap, 3, 0, NULL);
 
   // Extrair o elemento mínimo do heap
   heap_node_t min_node = min_heap_pop(heap);
 
   // Verificar o elemento mínimo extraído
-  ck_assert_int_eq(min_node.cost, 3);
+  ck_assert_int_eq(min_heap_cost(min_node.key), 3);
 
   // Verificar o tamanho do heap após a extração
   ck_assert_int_eq(heap->size, 2);
@@ -53,12 +72,12 @@ END_TEST
 // Teste para remover um nó específico do heap
 START_TEST(test_remove_node)
 {
-  min_heap_t* heap = min_heap_create();
+  min_heap_t* heap = min_heap_create(MIN_HEAP_BINARY, MIN_HEAP_TIE_NONE, MIN_HEAP_NO_INDEX);
 
   // Insere elementos no heap
-  min_heap_insert(heap, 5, NULL);
-  min_heap_insert(heap, 10, NULL);
-  min_heap_insert(heap, 3, NULL);
+  min_heap_insert(heap, 5, 0, NULL);
+  min_heap_insert(heap, 10, 0, NULL);
+  min_heap_insert(heap, 3, 0, NULL);
 
   // Remove um nó específico do heap
   min_heap_remove(heap, 10, NULL);
@@ -68,7 +87,7 @@ START_TEST(test_remove_node)
 
   // Extrai o elemento mínimo do heap
   heap_node_t min_node = min_heap_pop(heap);
-  ck_assert_int_eq(min_node.cost, 3);
+  ck_assert_int_eq(min_heap_cost(min_node.key), 3);
 
   min_heap_destroy(heap);
 }
@@ -77,19 +96,19 @@ END_TEST
 // Teste para atualizar o custo de um nó no heap
 START_TEST(test_update_cost)
 {
-  min_heap_t* heap = min_heap_create();
+  min_heap_t* heap = min_heap_create(MIN_HEAP_BINARY, MIN_HEAP_TIE_NONE, MIN_HEAP_NO_INDEX);
 
   // Insere elementos no heap
-  min_heap_insert(heap, 5, NULL);
-  min_heap_insert(heap, 10, NULL);
-  min_heap_insert(heap, 3, NULL);
+  min_heap_insert(heap, 5, 0, NULL);
+  min_heap_insert(heap, 10, 0, NULL);
+  min_heap_insert(heap, 3, 0, NULL);
 
   // Atualiza o custo de um nó no heap
   min_heap_update(heap, 10, 2, NULL);
 
   // Extrai o elemento mínimo do heap após a atualização
   heap_node_t min_node = min_heap_pop(heap);
-  ck_assert_int_eq(min_node.cost, 2);
+  ck_assert_int_eq(min_heap_cost(min_node.key), 2);
 
   min_heap_destroy(heap);
 }
@@ -98,12 +117,12 @@ END_TEST
 // Teste para limpar o min_heap
 START_TEST(test_clean)
 {
-  min_heap_t* heap = min_heap_create();
+  min_heap_t* heap = min_heap_create(MIN_HEAP_BINARY, MIN_HEAP_TIE_NONE, MIN_HEAP_NO_INDEX);
 
   // Insere elementos no heap
-  min_heap_insert(heap, 5, NULL);
-  min_heap_insert(heap, 10, NULL);
-  min_heap_insert(heap, 3, NULL);
+  min_heap_insert(heap, 5, 0, NULL);
+  min_heap_insert(heap, 10, 0, NULL);
+  min_heap_insert(heap, 3, 0, NULL);
 
   ck_assert_int_eq(heap->size, 3);
 
@@ -115,6 +134,280 @@ START_TEST(test_clean)
 }
 END_TEST
 
+// Verifica que o heap indexado mantém os handles atualizados para um tipo de heap
+static void check_indexed(enum min_heap_type_e heap_type)
+{
+  min_heap_t* heap = min_heap_create(heap_type, MIN_HEAP_TIE_NONE, offsetof(indexed_item_t, index));
+  indexed_item_t items[64];
+
+  // Insere elementos com custos fora de ordem
+  for(int i = 0; i < 64; i++)
+  {
+    items[i].cost = (i * 37) % 64;
+    size_t index = min_heap_insert(heap, items[i].cost, 0, &items[i]);
+    ck_assert_uint_eq(index, items[i].index);
+    assert_indexes(heap);
+  }
+
+  // Diminui o custo de um elemento através do handle, deve passar a ser o mínimo
+  items[10].cost = -1;
+  min_heap_update_cost(heap, items[10].index, items[10].cost, 0);
+  assert_indexes(heap);
+
+  // Aumenta o custo de outro elemento através do handle
+  items[20].cost = 100;
+  min_heap_update_cost(heap, items[20].index, items[20].cost, 0);
+  assert_indexes(heap);
+
+  // Remove um elemento através do handle
+  min_heap_remove_at(heap, items[30].index);
+  ck_assert_uint_eq(items[30].index, SIZE_MAX);
+  ck_assert_int_eq(heap->size, 63);
+  assert_indexes(heap);
+
+  // Os elementos têm de sair por ordem e com o handle limpo
+  heap_node_t min_node = min_heap_pop(heap);
+  ck_assert_ptr_eq(min_node.data, &items[10]);
+  ck_assert_uint_eq(items[10].index, SIZE_MAX);
+
+  int last_cost = min_heap_cost(min_node.key);
+  while(heap->size)
+  {
+    min_node = min_heap_pop(heap);
+    ck_assert_int_le(last_cost, min_heap_cost(min_node.key));
+    ck_assert_uint_eq(((indexed_item_t*)min_node.data)->index, SIZE_MAX);
+    last_cost = min_heap_cost(min_node.key);
+    assert_indexes(heap);
+  }
+  ck_assert_int_eq(last_cost, 100);
+
+  min_heap_destroy(heap);
+}
+
+// Teste para verificar os handles com os vários tipos de heap
+START_TEST(test_indexed)
+{
+  check_indexed(MIN_HEAP_BINARY);
+  check_indexed(MIN_HEAP_4ARY);
+  check_indexed(MIN_HEAP_8ARY);
+}
+END_TEST
+
+// Verifica as posições num array externo, os dados dos elementos são índices
+static void check_positions(enum min_heap_type_e heap_type)
+{
+  min_heap_t* heap = min_heap_create(heap_type, MIN_HEAP_TIE_NONE, MIN_HEAP_NO_INDEX);
+  uint32_t* positions = malloc(65 * sizeof(uint32_t));
+  min_heap_set_positions(heap, &positions);
+
+  for(uintptr_t i = 1; i <= 64; i++)
+  {
+    size_t index = min_heap_insert(heap, (int)((i * 37) % 64), 0, (void*)i);
+    ck_assert_uint_eq(index, positions[i]);
+  }
+  for(size_t i = 0; heap_type != MIN_HEAP_BUCKET && i < heap->size; i++)
+  {
+    ck_assert_uint_eq(positions[(uintptr_t)heap->data[i].data], i);
+  }
+
+  // O array pode ser realocado entre operações
+  positions = realloc(positions, 1024 * sizeof(uint32_t));
+
+  // Diminui o custo de um elemento através da posição, deve passar a ser o mínimo
+  min_heap_update_cost(heap, positions[10], -1, 0);
+  min_heap_remove_at(heap, positions[30]);
+  ck_assert_uint_eq(positions[30], UINT32_MAX);
+
+  heap_node_t min_node = min_heap_pop(heap);
+  ck_assert_ptr_eq(min_node.data, (void*)(uintptr_t)10);
+  ck_assert_uint_eq(positions[10], UINT32_MAX);
+
+  int last_cost = min_heap_cost(min_node.key);
+  while(heap->size)
+  {
+    min_node = min_heap_pop(heap);
+    ck_assert_int_le(last_cost, min_heap_cost(min_node.key));
+    ck_assert_uint_eq(positions[(uintptr_t)min_node.data], UINT32_MAX);
+    last_cost = min_heap_cost(min_node.key);
+  }
+
+  min_heap_destroy(heap);
+  free(positions);
+}
+
+// Teste para verificar as posições externas com os vários tipos de heap
+START_TEST(test_positions)
+{
+  check_positions(MIN_HEAP_BINARY);
+  check_positions(MIN_HEAP_4ARY);
+  check_positions(MIN_HEAP_8ARY);
+  check_positions(MIN_HEAP_BUCKET);
+}
+END_TEST
+
+// Teste da bucket queue: ordem por custo, heurística e inserção, handles e custos fora da ordem
+START_TEST(test_bucket)
+{
+  min_heap_t* heap = min_heap_create(MIN_HEAP_BUCKET, MIN_HEAP_TIE_LOW_H, offsetof(indexed_item_t, index));
+  indexed_item_t items[8];
+
+  // Custos e heurísticas: o menor custo sai primeiro, depois a menor heurística e por fim o mais antigo
+  int costs[8] = { 7, 5, 5, 9, 5, 6, 12, 7 };
+  int hs[8] = { 1, 3, 2, 0, 2, 4, 0, 1 };
+  for(int i = 0; i < 8; i++)
+  {
+    items[i].cost = costs[i];
+    size_t index = min_heap_insert(heap, costs[i], hs[i], &items[i]);
+    ck_assert_uint_eq(index, items[i].index);
+  }
+  ck_assert_int_eq(heap->size, 8);
+
+  // Remove através do handle e diminui o custo abaixo do menor custo inserido (a base cresce para trás)
+  min_heap_remove_at(heap, items[5].index);
+  ck_assert_uint_eq(items[5].index, SIZE_MAX);
+  min_heap_update_cost(heap, items[6].index, -3, 0);
+
+  indexed_item_t* expected[6] = { &items[6], &items[2], &items[4], &items[1], &items[0], &items[7] };
+  int expected_costs[6] = { -3, 5, 5, 5, 7, 7 };
+  for(int i = 0; i < 4; i++)
+  {
+    heap_node_t min_node = min_heap_pop(heap);
+    ck_assert_ptr_eq(min_node.data, expected[i]);
+    ck_assert_int_eq(min_heap_cost(min_node.key), expected_costs[i]);
+    ck_assert_uint_eq(expected[i]->index, SIZE_MAX);
+  }
+
+  // Um custo inferior ao último extraído (heurística inconsistente) tem de voltar a ser o mínimo
+  min_heap_insert(heap, 4, 9, &items[5]);
+  heap_node_t min_node = min_heap_pop(heap);
+  ck_assert_ptr_eq(min_node.data, &items[5]);
+
+  // Atualização sem handle, mantém a heurística
+  min_heap_update(heap, 9, 6, &items[3]);
+  min_node = min_heap_pop(heap);
+  ck_assert_ptr_eq(min_node.data, &items[3]);
+  ck_assert_int_eq(min_heap_cost(min_node.key), 6);
+
+  for(int i = 4; i < 6; i++)
+  {
+    min_node = min_heap_pop(heap);
+    ck_assert_ptr_eq(min_node.data, expected[i]);
+    ck_assert_int_eq(min_heap_cost(min_node.key), expected_costs[i]);
+  }
+  ck_assert_int_eq(heap->size, 0);
+
+  // A limpeza tem de limpar os handles
+  min_heap_insert(heap, 100, 1, &items[0]);
+  min_heap_insert(heap, 1, 100, &items[1]);
+  min_heap_clean(heap);
+  ck_assert_int_eq(heap->size, 0);
+  ck_assert_uint_eq(items[0].index, SIZE_MAX);
+  ck_assert_uint_eq(items[1].index, SIZE_MAX);
+
+  min_heap_destroy(heap);
+}
+END_TEST
+
+// Compara a bucket queue com o heap binário numa sequência pseudo-aleatória de operações
+START_TEST(test_bucket_against_heap)
+{
+  min_heap_t* heap = min_heap_create(MIN_HEAP_BINARY, MIN_HEAP_TIE_NONE, offsetof(indexed_item_t, index));
+  min_heap_t* buckets = min_heap_create(MIN_HEAP_BUCKET, MIN_HEAP_TIE_NONE, offsetof(indexed_item_t, index));
+  indexed_item_t heap_items[1024];
+  indexed_item_t bucket_items[1024];
+  unsigned seed = 7;
+  size_t next = 0;
+
+  for(int step = 0; step < 4096; step++)
+  {
+    unsigned op = rand_r(&seed) % 4;
+    if(op < 2 && next < 1024)
+    {
+      int cost = (int)(rand_r(&seed) % 200) - 50;
+      int h = (int)(rand_r(&seed) % 30);
+      heap_items[next].cost = bucket_items[next].cost = cost;
+      min_heap_insert(heap, cost, h, &heap_items[next]);
+      min_heap_insert(buckets, cost, h, &bucket_items[next]);
+      next++;
+    }
+    else if(op == 2 && next > 0)
+    {
+      // Altera o custo de um elemento que ainda esteja em ambas as filas (com custos iguais a ordem pode diferir)
+      size_t i = rand_r(&seed) % next;
+      if(heap_items[i].index != SIZE_MAX && bucket_items[i].index != SIZE_MAX)
+      {
+        int cost = (int)(rand_r(&seed) % 200) - 50;
+        min_heap_update_cost(heap, heap_items[i].index, cost, 0);
+        min_heap_update_cost(buckets, bucket_items[i].index, cost, 0);
+      }
+    }
+    else if(heap->size)
+    {
+      // O custo do mínimo é conhecido antes de o remover
+      ck_assert_int_eq(min_heap_top_cost(heap), min_heap_top_cost(buckets));
+      heap_node_t heap_node = min_heap_pop(heap);
+      heap_node_t bucket_node = min_heap_pop(buckets);
+      ck_assert_int_eq(min_heap_cost(heap_node.key), min_heap_cost(bucket_node.key));
+    }
+    ck_assert_int_eq(heap->size, buckets->size);
+  }
+
+  while(heap->size)
+  {
+    ck_assert_int_eq(min_heap_cost(min_heap_pop(heap).key), min_heap_cost(min_heap_pop(buckets).key));
+  }
+  ck_assert_int_eq(buckets->size, 0);
+  ck_assert_int_eq(min_heap_top_cost(buckets), INT_MAX);
+
+  min_heap_destroy(heap);
+  min_heap_destroy(buckets);
+}
+END_TEST
+
+// Verifica a ordem de saída de elementos com o mesmo custo para um tipo de heap e política de desempate
+static void check_tie(enum min_heap_type_e heap_type, enum min_heap_tie_e tie, const int expected[4])
+{
+  min_heap_t* heap = min_heap_create(heap_type, tie, offsetof(indexed_item_t, index));
+  indexed_item_t items[4];
+  int costs[4] = { 10, 10, 10, 5 };
+  int hs[4] = { 3, 1, 2, 9 };
+
+  for(int i = 0; i < 4; i++)
+  {
+    items[i].cost = costs[i];
+    min_heap_insert(heap, costs[i], hs[i], &items[i]);
+  }
+
+  for(int i = 0; i < 4; i++)
+  {
+    heap_node_t min_node = min_heap_pop(heap);
+    ck_assert_ptr_eq(min_node.data, &items[expected[i]]);
+  }
+
+  min_heap_destroy(heap);
+}
+
+// Teste das políticas de desempate em todos os tipos de heap
+START_TEST(test_tie_policies)
+{
+  enum min_heap_type_e types[4] = { MIN_HEAP_BINARY, MIN_HEAP_4ARY, MIN_HEAP_8ARY, MIN_HEAP_BUCKET };
+  const int by_h[4] = { 3, 1, 2, 0 };
+  const int lifo[4] = { 3, 2, 1, 0 };
+  const int fifo[4] = { 3, 0, 1, 2 };
+
+  for(int i = 0; i < 4; i++)
+  {
+    // Com o mesmo custo, maior g é o mesmo que menor h
+    check_tie(types[i], MIN_HEAP_TIE_LOW_H, by_h);
+    check_tie(types[i], MIN_HEAP_TIE_HIGH_G, by_h);
+    check_tie(types[i], MIN_HEAP_TIE_LIFO, lifo);
+  }
+
+  // Sem critério a bucket queue mantém a ordem de inserção
+  check_tie(MIN_HEAP_BUCKET, MIN_HEAP_TIE_NONE, fifo);
+}
+END_TEST
+
 // Criação do conjunto de testes
 Suite* min_heap_suite(void)
 {
@@ -137,6 +430,20 @@ Suite* min_heap_suite(void)
   tcase_add_test(tc_update_node, test_update_cost);
   suite_add_tcase(suite, tc_update_node);
 
+  TCase* tc_indexed = tcase_create("indexed");
+  tcase_add_test(tc_indexed, test_indexed);
+  tcase_add_test(tc_indexed, test_positions);
+  suite_add_tcase(suite, tc_indexed);
+
+  TCase* tc_bucket = tcase_create("bucket");
+  tcase_add_test(tc_bucket, test_bucket);
+  tcase_add_test(tc_bucket, test_bucket_against_heap);
+  suite_add_tcase(suite, tc_bucket);
+
+  TCase* tc_tie = tcase_create("tie_policies");
+  tcase_add_test(tc_tie, test_tie_policies);
+  suite_add_tcase(suite, tc_tie);
+
   TCase* tc_clean_heap = tcase_create("clean_heap");
   tcase_add_test(tc_clean_heap, test_clean);
   suite_add_tcase(suite, tc_clean_heap);
@@ -0,0 +1,167 @@
+#include "multi_queue.h"
+#include <check.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define NUM_THREADS 4
+#define ELEMENTS_PER_THREAD 10000
+
+// Teste de inserção e extração por uma thread: todos os elementos saem uma vez
+START_TEST(test_multi_queue_push_pop)
+{
+  multi_queue_t* queue = multi_queue_create(4, MIN_HEAP_4ARY, MIN_HEAP_TIE_NONE);
+  ck_assert_ptr_nonnull(queue);
+  uint64_t seed = 1;
+
+  int values[100];
+  for(int i = 0; i < 100; i++)
+  {
+    values[i] = i;
+    multi_queue_push(queue, 100 - i, 0, &values[i], &seed);
+  }
+
+  bool seen[100] = { false };
+  heap_node_t element;
+  for(int i = 0; i < 100; i++)
+  {
+    ck_assert(multi_queue_pop(queue, &element, &seed));
+    int value = *(int*)element.data;
+    ck_assert(!seen[value]);
+    ck_assert_int_eq(min_heap_cost(element.key), 100 - value);
+    seen[value] = true;
+  }
+  ck_assert(!multi_queue_pop(queue, &element, &seed));
+
+  // Com um único heap a ordem é a do min-heap
+  multi_queue_t* single = multi_queue_create(1, MIN_HEAP_BINARY, MIN_HEAP_TIE_NONE);
+  ck_assert(multi_queue_push(single, 3, 0, &values[3], &seed));
+  ck_assert(multi_queue_push(single, 1, 0, &values[1], &seed));
+  ck_assert(multi_queue_push(single, 2, 0, &values[2], &seed));
+  for(int i = 1; i <= 3; i++)
+  {
+    ck_assert(multi_queue_pop(single, &element, &seed));
+    ck_assert_int_eq(*(int*)element.data, i);
+  }
+
+  multi_queue_destroy(single);
+  multi_queue_destroy(queue);
+}
+END_TEST
+
+// Teste da limpeza: os heaps ficam vazios e podem voltar a ser utilizados
+START_TEST(test_multi_queue_clean)
+{
+  multi_queue_t* queue = multi_queue_create(3, MIN_HEAP_BUCKET, MIN_HEAP_TIE_HIGH_G);
+  uint64_t seed = 7;
+  int value = 5;
+
+  for(int i = 0; i < 10; i++)
+  {
+    multi_queue_push(queue, i, 0, &value, &seed);
+  }
+  multi_queue_clean(queue);
+
+  heap_node_t element;
+  ck_assert(!multi_queue_pop(queue, &element, &seed));
+  for(size_t i = 0; i < queue->num_heaps; i++)
+  {
+    ck_assert_int_eq(atomic_load(&queue->heaps[i].top_cost), INT_MAX);
+  }
+
+  multi_queue_push(queue, 4, 0, &value, &seed);
+  ck_assert(multi_queue_pop(queue, &element, &seed));
+  ck_assert_int_eq(min_heap_cost(element.key), 4);
+
+  multi_queue_destroy(queue);
+}
+END_TEST
+
+// Argumentos de uma thread do teste concorrente
+typedef struct
+{
+  multi_queue_t* queue;
+  int thread_id;
+  int popped; // Elementos extraídos pela thread
+  long long sum; // Soma dos valores extraídos
+} worker_args_t;
+
+// Cada thread insere os seus elementos e extrai elementos até não encontrar mais
+static void* push_pop(void* arg)
+{
+  worker_args_t* args = (worker_args_t*)arg;
+  uint64_t seed = (uint64_t)args->thread_id + 1;
+  for(int i = 0; i < ELEMENTS_PER_THREAD; i++)
+  {
+    intptr_t value = (intptr_t)args->thread_id * ELEMENTS_PER_THREAD + i + 1;
+    multi_queue_push(args->queue, i, 0, (void*)value, &seed);
+  }
+
+  heap_node_t element;
+  while(multi_queue_pop(args->queue, &element, &seed))
+  {
+    args->popped++;
+    args->sum += (intptr_t)element.data;
+  }
+  return NULL;
+}
+
+// Teste concorrente: todos os elementos inseridos por várias threads são extraídos exatamente uma vez
+START_TEST(test_multi_queue_threads)
+{
+  multi_queue_t* queue = multi_queue_create(2 * NUM_THREADS, MIN_HEAP_4ARY, MIN_HEAP_TIE_NONE);
+  pthread_t threads[NUM_THREADS];
+  worker_args_t args[NUM_THREADS];
+
+  for(int i = 0; i < NUM_THREADS; i++)
+  {
+    args[i] = (worker_args_t){ queue, i, 0, 0 };
+    pthread_create(&threads[i], NULL, push_pop, &args[i]);
+  }
+
+  int popped = 0;
+  long long sum = 0;
+  for(int i = 0; i < NUM_THREADS; i++)
+  {
+    pthread_join(threads[i], NULL);
+    popped += args[i].popped;
+    sum += args[i].sum;
+  }
+
+  // Uma thread pode terminar antes de outra inserir os seus elementos, extraímos os que sobraram
+  uint64_t seed = 99;
+  heap_node_t element;
+  while(multi_queue_pop(queue, &element, &seed))
+  {
+    popped++;
+    sum += (intptr_t)element.data;
+  }
+
+  long long total = (long long)NUM_THREADS * ELEMENTS_PER_THREAD;
+  ck_assert_int_eq(popped, total);
+  ck_assert(sum == total * (total + 1) / 2);
+
+  multi_queue_destroy(queue);
+}
+END_TEST
+
+// Função principal de teste
+int main(void)
+{
+  Suite* suite = suite_create("MultiQueue");
+  TCase* testcase = tcase_create("Core");
+
+  tcase_add_test(testcase, test_multi_queue_push_pop);
+  tcase_add_test(testcase, test_multi_queue_clean);
+  tcase_add_test(testcase, test_multi_queue_threads);
+
+  suite_add_tcase(suite, testcase);
+
+  SRunner* runner = srunner_create(suite);
+  srunner_run_all(runner, CK_NORMAL);
+  int num_failed = srunner_ntests_failed(runner);
+  srunner_free(runner);
+
+  return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
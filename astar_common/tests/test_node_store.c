@@ -0,0 +1,74 @@
+#include "node_store.h"
+#include <check.h>
+#include <stdlib.h>
+
+#define NUM_STATES 10000
+
+// Cada estado tem um identificador próprio, que dá acesso ao estado, e os arrays crescem com os estados
+START_TEST(test_node_store)
+{
+  state_allocator_t* allocator = state_allocator_create(sizeof(int), 0);
+  node_store_t* store = node_store_create(allocator->allocator);
+  ck_assert_msg(store != NULL, "Falha na criação dos nós compactos");
+
+  state_t** states = malloc(NUM_STATES * sizeof(state_t*));
+  node_id_t* ids = malloc(NUM_STATES * sizeof(node_id_t));
+  for(int i = 0; i < NUM_STATES; i++)
+  {
+    states[i] = state_allocator_new(allocator, &i);
+    ids[i] = node_store_id(store, states[i]);
+    ck_assert_uint_ne(ids[i], NODE_NONE);
+    ck_assert(!node_store_exists(store, ids[i]));
+
+    store->g[ids[i]] = i;
+    store->parent[ids[i]] = i > 0 ? ids[i - 1] : NODE_NONE;
+  }
+  ck_assert_uint_ge(store->capacity, NUM_STATES);
+
+  for(int i = 0; i < NUM_STATES; i++)
+  {
+    ck_assert_uint_eq(node_store_id(store, states[i]), ids[i]);
+    ck_assert_ptr_eq(node_store_state(store, ids[i]), states[i]);
+    ck_assert(node_store_exists(store, ids[i]));
+    ck_assert_int_eq(store->g[ids[i]], i);
+  }
+
+  // Um estado de outro gestor não tem identificador
+  int other = 0;
+  state_allocator_t* other_allocator = state_allocator_create(sizeof(int), 0);
+  ck_assert_uint_eq(node_store_id(store, state_allocator_new(other_allocator, &other)), NODE_NONE);
+  state_allocator_destroy(other_allocator);
+
+  // Depois do reset os estados voltam a não ter nó
+  state_allocator_reset(allocator);
+  node_store_reset(store);
+  state_t* state = state_allocator_new(allocator, &other);
+  ck_assert_uint_eq(node_store_id(store, state), ids[0]);
+  ck_assert(!node_store_exists(store, ids[0]));
+  ck_assert(!node_store_exists(store, ids[NUM_STATES - 1]));
+
+  free(ids);
+  free(states);
+  node_store_destroy(store);
+  state_allocator_destroy(allocator);
+}
+END_TEST
+
+Suite* node_store_suite()
+{
+  Suite* suite = suite_create("node_store_t");
+  TCase* tc_core = tcase_create("Core");
+  tcase_add_test(tc_core, test_node_store);
+  suite_add_tcase(suite, tc_core);
+  return suite;
+}
+
+int main()
+{
+  Suite* suite = node_store_suite();
+  SRunner* runner = srunner_create(suite);
+  srunner_run_all(runner, CK_NORMAL);
+  int failures = srunner_ntests_failed(runner);
+  srunner_free(runner);
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
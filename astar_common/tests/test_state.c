@@ -10,7 +10,7 @@ typedef struct
 
 START_TEST(test_state_allocator)
 {
-  state_allocator_t* allocator = state_allocator_create(sizeof(my_struct_t));
+  state_allocator_t* allocator = state_allocator_create(sizeof(my_struct_t), 0);
 
   my_struct_t state_data_1 = {2,2};
   my_struct_t state_data_2 = {3,3};
@@ -60,12 +60,52 @@ START_TEST(test_state_allocator)
 }
 END_TEST
 
+// Depois de reiniciar o gestor os estados anteriores deixam de existir e a memória é reutilizada, a zona
+// reservada de cada estado volta a estar a zeros
+START_TEST(test_state_allocator_reset)
+{
+  state_allocator_t* allocator = state_allocator_create(sizeof(my_struct_t), sizeof(size_t));
+  const int count = 10000;
+  state_t* first = NULL;
+
+  for(int round = 0; round < 3; round++)
+  {
+    // Os mesmos dados em todas as rondas, se um estado anterior existisse a zona reservada não estaria a zeros
+    for(int i = 0; i < count; i++)
+    {
+      my_struct_t data = { i, i };
+      state_t* state = state_allocator_new(allocator, &data);
+      ck_assert_int_eq(*(size_t*)state_node(state), 0);
+      *(size_t*)state_node(state) = 1;
+
+      // O primeiro estado reutiliza sempre a mesma memória
+      if(i == 0)
+      {
+        ck_assert(first == NULL || first == state);
+        first = state;
+      }
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+      my_struct_t data = { i, i };
+      ck_assert_int_eq(*(size_t*)state_node(state_allocator_new(allocator, &data)), 1);
+    }
+
+    state_allocator_reset(allocator);
+  }
+
+  state_allocator_destroy(allocator);
+}
+END_TEST
+
 Suite* allocator_suite()
 {
   Suite* suite = suite_create("state_allocator_t");
   TCase* test_case = tcase_create("state allocation");
 
   tcase_add_test(test_case, test_state_allocator);
+  tcase_add_test(test_case, test_state_allocator_reset);
 
   suite_add_tcase(suite, test_case);
 
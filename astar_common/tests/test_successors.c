@@ -0,0 +1,113 @@
+#include "successors.h"
+#include <check.h>
+#include <stdlib.h>
+
+// O buffer mantém a ordem dos sucessores, cresce quando necessário e é reutilizado depois de limpo
+START_TEST(test_successors)
+{
+  successors_t* successors = successors_create(2);
+  ck_assert_msg(successors != NULL, "Falha na criação do buffer");
+  ck_assert_int_eq(successors->size, 0);
+  ck_assert_int_eq(successors->capacity, 2);
+
+  state_t states[5];
+  for(int i = 0; i < 5; i++)
+  {
+    ck_assert(successors_add(successors, &states[i]));
+  }
+
+  ck_assert_int_eq(successors->size, 5);
+  ck_assert_int_ge(successors->capacity, 5);
+  for(int i = 0; i < 5; i++)
+  {
+    ck_assert_ptr_eq(successors->items[i].state, &states[i]);
+    ck_assert_int_eq(successors->items[i].cost, SUCCESSOR_UNKNOWN);
+    ck_assert_int_eq(successors->items[i].h_delta, SUCCESSOR_UNKNOWN);
+  }
+
+  // Depois de limpo a memória é reutilizada
+  successor_t* buffer = successors->items;
+  size_t capacity = successors->capacity;
+  successors_clear(successors);
+  ck_assert_int_eq(successors->size, 0);
+
+  ck_assert(successors_add_with_costs(successors, &states[4], 3, -1));
+  ck_assert_int_eq(successors->size, 1);
+  ck_assert_ptr_eq(successors->items[0].state, &states[4]);
+  ck_assert_int_eq(successors->items[0].cost, 3);
+  ck_assert_int_eq(successors->items[0].h_delta, -1);
+  ck_assert_ptr_eq(successors->items, buffer);
+  ck_assert_int_eq(successors->capacity, capacity);
+
+  // Um estado que não foi possível alocar é um erro, o sucessor não é acrescentado
+  ck_assert(!successors_add(successors, NULL));
+  ck_assert_int_eq(successors->size, 1);
+
+  successors_destroy(successors);
+
+  // Capacidade predefinida
+  successors = successors_create(0);
+  ck_assert_int_eq(successors->capacity, SUCCESSORS_DEFAULT_CAPACITY);
+  successors_destroy(successors);
+}
+END_TEST
+
+// Com staging os sucessores ficam pendentes até serem obtidos em conjunto, sem staging são obtidos logo
+START_TEST(test_successors_staging)
+{
+  state_allocator_t* allocator = state_allocator_create(sizeof(int), 0);
+  successors_t* successors = successors_create(2);
+  int values[5] = { 1, 2, 1, 3, 2 };
+
+  ck_assert(successors_add_data(successors, allocator, &values[0], 1, SUCCESSOR_UNKNOWN));
+  ck_assert_ptr_nonnull(successors->items[0].state);
+
+  successors->staging = true;
+  for(int i = 1; i < 5; i++)
+  {
+    ck_assert(successors_add_data(successors, allocator, &values[i], i, SUCCESSOR_UNKNOWN));
+    ck_assert_ptr_null(successors->items[i].state);
+  }
+  ck_assert_int_eq(successors->num_pending, 4);
+
+  // Alteramos os dados originais, os sucessores pendentes têm a sua cópia
+  values[3] = 4;
+  ck_assert(successors_resolve(successors, allocator));
+  ck_assert_int_eq(successors->num_pending, 0);
+
+  int expected[5] = { 1, 2, 1, 3, 2 };
+  for(int i = 0; i < 5; i++)
+  {
+    ck_assert_int_eq(*(int*)successors->items[i].state->data, expected[i]);
+    ck_assert_int_eq(successors->items[i].cost, i == 0 ? 1 : i);
+  }
+
+  // Os dados iguais resultam no mesmo estado
+  ck_assert_ptr_eq(successors->items[0].state, successors->items[2].state);
+  ck_assert_ptr_eq(successors->items[1].state, successors->items[4].state);
+  ck_assert_ptr_eq(successors->items[3].state, state_allocator_new(allocator, &expected[3]));
+
+  successors_destroy(successors);
+  state_allocator_destroy(allocator);
+}
+END_TEST
+
+Suite* successors_suite()
+{
+  Suite* suite = suite_create("successors_t");
+  TCase* tc_core = tcase_create("Core");
+  tcase_add_test(tc_core, test_successors);
+  tcase_add_test(tc_core, test_successors_staging);
+  suite_add_tcase(suite, tc_core);
+  return suite;
+}
+
+int main()
+{
+  Suite* suite = successors_suite();
+  SRunner* runner = srunner_create(suite);
+  srunner_run_all(runner, CK_NORMAL);
+  int failures = srunner_ntests_failed(runner);
+  srunner_free(runner);
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
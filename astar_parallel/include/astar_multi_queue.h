@@ -0,0 +1,104 @@
+/*
+   Algoritmo A* Paralelo com fronteira partilhada (MultiQueue)
+
+   Alternativa ao algoritmo paralelo por mensagens (astar_parallel.h): os trabalhadores não são donos de estados,
+   todos partilham os nós abertos numa MultiQueue (ver multi_queue.h) com MULTI_QUEUE_HEAPS_PER_WORKER heaps por
+   trabalhador, e os estados já encontrados na hashtable dos estados. Cada trabalhador retira um nó próximo do
+   mínimo, expande-o e atualiza diretamente os nós dos sucessores, sem mensagens.
+
+   Os nós são protegidos por um conjunto de mutexes indexado pelo hash do estado (NODE_LOCKS mutexes). Quando um
+   nó melhora é inserida uma nova entrada nos nós abertos, as entradas cujo custo já não corresponde ao do nó
+   são ignoradas quando são extraídas. Como a fila é relaxada, um nó pode ser expandido antes de ter o menor
+   custo e voltar a ser aberto mais tarde, a procura continua até não existirem nós que levem a uma solução
+   melhor. Com poucos nós expandidos evita o custo das mensagens e das caixas de saída.
+*/
+#ifndef ASTAR_MULTI_QUEUE_H
+#define ASTAR_MULTI_QUEUE_H
+#include "astar.h"
+#include "multi_queue.h"
+#include "state.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Heaps da MultiQueue por trabalhador
+#define MULTI_QUEUE_HEAPS_PER_WORKER 2
+
+// Número de mutexes que protegem os nós (potência de 2)
+#define NODE_LOCKS 4096
+
+typedef struct a_star_multi_queue_t a_star_multi_queue_t;
+
+// Estrutura que guarda o estado de um trabalhador
+typedef struct
+{
+  a_star_multi_queue_t* a_star;
+  pthread_t thread;
+  int thread_id;
+  uint64_t seed; // Semente dos números aleatórios da MultiQueue
+
+  // Variáveis para estatísticas
+  int generated;
+  int expanded;
+  int nodes_new;
+  int nodes_reinserted;
+  int paths_worst_or_equals;
+  int paths_better;
+  size_t stale; // Entradas ignoradas porque o nó melhorou depois de serem inseridas
+  size_t max_pending; // Maior número de entradas por processar observado
+  size_t waits; // Vezes que o trabalhador ficou parado sem entradas
+} a_star_multi_queue_worker_t;
+
+// Estrutura que contem o estado do algoritmo A*
+struct a_star_multi_queue_t
+{
+  // Configuração comum do algoritmo
+  a_star_t* common;
+
+  // Nós abertos partilhados e mutexes dos nós
+  multi_queue_t* open_set;
+  pthread_mutex_t node_locks[NODE_LOCKS];
+
+  size_t num_workers;
+  a_star_multi_queue_worker_t* workers;
+  pthread_mutex_t lock; // Protege a solução
+  atomic_int solution_cost; // Custo da melhor solução, INT_MAX sem solução, lido sem o lock pela poda
+
+  bool stop_on_first_solution;
+  atomic_bool running;
+
+  // Entradas nos nós abertos mais nós a serem expandidos, a procura termina quando chega a 0
+  atomic_size_t pending;
+
+  // Trabalhadores sem entradas ficam parados até ser inserida uma entrada ou a procura terminar
+  pthread_mutex_t idle_lock;
+  pthread_cond_t idle_cond;
+  atomic_int idle; // Trabalhadores parados ou prestes a parar
+};
+
+// Cria uma nova instância do algoritmo A* para resolver um problema, options pode ser NULL
+a_star_multi_queue_t* a_star_multi_queue_create(size_t struct_size,
+                                                goal_function goal_func,
+                                                visit_function visit_func,
+                                                heuristic_function h_func,
+                                                distance_function d_func,
+                                                print_function print_func,
+                                                int num_workers,
+                                                bool stop_on_first_solution,
+                                                const a_star_options_t* options);
+
+// Liberta uma instância do algoritmo
+void a_star_multi_queue_destroy(a_star_multi_queue_t* a_star);
+
+// Prepara a instância para resolver outro problema, a memória já alocada é reutilizada
+void a_star_multi_queue_reset(a_star_multi_queue_t* a_star);
+
+// Resolve o problema
+void a_star_multi_queue_solve(a_star_multi_queue_t* a_star, void* initial, void* goal);
+
+// Imprime estatísticas sobre o algoritmo
+void a_star_multi_queue_print_statistics(a_star_multi_queue_t* a_star, bool csv, bool show_solution);
+
+#endif // ASTAR_MULTI_QUEUE_H
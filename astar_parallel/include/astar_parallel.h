@@ -8,13 +8,26 @@
 #include "min_heap.h"
 #include "state.h"
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct a_star_worker_t a_star_worker_t;
 typedef struct a_star_scheduler_t a_star_scheduler_t;
 typedef struct a_star_parallel_t a_star_parallel_t;
 
+// Tipo para funções que devolvem o hash utilizado para atribuir um estado a um trabalhador, depende apenas do estado
+// (por exemplo um hash de Zobrist abstrato, ver zobrist.h)
+typedef uint64_t (*owner_function)(const state_t*);
+
+// Estrutura que contem a mensagem a ser passada nas queues
+typedef struct
+{
+  a_star_node_t* parent;
+  successor_t successor; // Estado sucessor, com o custo do arco e a variação da heurística se conhecidos
+} a_star_message_t;
+
 struct a_star_scheduler_t
 {
   size_t num_workers;
@@ -33,10 +46,19 @@ struct a_star_parallel_t
   a_star_scheduler_t scheduler;
   channel_t* channel;
   pthread_mutex_t lock;
+  atomic_int solution_cost; // Custo da melhor solução, INT_MAX sem solução, lido sem o lock pela poda
+
+  // Hash que atribui os estados aos trabalhadores, NULL utiliza o hash do estado
+  owner_function owner_func;
 
   // Variáveis necessárias para controlar a execução do algoritmo em paralelo
   bool stop_on_first_solution;
-  bool running;
+  atomic_bool running;
+
+  // Deteção de terminação por contagem: mensagens enviadas e ainda não processadas mais os trabalhadores ativos.
+  // Um trabalhador ativo só gera trabalho enquanto está contado, assim o valor só chega a 0 quando não existem
+  // mensagens nem nós por explorar, e o trabalhador que o coloca a 0 termina a procura
+  atomic_size_t work;
 };
 
 // Estrutura que guarda o estado de um trabalhador
@@ -47,10 +69,20 @@ struct a_star_worker_t
   // Variáveis especificas para threading e controlo de execução
   pthread_t thread;
   int thread_id;
-  bool idle;
+  bool idle; // Sem nós nem mensagens, bloqueado à espera de mensagens
 
-  // Nós abertos locais
+  // Nós abertos locais, com o roubo de nós ativo são acedidos com open_set_lock (outros trabalhadores podem retirar
+  // nós). Os nós roubados são expandidos por quem os roubou mas nunca entram nos seus nós abertos, apenas o
+  // trabalhador responsável pelo estado atualiza o nó
   min_heap_t* open_set;
+  pthread_mutex_t open_set_lock;
+  a_star_node_t** stolen; // Nós roubados por expandir, steal_batch nós
+
+  // Mensagens por enviar, outbox_size para cada trabalhador de destino, enviadas num bloco quando a caixa enche,
+  // após outbox_expansions expansões e antes de o trabalhador ficar ocioso
+  a_star_message_t* outbox;
+  size_t* outbox_count; // Mensagens guardadas para cada trabalhador
+  size_t expansions_since_flush;
 
   // Variáveis para estatísticas
   int generated;
@@ -60,9 +92,14 @@ struct a_star_worker_t
   int nodes_reinserted;
   int paths_worst_or_equals;
   int paths_better;
+  size_t messages_sent;
+  size_t messages_remote; // Mensagens enviadas para outros trabalhadores
+  size_t batches_sent; // Blocos enviados, o tamanho médio de um bloco é messages_sent / batches_sent
+  size_t steals; // Roubos de nós a outros trabalhadores
+  size_t nodes_stolen; // Nós roubados a outros trabalhadores
 };
 
-// Cria uma nova instância do algoritmo A* para resolver um problema
+// Cria uma nova instância do algoritmo A* para resolver um problema, options pode ser NULL
 a_star_parallel_t* a_star_parallel_create(size_t struct_size,
                                           goal_function goal_func,
                                           visit_function visit_func,
@@ -70,11 +107,20 @@ a_star_parallel_t* a_star_parallel_create(size_t struct_size,
                                           distance_function d_func,
                                           print_function print_func,
                                           int num_workers,
-                                          bool stop_on_first_solution);
+                                          bool stop_on_first_solution,
+                                          const a_star_options_t* options);
+
+// Define a função que atribui os estados aos trabalhadores, NULL volta a utilizar o hash do estado. Com um hash que
+// depende de poucas características do estado, mais sucessores ficam no trabalhador que os gerou
+void a_star_parallel_set_owner(a_star_parallel_t* a_star, owner_function owner_func);
 
 // Liberta uma instância do algoritmo A* paralelo
 void a_star_parallel_destroy(a_star_parallel_t* a_star);
 
+// Prepara a instância para resolver outro problema, a memória já alocada é reutilizada
+// (os trabalhadores não podem estar a correr)
+void a_star_parallel_reset(a_star_parallel_t* a_star);
+
 // Resolve o problema através do uso do algoritmo A* paralelo
 void a_star_parallel_solve(a_star_parallel_t* a_star, void* initial, void* goal);
 
@@ -0,0 +1,137 @@
+/*
+   Algoritmo A* Paralelo Best-NBlock-First (PBNF)
+
+   Alternativa aos algoritmos paralelos por mensagens (astar_parallel.h) e por fronteira partilhada
+   (astar_multi_queue.h): o espaço de estados é dividido em nblocks por uma abstração fornecida pelo problema
+   (cada estado pertence a um nblock e o problema indica os nblocks sucessores de cada nblock). Cada nblock tem os
+   seus próprios nós abertos.
+
+   O âmbito de deteção de duplicados de um nblock é o próprio nblock e os seus sucessores: os sucessores dos
+   estados do nblock pertencem sempre a um destes nblocks. Um trabalhador adquire um nblock cujo âmbito não
+   interseta o âmbito de nenhum nblock em uso e expande os seus nós, atualizando os nós do âmbito sem mutexes
+   porque nenhum outro trabalhador lhes pode aceder. O grafo dos nblocks (nblocks em uso, interferências e lista de
+   nblocks livres) é protegido por um único mutex, utilizado apenas para adquirir e libertar nblocks.
+
+   Um trabalhador troca de nblock quando o seu fica vazio ou, depois de PBNF_MIN_EXPANSIONS expansões, quando
+   existe um nblock livre com nós de menor custo. A procura termina quando nenhum nblock está em uso e nenhum
+   nblock livre tem nós abertos.
+*/
+#ifndef ASTAR_PBNF_H
+#define ASTAR_PBNF_H
+#include "astar.h"
+#include "min_heap.h"
+#include "state.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Número máximo de nblocks sucessores de um nblock
+#define PBNF_MAX_NBLOCK_SUCCESSORS 8
+
+// Expansões mínimas num nblock antes de o trocar por um nblock livre com nós de menor custo
+#define PBNF_MIN_EXPANSIONS 32
+
+// Indica que um trabalhador não tem nblock ou que um nblock não está na lista de livres
+#define PBNF_NO_NBLOCK SIZE_MAX
+
+typedef struct a_star_pbnf_t a_star_pbnf_t;
+
+// Retorna o nblock de um estado (entre 0 e o número de nblocks - 1)
+typedef size_t (*nblock_function)(const state_t* state);
+
+// Preenche os nblocks sucessores de um nblock (no máximo PBNF_MAX_NBLOCK_SUCCESSORS) e retorna quantos são,
+// instance são os dados do problema indicados na abstração
+typedef size_t (*nblock_successors_function)(const void* instance, size_t nblock, size_t* successors);
+
+// Abstração do problema que divide os estados em nblocks
+typedef struct
+{
+  const void* instance; // Dados do problema passados à função dos sucessores
+  size_t num_nblocks;
+  nblock_function nblock_func;
+  nblock_successors_function successors_func;
+} a_star_abstraction_t;
+
+// Estrutura de um nblock
+typedef struct
+{
+  min_heap_t* open_set; // Nós abertos do nblock, criados quando o nblock recebe o primeiro nó
+  size_t interference_start; // Posição dos nblocks que interferem com este no array de interferências
+  size_t num_interference;
+  int sigma; // Número de nblocks em uso que interferem com este
+  bool in_use;
+  size_t free_index; // Posição na lista de nblocks livres ou PBNF_NO_NBLOCK
+} a_star_nblock_t;
+
+// Estrutura que guarda o estado de um trabalhador
+typedef struct
+{
+  a_star_pbnf_t* a_star;
+  pthread_t thread;
+  int thread_id;
+  size_t nblock; // nblock adquirido ou PBNF_NO_NBLOCK
+
+  // Variáveis para estatísticas
+  int generated;
+  int expanded;
+  size_t max_min_heap_size;
+  int nodes_new;
+  int nodes_reinserted;
+  int paths_worst_or_equals;
+  int paths_better;
+  size_t acquisitions; // nblocks adquiridos
+} a_star_pbnf_worker_t;
+
+// Estrutura que contem o estado do algoritmo A*
+struct a_star_pbnf_t
+{
+  // Configuração comum do algoritmo
+  a_star_t* common;
+
+  // Abstração e grafo dos nblocks
+  a_star_abstraction_t abstraction;
+  a_star_nblock_t* nblocks;
+  size_t* interference; // nblocks cujo âmbito de deteção de duplicados interseta o de cada nblock
+  size_t* free_nblocks; // nblocks livres: com nós abertos, fora de uso e sem interferências em uso
+  size_t num_free;
+  size_t num_in_use;
+  atomic_int best_free_cost; // Menor custo dos nblocks livres, INT_MAX se não existirem
+  pthread_mutex_t graph_lock; // Protege o grafo dos nblocks
+  pthread_cond_t graph_cond; // Sinaliza novos nblocks livres e o fim da procura
+
+  size_t num_workers;
+  a_star_pbnf_worker_t* workers;
+  pthread_mutex_t lock; // Protege a solução
+  atomic_int solution_cost; // Custo da melhor solução, INT_MAX sem solução, lido sem o lock pela poda
+
+  bool stop_on_first_solution;
+  atomic_bool running;
+};
+
+// Cria uma nova instância do algoritmo A* para resolver um problema com a abstração indicada, options pode ser
+// NULL
+a_star_pbnf_t* a_star_pbnf_create(size_t struct_size,
+                                  goal_function goal_func,
+                                  visit_function visit_func,
+                                  heuristic_function h_func,
+                                  distance_function d_func,
+                                  print_function print_func,
+                                  int num_workers,
+                                  bool stop_on_first_solution,
+                                  const a_star_abstraction_t* abstraction,
+                                  const a_star_options_t* options);
+
+// Liberta uma instância do algoritmo
+void a_star_pbnf_destroy(a_star_pbnf_t* a_star);
+
+// Prepara a instância para resolver outro problema, a memória já alocada é reutilizada
+void a_star_pbnf_reset(a_star_pbnf_t* a_star);
+
+// Resolve o problema
+void a_star_pbnf_solve(a_star_pbnf_t* a_star, void* initial, void* goal);
+
+// Imprime estatísticas sobre o algoritmo
+void a_star_pbnf_print_statistics(a_star_pbnf_t* a_star, bool csv, bool show_solution);
+
+#endif // ASTAR_PBNF_H
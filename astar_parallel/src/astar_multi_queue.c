@@ -0,0 +1,541 @@
+#include "astar_multi_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Mutex que protege o nó de um estado
+static inline pthread_mutex_t* node_lock(a_star_multi_queue_t* a_star, state_t* state)
+{
+  return &a_star->node_locks[state->hash & (NODE_LOCKS - 1)];
+}
+
+// Termina a procura e acorda os trabalhadores parados
+static void a_star_multi_queue_stop(a_star_multi_queue_t* a_star)
+{
+  pthread_mutex_lock(&a_star->idle_lock);
+  atomic_store(&a_star->running, false);
+  pthread_cond_broadcast(&a_star->idle_cond);
+  pthread_mutex_unlock(&a_star->idle_lock);
+}
+
+// Uma entrada foi processada (expandida ou ignorada), se era o último trabalho a procura terminou
+static void a_star_multi_queue_done(a_star_multi_queue_t* a_star)
+{
+  if(atomic_fetch_sub(&a_star->pending, 1) == 1)
+  {
+    a_star_multi_queue_stop(a_star);
+  }
+}
+
+// Insere uma entrada para o nó nos nós abertos, é contada antes de ser inserida
+static void a_star_multi_queue_push(a_star_multi_queue_worker_t* worker, a_star_node_t* node, int g, int h)
+{
+  a_star_multi_queue_t* a_star = worker->a_star;
+  atomic_fetch_add(&a_star->pending, 1);
+  if(!multi_queue_push(a_star->open_set, g + h, h, node, &worker->seed))
+  {
+    // A entrada não foi inserida e nunca seria retirada, sem memória a procura termina (a entrada que o
+    // trabalhador está a expandir continua contada, o valor não chega a 0)
+    atomic_fetch_sub(&a_star->pending, 1);
+    atomic_store(&a_star->common->allocation_error, true);
+    a_star_multi_queue_stop(a_star);
+    return;
+  }
+
+  // Um trabalhador que não encontrou entradas pode estar parado, acordamos um
+  atomic_thread_fence(memory_order_seq_cst);
+  if(atomic_load_explicit(&a_star->idle, memory_order_relaxed) > 0)
+  {
+    pthread_mutex_lock(&a_star->idle_lock);
+    pthread_cond_signal(&a_star->idle_cond);
+    pthread_mutex_unlock(&a_star->idle_lock);
+  }
+}
+
+// Extrai uma entrada dos nós abertos, sem entradas o trabalhador fica parado até ser inserida uma entrada ou a
+// procura terminar, retorna falso se não obteve uma entrada
+static bool a_star_multi_queue_pop(a_star_multi_queue_worker_t* worker, heap_node_t* element)
+{
+  a_star_multi_queue_t* a_star = worker->a_star;
+  if(multi_queue_pop(a_star->open_set, element, &worker->seed))
+  {
+    return true;
+  }
+
+  // Depois de nos declararmos parados voltamos a procurar, uma entrada inserida entretanto já nos acorda
+  pthread_mutex_lock(&a_star->idle_lock);
+  atomic_fetch_add(&a_star->idle, 1);
+  atomic_thread_fence(memory_order_seq_cst);
+  bool found = multi_queue_pop(a_star->open_set, element, &worker->seed);
+  if(!found && atomic_load(&a_star->running))
+  {
+    worker->waits++;
+    pthread_cond_wait(&a_star->idle_cond, &a_star->idle_lock);
+  }
+  atomic_fetch_sub(&a_star->idle, 1);
+  pthread_mutex_unlock(&a_star->idle_lock);
+  return found;
+}
+
+// Verifica se um nó já não pode levar a uma solução melhor do que a encontrada
+static bool a_star_multi_queue_prune(a_star_multi_queue_t* a_star, int g, int h)
+{
+  // A solução é protegida pelo lock, apenas o seu custo é publicado para os trabalhadores
+  int f_solution = atomic_load(&a_star->solution_cost);
+  return g + h > f_solution || g > f_solution;
+}
+
+// Regista um nó objetivo como solução, se for melhor do que a encontrada
+static void a_star_multi_queue_set_solution(a_star_multi_queue_worker_t* worker, a_star_node_t* node, int g)
+{
+  a_star_multi_queue_t* a_star = worker->a_star;
+
+  pthread_mutex_lock(&a_star->lock);
+  a_star->common->num_solutions++;
+  // O nó da solução pode continuar a ser atualizado por outros trabalhadores, comparamos com o custo publicado
+  int solution_cost = atomic_load(&a_star->solution_cost);
+  if(g < solution_cost)
+  {
+    a_star->common->num_better_solutions++;
+    a_star->common->solution = node;
+    atomic_store(&a_star->solution_cost, g);
+#ifdef STATS_GEN
+    a_star_node_t* solution_path = a_star->common->solution;
+    while(solution_path != NULL)
+    {
+      search_data_add_entry(worker->thread_id, solution_path->state, ACTION_GOAL);
+      solution_path = solution_path->parent;
+    }
+#endif
+  }
+  else if(g == solution_cost)
+  {
+    a_star->common->num_worst_solutions++;
+  }
+  pthread_mutex_unlock(&a_star->lock);
+
+  // Queremos apenas a primeira solução
+  if(a_star->stop_on_first_solution)
+  {
+    a_star_multi_queue_stop(a_star);
+  }
+}
+
+// Atualiza o nó de um sucessor com o caminho pelo nó pai, o nó é aberto se o caminho for melhor
+static void a_star_multi_queue_update(a_star_multi_queue_worker_t* worker,
+                                      a_star_node_t* parent_node,
+                                      int parent_g,
+                                      int parent_h,
+                                      successor_t* successor)
+{
+  a_star_multi_queue_t* a_star = worker->a_star;
+  state_t* state = successor->state;
+  int g = parent_g + a_star_successor_cost(a_star->common, parent_node->state, successor);
+
+  pthread_mutex_t* lock = node_lock(a_star, state);
+  pthread_mutex_lock(lock);
+
+  a_star_node_t* child_node = node_allocator_get(a_star->common->node_allocator, state);
+  if(child_node == NULL)
+  {
+    // Este nó ainda não existe, criamos um novo nó para este estado
+    child_node = node_allocator_new(a_star->common->node_allocator, state);
+    child_node->h = a_star_successor_h(a_star->common, parent_h, successor);
+    worker->generated++;
+    worker->nodes_new++;
+
+#ifdef STATS_GEN
+    search_data_add_entry(worker->thread_id, child_node->state, ACTION_SUCESSOR);
+#endif
+  }
+  else if(g >= child_node->g)
+  {
+    // Existe outro caminho igual ou mais curto para este estado
+    pthread_mutex_unlock(lock);
+    worker->paths_worst_or_equals++;
+    return;
+  }
+  else
+  {
+    worker->paths_better++;
+    worker->nodes_reinserted++;
+  }
+
+  child_node->g = g;
+  child_node->parent = parent_node;
+  int h = child_node->h;
+  pthread_mutex_unlock(lock);
+
+  // A entrada anterior do nó, se existir, passa a ser ignorada
+  a_star_multi_queue_push(worker, child_node, g, h);
+}
+
+// Função que implementa a lógica de um trabalhador
+static void* a_star_multi_queue_worker_function(void* arg)
+{
+  a_star_multi_queue_worker_t* worker = (a_star_multi_queue_worker_t*)arg;
+  a_star_multi_queue_t* a_star = worker->a_star;
+
+  // Reinicia as estatísticas para este trabalhador
+  worker->generated = 0;
+  worker->expanded = 0;
+  worker->nodes_new = 0;
+  worker->nodes_reinserted = 0;
+  worker->paths_better = 0;
+  worker->paths_worst_or_equals = 0;
+  worker->stale = 0;
+  worker->max_pending = 0;
+  worker->waits = 0;
+
+  // Este buffer recebe os vizinhos de um nó, é reutilizado em todas as expansões
+  successors_t* neighbors = successors_create(0);
+  if(neighbors == NULL)
+  {
+    pthread_exit(NULL);
+  }
+
+  while(atomic_load(&a_star->running))
+  {
+    heap_node_t element;
+    if(!a_star_multi_queue_pop(worker, &element))
+    {
+      // Os outros trabalhadores ainda podem abrir nós enquanto expandem
+      continue;
+    }
+
+    size_t pending = atomic_load_explicit(&a_star->pending, memory_order_relaxed);
+    if(pending > worker->max_pending)
+    {
+      worker->max_pending = pending;
+    }
+
+    // Lemos o nó com o seu mutex, a entrada está desatualizada se o nó melhorou depois de ser inserida
+    a_star_node_t* current_node = (a_star_node_t*)element.data;
+    pthread_mutex_t* lock = node_lock(a_star, current_node->state);
+    pthread_mutex_lock(lock);
+    int g = current_node->g;
+    int h = current_node->h;
+    pthread_mutex_unlock(lock);
+
+    if(min_heap_cost(element.key) != g + h)
+    {
+      worker->stale++;
+      a_star_multi_queue_done(a_star);
+      continue;
+    }
+
+    worker->expanded++;
+#ifdef STATS_GEN
+    search_data_add_entry(worker->thread_id, current_node->state, ACTION_VISITED);
+#endif
+
+    if(a_star_multi_queue_prune(a_star, g, h))
+    {
+      // Este nó não leva a uma solução melhor do que a encontrada
+    }
+    else if(a_star->common->goal_func(current_node->state, a_star->common->goal_state))
+    {
+      a_star_multi_queue_set_solution(worker, current_node, g);
+    }
+    else
+    {
+      // Os sucessores são atualizados diretamente, sem passar por outro trabalhador. Sem memória para os
+      // sucessores a procura termina
+      if(!a_star->common->visit_func(current_node->state, a_star->common->state_allocator, neighbors))
+      {
+        atomic_store(&a_star->common->allocation_error, true);
+        a_star_multi_queue_stop(a_star);
+      }
+      else
+      {
+        for(size_t i = 0; i < neighbors->size; i++)
+        {
+          a_star_multi_queue_update(worker, current_node, g, h, &neighbors->items[i]);
+        }
+      }
+      successors_clear(neighbors);
+    }
+
+    // Os sucessores já foram contados, a entrada expandida deixa de contar
+    a_star_multi_queue_done(a_star);
+  }
+
+  // Liberta o buffer de vizinhos
+  successors_destroy(neighbors);
+
+  pthread_exit(NULL);
+}
+
+// Cria uma nova instância para resolver um problema
+a_star_multi_queue_t* a_star_multi_queue_create(size_t struct_size,
+                                                goal_function goal_func,
+                                                visit_function visit_func,
+                                                heuristic_function h_func,
+                                                distance_function d_func,
+                                                print_function print_func,
+                                                int num_workers,
+                                                bool stop_on_first_solution,
+                                                const a_star_options_t* options)
+{
+  if(num_workers < 1)
+  {
+    return NULL;
+  }
+
+  a_star_multi_queue_t* a_star = (a_star_multi_queue_t*)malloc(sizeof(a_star_multi_queue_t));
+  if(a_star == NULL)
+  {
+    return NULL; // Erro de alocação
+  }
+
+  // Garante que a memória esteja limpa
+  a_star->common = NULL;
+  a_star->open_set = NULL;
+  a_star->workers = NULL;
+  a_star->num_workers = num_workers;
+  pthread_mutex_init(&a_star->lock, NULL);
+  pthread_mutex_init(&a_star->idle_lock, NULL);
+  pthread_cond_init(&a_star->idle_cond, NULL);
+  atomic_init(&a_star->idle, 0);
+  for(size_t i = 0; i < NODE_LOCKS; i++)
+  {
+    pthread_mutex_init(&a_star->node_locks[i], NULL);
+  }
+
+  // Os nós compactos não suportam várias threads, os trabalhadores utilizam sempre os nós embutidos nos estados
+  a_star_options_t parallel_options;
+  if(options != NULL)
+  {
+    parallel_options = *options;
+  }
+  else
+  {
+    a_star_options_default(&parallel_options);
+  }
+  parallel_options.compact_nodes = false;
+
+  // Inicializamos a parte comum do nosso algoritmo
+  a_star->common = a_star_create(struct_size, goal_func, visit_func, h_func, d_func, print_func, &parallel_options);
+  if(a_star->common == NULL)
+  {
+    a_star_multi_queue_destroy(a_star);
+    return NULL;
+  }
+
+  // Nós abertos partilhados por todos os trabalhadores
+  a_star->open_set = multi_queue_create(MULTI_QUEUE_HEAPS_PER_WORKER * a_star->num_workers,
+                                        a_star->common->options.open_set_type,
+                                        a_star->common->options.tie_policy);
+  if(a_star->open_set == NULL)
+  {
+    a_star_multi_queue_destroy(a_star);
+    return NULL;
+  }
+
+  a_star->workers = (a_star_multi_queue_worker_t*)calloc(a_star->num_workers, sizeof(a_star_multi_queue_worker_t));
+  if(a_star->workers == NULL)
+  {
+    a_star_multi_queue_destroy(a_star);
+    return NULL;
+  }
+
+  for(size_t i = 0; i < a_star->num_workers; i++)
+  {
+    a_star->workers[i].a_star = a_star;
+    a_star->workers[i].thread_id = i;
+    a_star->workers[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+  }
+
+  a_star->stop_on_first_solution = stop_on_first_solution;
+  atomic_init(&a_star->running, false);
+  atomic_init(&a_star->pending, 0);
+  atomic_init(&a_star->solution_cost, INT_MAX);
+
+  return a_star;
+}
+
+// Liberta uma instância do algoritmo
+void a_star_multi_queue_destroy(a_star_multi_queue_t* a_star)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  free(a_star->workers);
+  multi_queue_destroy(a_star->open_set);
+  a_star_destroy(a_star->common);
+  for(size_t i = 0; i < NODE_LOCKS; i++)
+  {
+    pthread_mutex_destroy(&a_star->node_locks[i]);
+  }
+  pthread_mutex_destroy(&a_star->lock);
+  pthread_mutex_destroy(&a_star->idle_lock);
+  pthread_cond_destroy(&a_star->idle_cond);
+  free(a_star);
+}
+
+// Prepara a instância para resolver outro problema
+void a_star_multi_queue_reset(a_star_multi_queue_t* a_star)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  // Entradas que ficaram por processar na resolução anterior
+  multi_queue_clean(a_star->open_set);
+  atomic_store(&a_star->solution_cost, INT_MAX);
+  a_star_reset(a_star->common);
+}
+
+// Resolve o problema
+void a_star_multi_queue_solve(a_star_multi_queue_t* a_star, void* initial, void* goal)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  // Guarda os nossos estados inicial e objetivo
+  state_t* initial_state = state_allocator_new(a_star->common->state_allocator, initial);
+  if(initial_state == NULL)
+  {
+    return;
+  }
+
+  // Preparamos o nosso objetivo caso tenha sido passado (existem problemas em que não se passam soluções)
+  if(goal)
+  {
+    a_star->common->goal_state = state_allocator_new(a_star->common->state_allocator, goal);
+    if(a_star->common->goal_state == NULL)
+    {
+      return;
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &(a_star->common->start_time));
+#ifdef STATS_GEN
+  search_data_start();
+#endif
+
+  // O nó inicial é a primeira entrada dos nós abertos, os trabalhadores começam a partir dela
+  a_star_node_t* initial_node = node_allocator_new(a_star->common->node_allocator, initial_state);
+  initial_node->g = 0;
+  initial_node->h = a_star->common->h_func(initial_state, a_star->common->goal_state);
+  atomic_store(&a_star->pending, 1);
+  if(!multi_queue_push(a_star->open_set, initial_node->h, initial_node->h, initial_node, &a_star->workers[0].seed))
+  {
+    atomic_store(&a_star->pending, 0);
+    atomic_store(&a_star->common->allocation_error, true);
+    return;
+  }
+
+  atomic_store(&a_star->running, true);
+  size_t started = 0;
+  for(; started < a_star->num_workers; started++)
+  {
+    if(pthread_create(&a_star->workers[started].thread, NULL, a_star_multi_queue_worker_function, &a_star->workers[started]) !=
+       0)
+    {
+      // Os trabalhadores já iniciados continuam a procura
+      break;
+    }
+  }
+  if(started == 0)
+  {
+    atomic_store(&a_star->running, false);
+    return;
+  }
+
+#ifdef STATS_GEN
+  // O tempo das entradas registadas pelos trabalhadores avança com o coordenador
+  struct timespec tick = { 0, 100000 };
+  while(atomic_load(&a_star->running))
+  {
+    search_data_tick();
+    nanosleep(&tick, NULL);
+  }
+#endif
+  for(size_t i = 0; i < started; i++)
+  {
+    pthread_join(a_star->workers[i].thread, NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &(a_star->common->end_time));
+
+  // Calculamos o tempo de execução e outras estatísticas
+  a_star_measure_memory(a_star->common);
+  multi_queue_memory(a_star->open_set, &a_star->common->memory.open_set);
+  for(size_t i = 0; i < started; i++)
+  {
+    a_star_multi_queue_worker_t* worker = &a_star->workers[i];
+    a_star->common->expanded += worker->expanded;
+    a_star->common->generated += worker->generated;
+    a_star->common->nodes_new += worker->nodes_new;
+    a_star->common->nodes_reinserted += worker->nodes_reinserted;
+    a_star->common->paths_better += worker->paths_better;
+    a_star->common->paths_worst_or_equals += worker->paths_worst_or_equals;
+    if(worker->max_pending > a_star->common->max_min_heap_size)
+    {
+      a_star->common->max_min_heap_size = worker->max_pending;
+    }
+  }
+  a_star->common->execution_time = (a_star->common->end_time.tv_sec - a_star->common->start_time.tv_sec);
+  a_star->common->execution_time += (a_star->common->end_time.tv_nsec - a_star->common->start_time.tv_nsec) / 1000000000.0;
+}
+
+// Imprime estatísticas do algoritmo no formato desejado
+void a_star_multi_queue_print_statistics(a_star_multi_queue_t* a_star, bool csv, bool show_solution)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  if(show_solution)
+  {
+    a_star_print_statistics(a_star->common, csv, true);
+    return;
+  }
+
+  if(!csv)
+  {
+    if(a_star->stop_on_first_solution)
+    {
+      printf("Método: Primeira solução (MultiQueue)\n");
+    }
+    else
+    {
+      printf("Método: Melhor solução (MultiQueue)\n");
+    }
+  }
+
+  a_star_print_statistics(a_star->common, csv, false);
+
+  if(!csv)
+  {
+    size_t stale = 0;
+    for(size_t i = 0; i < a_star->num_workers; i++)
+    {
+      stale += a_star->workers[i].stale;
+    }
+    printf("Entradas desatualizadas ignoradas: %zu\n", stale);
+
+    printf("Estatísticas Trabalhadores:\n");
+    for(size_t i = 0; i < a_star->num_workers; i++)
+    {
+      a_star_multi_queue_worker_t* worker = &a_star->workers[i];
+      printf("- Trabalhador #%ld\n", i + 1);
+      printf("  * Estados gerados: %d, Estados expandidos: %d, Entradas desatualizadas: %zu, Vezes parado: %zu\n",
+             worker->generated,
+             worker->expanded,
+             worker->stale,
+             worker->waits);
+      printf("  * Novos nós: %d, Nós reinseridos: %d, Caminhos piores (ignorados): %d, Caminhos melhores (atualizados): %d\n",
+             worker->nodes_new,
+             worker->nodes_reinserted,
+             worker->paths_worst_or_equals,
+             worker->paths_better);
+    }
+  }
+}
@@ -1,27 +1,340 @@
 #include "astar_parallel.h"
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_IDLE_TIME 100000
+// Função para encontrar o next worker baseada no hash do estado, ou no hash da função de atribuição se definida
+// Isto garante uma distribuição balanceada entre os trabalhadores e ao mesmo
+// tempo garante que os nós processam sempre os mesmos estados. Utilizamos os 32 bits
+// mais significativos do hash, multiplicados pelo número de trabalhadores (evita a divisão)
+static size_t assign_to_worker(a_star_parallel_t* a_star, state_t* state)
+{
+  uint64_t hash = a_star->owner_func != NULL ? a_star->owner_func(state) : (uint64_t)state->hash;
+  return (size_t)(((hash >> 32) * a_star->scheduler.num_workers) >> 32);
+}
 
-// Estrutura que contem a mensagem a ser passada nas queues
-typedef struct
+// Termina a procura e acorda os trabalhadores bloqueados à espera de mensagens
+static void a_star_parallel_stop(a_star_parallel_t* a_star)
 {
-  a_star_node_t* parent;
-  state_t* state;
-} a_star_message_t;
+  atomic_store(&a_star->running, false);
+  channel_close(a_star->channel);
+}
 
-// Função para encontrar o next worker baseada na posição de memória do estado
-// Isto garante uma distribuição balanceada entre os trabalhadores e ao mesmo
-// tempo garante que os nós processam sempre os mesmos estados
-static size_t assign_to_worker(a_star_parallel_t* a_star, state_t* state)
+// Envia um sucessor ao trabalhador responsável pelo seu estado sem passar por uma caixa de saída (estado inicial)
+static void a_star_parallel_send(a_star_parallel_t* a_star, a_star_message_t* message)
+{
+  size_t worker_id = assign_to_worker(a_star, message->successor.state);
+  atomic_fetch_add(&a_star->work, 1);
+  if(!channel_send(a_star->channel, worker_id, (void*)message))
+  {
+    // A mensagem não foi guardada, não pode contar como trabalho pendente
+    atomic_fetch_sub(&a_star->work, 1);
+  }
+}
+
+// Mensagens que cabem na caixa de saída de cada trabalhador de destino
+static size_t outbox_capacity(a_star_parallel_t* a_star)
+{
+  return a_star->common->options.outbox_size > 1 ? a_star->common->options.outbox_size : 1;
+}
+
+// Envia num único bloco as mensagens guardadas para um trabalhador, as mensagens são contadas antes de serem enviadas
+static void a_star_worker_flush(a_star_worker_t* worker, size_t worker_id)
+{
+  a_star_parallel_t* a_star = worker->a_star;
+  size_t count = worker->outbox_count[worker_id];
+  if(count == 0)
+  {
+    return;
+  }
+
+  a_star_message_t* messages = &worker->outbox[worker_id * outbox_capacity(a_star)];
+  atomic_fetch_add(&a_star->work, count);
+  if(channel_send_batch(a_star->channel, worker_id, messages, count))
+  {
+    worker->messages_sent += count;
+    worker->batches_sent++;
+    if(worker_id != (size_t)worker->thread_id)
+    {
+      worker->messages_remote += count;
+    }
+  }
+  else
+  {
+    // As mensagens não foram guardadas, não podem contar como trabalho pendente
+    atomic_fetch_sub(&a_star->work, count);
+  }
+  worker->outbox_count[worker_id] = 0;
+}
+
+// Envia as mensagens guardadas para todos os trabalhadores
+static void a_star_worker_flush_all(a_star_worker_t* worker)
+{
+  for(size_t i = 0; i < worker->a_star->scheduler.num_workers; i++)
+  {
+    a_star_worker_flush(worker, i);
+  }
+  worker->expansions_since_flush = 0;
+}
+
+// Guarda um sucessor na caixa de saída do trabalhador responsável pelo seu estado, a caixa é enviada quando enche
+static void a_star_worker_send(a_star_worker_t* worker, a_star_message_t* message)
+{
+  a_star_parallel_t* a_star = worker->a_star;
+  size_t worker_id = assign_to_worker(a_star, message->successor.state);
+  size_t capacity = outbox_capacity(a_star);
+
+  worker->outbox[worker_id * capacity + worker->outbox_count[worker_id]] = *message;
+  if(++worker->outbox_count[worker_id] == capacity)
+  {
+    a_star_worker_flush(worker, worker_id);
+  }
+}
+
+// Soma a memória das caixas de saída de um trabalhador, a utilizada são as mensagens por enviar
+static void a_star_worker_outbox_memory(a_star_worker_t* worker, memory_usage_t* usage)
+{
+  size_t num_workers = worker->a_star->scheduler.num_workers;
+  usage->reserved += num_workers * (outbox_capacity(worker->a_star) * sizeof(a_star_message_t) + sizeof(size_t));
+  for(size_t i = 0; i < num_workers; i++)
+  {
+    usage->used += worker->outbox_count[i] * sizeof(a_star_message_t);
+  }
+}
+
+// Tempo máximo que um trabalhador ocioso espera por mensagens antes de procurar nós para roubar
+#define STEAL_WAIT_NS 100000
+
+// Nós abertos que um trabalhador precisa de ter para lhe serem roubados nós, fica sempre com pelo menos metade
+#define STEAL_MIN_NODES 2
+
+// Protege os nós abertos de um trabalhador, apenas necessário quando outros trabalhadores podem roubar nós
+static inline void open_set_lock(a_star_worker_t* worker)
+{
+  if(worker->a_star->common->options.steal_batch > 0)
+  {
+    pthread_mutex_lock(&worker->open_set_lock);
+  }
+}
+
+static inline void open_set_unlock(a_star_worker_t* worker)
+{
+  if(worker->a_star->common->options.steal_batch > 0)
+  {
+    pthread_mutex_unlock(&worker->open_set_lock);
+  }
+}
+
+// Retira o melhor nó dos nós abertos do trabalhador, NULL se não existirem nós (podem ter sido roubados)
+static a_star_node_t* a_star_worker_pop(a_star_worker_t* worker)
+{
+  a_star_node_t* node = NULL;
+  open_set_lock(worker);
+  if(worker->open_set->size > 0)
+  {
+    // O heap marca o nó como fora do open_set
+    node = (a_star_node_t*)min_heap_pop(worker->open_set).data;
+  }
+  open_set_unlock(worker);
+  return node;
+}
+
+// Trabalhador com mais nós abertos a quem se podem roubar nós, NULL se não existir. O tamanho dos nós abertos é
+// lido sem o mutex, é apenas uma indicação
+static a_star_worker_t* a_star_worker_victim(a_star_worker_t* worker)
+{
+  a_star_parallel_t* a_star = worker->a_star;
+  a_star_worker_t* victim = NULL;
+  size_t victim_size = STEAL_MIN_NODES - 1;
+  for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
+  {
+    a_star_worker_t* other = &a_star->scheduler.workers[i];
+    size_t size = other->open_set->size;
+    if(other != worker && size > victim_size)
+    {
+      victim = other;
+      victim_size = size;
+    }
+  }
+  return victim;
+}
+
+// Verifica se um nó já não pode levar a uma solução melhor do que a encontrada
+static bool a_star_worker_prune(a_star_parallel_t* a_star, a_star_node_t* node)
+{
+  // Verificamos se já existe uma solução, caso já exista temos de verificar se
+  // este trabalhador está a procurar por soluções que se encontram a uma distância maior
+  // do que a solução já encontrada, será que vale a pena continuar? Consideramos que não.
+  // A solução é protegida pelo lock, apenas o seu custo é publicado para os trabalhadores
+  int f_solution = atomic_load(&a_star->solution_cost);
+  int f_current = node->g + node->h;
+  return f_current > f_solution || node->g > f_solution;
+}
+
+// Expande um nó retirado dos nós abertos: regista a solução se for o objetivo, caso contrário envia os sucessores
+// aos trabalhadores responsáveis pelos seus estados. Retorna falso se o nó já não pode levar a uma solução melhor
+static bool a_star_worker_expand(a_star_worker_t* worker, a_star_node_t* current_node, successors_t* neighbors)
+{
+  a_star_parallel_t* a_star = worker->a_star;
+  worker->expanded++;
+
+#ifdef STATS_GEN
+  search_data_add_entry(worker->thread_id, current_node->state, ACTION_VISITED);
+#endif
+
+  if(a_star_worker_prune(a_star, current_node))
+  {
+    return false;
+  }
+
+  // Se encontramos o objetivo saímos e retornamos o nó
+  if(a_star->common->goal_func(current_node->state, a_star->common->goal_state))
+  {
+    a_star->common->num_solutions++;
+    // Temos de informar que encontramos o nosso objetivo
+    pthread_mutex_lock(&(a_star->lock));
+    if(a_star->common->solution == NULL)
+    {
+      // Esta é a primeira solução encontrada nada de especial
+      // a fazer
+      a_star->common->num_better_solutions++;
+      a_star->common->solution = current_node;
+      atomic_store(&a_star->solution_cost, current_node->g);
+#ifdef STATS_GEN
+      a_star_node_t* solution_path = a_star->common->solution;
+      while(solution_path != NULL)
+      {
+        search_data_add_entry(worker->thread_id, solution_path->state, ACTION_GOAL);
+        solution_path = solution_path->parent;
+      }
+#endif
+    }
+    else
+    {
+      // Já existe uma solução, temos de verificar se esta nova
+      // solução tem um custo menor (o nó da solução pertence a outro trabalhador, que o pode continuar a
+      // atualizar, comparamos com o custo publicado)
+      int existing_cost = atomic_load(&a_star->solution_cost);
+      int attempt_cost = current_node->g + current_node->h;
+
+      if(existing_cost > attempt_cost)
+      {
+        a_star->common->num_better_solutions++;
+        a_star->common->solution = current_node;
+        atomic_store(&a_star->solution_cost, current_node->g);
+#ifdef STATS_GEN
+        a_star_node_t* solution_path = a_star->common->solution;
+        while(solution_path != NULL)
+        {
+          search_data_add_entry(worker->thread_id, solution_path->state, ACTION_GOAL);
+          solution_path = solution_path->parent;
+        }
+#endif
+      }
+      else if(existing_cost == attempt_cost)
+      {
+        a_star->common->num_worst_solutions++;
+      }
+    }
+    pthread_mutex_unlock(&(a_star->lock));
+
+    // Queremos apenas a primeira solução
+    if(a_star->stop_on_first_solution)
+    {
+      a_star_parallel_stop(a_star);
+    }
+  }
+  else
+  {
+    // Executa a função que visita os vizinhos deste nó, sem memória para os sucessores a procura termina
+    if(!a_star->common->visit_func(current_node->state, a_star->common->state_allocator, neighbors))
+    {
+      atomic_store(&a_star->common->allocation_error, true);
+      successors_clear(neighbors);
+      a_star_parallel_stop(a_star);
+      return true;
+    }
+
+    // Itera por todos os vizinhos gerados e envia para a devida tarefa
+    for(size_t i = 0; i < neighbors->size; i++)
+    {
+      // Compomos a mensagem com os dados necessários e enviamos para o
+      // trabalhador que vai tratar deste estado
+      a_star_message_t message = { current_node, neighbors->items[i] };
+      a_star_worker_send(worker, &message);
+    }
+    successors_clear(neighbors);
+
+    // As mensagens não ficam retidas muitas expansões, os outros trabalhadores podem estar à espera delas
+    size_t outbox_expansions = a_star->common->options.outbox_expansions;
+    if(outbox_expansions > 0 && ++worker->expansions_since_flush >= outbox_expansions)
+    {
+      a_star_worker_flush_all(worker);
+    }
+  }
+  return true;
+}
+
+// Rouba ao trabalhador com mais nós abertos os seus nós com menor custo e expande-os. Os nós passam a estar fora dos
+// nós abertos do dono, que os volta a inserir se receber um caminho melhor. Retorna falso se não roubou nós
+static bool a_star_worker_steal(a_star_worker_t* worker, successors_t* neighbors)
+{
+  a_star_parallel_t* a_star = worker->a_star;
+  if(a_star->common->options.steal_batch == 0)
+  {
+    return false;
+  }
+
+  a_star_worker_t* victim = a_star_worker_victim(worker);
+  if(victim == NULL)
+  {
+    return false;
+  }
+
+  // O dono fica com pelo menos metade dos nós
+  size_t count = 0;
+  pthread_mutex_lock(&victim->open_set_lock);
+  size_t available = victim->open_set->size >= STEAL_MIN_NODES ? victim->open_set->size / 2 : 0;
+  while(count < a_star->common->options.steal_batch && count < available)
+  {
+    worker->stolen[count++] = (a_star_node_t*)min_heap_pop(victim->open_set).data;
+  }
+  pthread_mutex_unlock(&victim->open_set_lock);
+
+  if(count == 0)
+  {
+    return false;
+  }
+
+  worker->steals++;
+  worker->nodes_stolen += count;
+  for(size_t i = 0; i < count; i++)
+  {
+    a_star_worker_expand(worker, worker->stolen[i], neighbors);
+  }
+  return true;
+}
+
+// Bloqueia um trabalhador ocioso até receber mensagens ou, com o roubo de nós, até existirem nós para roubar.
+// Retorna falso se a procura terminou
+static bool a_star_worker_wait(a_star_worker_t* worker)
 {
-  return state->hash % a_star->scheduler.num_workers;
+  a_star_parallel_t* a_star = worker->a_star;
+  if(a_star->common->options.steal_batch == 0)
+  {
+    return channel_wait(a_star->channel, worker->thread_id);
+  }
 
-  // size_t hash = hash_function(state->data, state->struct_size, HASH_CAPACITY);
-  // return hash % a_star->scheduler.num_workers;
+  while(!channel_has_messages(a_star->channel, worker->thread_id) && a_star_worker_victim(worker) == NULL)
+  {
+    if(!channel_wait_timed(a_star->channel, worker->thread_id, STEAL_WAIT_NS))
+    {
+      return false;
+    }
+  }
+  return atomic_load(&a_star->running);
 }
 
 // Função que implementa a lógica de um trabalhador, aqui se processa o algoritmo A*
@@ -38,30 +351,60 @@ void* a_star_worker_function(void* arg)
   worker->nodes_reinserted = 0;
   worker->paths_better = 0;
   worker->paths_worst_or_equals = 0;
+  worker->messages_sent = 0;
+  worker->messages_remote = 0;
+  worker->batches_sent = 0;
+  worker->steals = 0;
+  worker->nodes_stolen = 0;
+
+  // As caixas de saída começam vazias
+  for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
+  {
+    worker->outbox_count[i] = 0;
+  }
+  worker->expansions_since_flush = 0;
 
-  worker->idle = false;
+  // Este buffer recebe os vizinhos de um nó, é reutilizado em todas as expansões
+  successors_t* neighbors = successors_create(0);
+  if(neighbors == NULL)
+  {
+    pthread_exit(NULL);
+  }
 
-  // Esta lista para receber os vizinhos de um nó
-  linked_list_t* neighbors = linked_list_create();
+  // O trabalhador começa ocioso, sem nós e sem contar para o trabalho por fazer
+  worker->idle = true;
 
-  while(a_star->running)
+  while(atomic_load(&a_star->running))
   {
-    // Este trabalhador considera-se ocioso caso não existam nós a explorar ou mensagens destinadas a si
-    worker->idle = worker->open_set->size == 0 && !channel_has_messages(a_star->channel, worker->thread_id);
+    // Um trabalhador ocioso bloqueia até receber mensagens, o canal é fechado quando a procura termina
+    if(worker->idle)
+    {
+      if(!a_star_worker_wait(worker))
+      {
+        break;
+      }
+
+      // Passa a contar como ativo antes de processar as mensagens, que ainda estão contadas
+      atomic_fetch_add(&a_star->work, 1);
+      worker->idle = false;
+    }
 
     // Processamos todos os estados que estão no canal para esta tarefa
     // Aqui que ocorre a atualização do custo do estado
     if(channel_has_messages(a_star->channel, worker->thread_id))
     {
-      worker->idle = false;
       size_t messages_count = 0;
       a_star_message_t* messages = channel_receive(a_star->channel, worker->thread_id, &messages_count);
+      open_set_lock(worker);
 
-      for(size_t i = 0; i < messages_count; i++)
+      // Sem memória para inserir um nó nos nós abertos a procura não pode continuar
+      bool allocated = true;
+      for(size_t i = 0; i < messages_count && allocated; i++)
       {
         // Retiramos os dados da mensagem e libertamos a memória
         a_star_node_t* parent_node = messages[i].parent;
-        state_t* state = messages[i].state;
+        successor_t* successor = &messages[i].successor;
+        state_t* state = successor->state;
 
         // Se o nó pai não foi enviado é porque estamos a lidar com o estado inicial
         if(parent_node == NULL)
@@ -72,7 +415,7 @@ void* a_star_worker_function(void* arg)
           initial_node->h = a_star->common->h_func(initial_node->state, a_star->common->goal_state);
 
           // Inserimos o nó na nossa fila e saímos já que não existem mais mensagens
-          initial_node->index_in_open_set = min_heap_insert(worker->open_set, initial_node->h, initial_node);
+          allocated = min_heap_insert(worker->open_set, initial_node->h, initial_node->h, initial_node) != SIZE_MAX;
           break;
         }
 
@@ -91,21 +434,22 @@ void* a_star_worker_function(void* arg)
           search_data_add_entry(worker->thread_id, child_node->state, ACTION_SUCESSOR);
 #endif
 
-          // Encontra o custo de chegar do estado pai a este estado e calculamos a heurística (distância para chegar ao objetivo)
-          child_node->g = parent_node->g + a_star->common->d_func(parent_node->state, child_node->state);
-          child_node->h = a_star->common->h_func(child_node->state, a_star->common->goal_state);
+          // Encontra o custo de chegar do estado pai a este estado e calculamos a heurística (distância para chegar ao
+          // objetivo), apenas se a função de visita não os forneceu
+          child_node->g = parent_node->g + a_star_successor_cost(a_star->common, parent_node->state, successor);
+          child_node->h = a_star_successor_h(a_star->common, parent_node->h, successor);
 
           // Calculamos o custo
           int cost = child_node->g + child_node->h;
 
           // Inserimos o nó na nossa fila
-          child_node->index_in_open_set = min_heap_insert(worker->open_set, cost, child_node);
+          allocated = min_heap_insert(worker->open_set, cost, child_node->h, child_node) != SIZE_MAX;
           worker->nodes_new++;
         }
         else
         {
           // Encontra o custo de chegar do estado pai para este estado
-          int g_attempt = parent_node->g + a_star->common->d_func(parent_node->state, child_node->state);
+          int g_attempt = parent_node->g + a_star_successor_cost(a_star->common, parent_node->state, successor);
 
           // Se o custo for maior do que o nó já tem, não faz sentido atualizar
           // existe outro caminho mais curto para este estado
@@ -118,9 +462,8 @@ void* a_star_worker_function(void* arg)
           // O estado pai é o caminho mais curto para este estado, atualizamos o pai deste estado
           child_node->parent = parent_node;
 
-          // Atualizamos os parâmetros do nó
+          // Atualizamos os parâmetros do nó, a heurística depende apenas do estado e não muda
           child_node->g = g_attempt;
-          child_node->h = a_star->common->h_func(child_node->state, a_star->common->goal_state);
 
           // Calculamos o novo custo
           int cost = child_node->g + child_node->h;
@@ -129,127 +472,67 @@ void* a_star_worker_function(void* arg)
           if(child_node->index_in_open_set == SIZE_MAX)
           {
             // Inserimos o nó na nossa fila novamente
-            child_node->index_in_open_set = min_heap_insert(worker->open_set, cost, child_node);
+            allocated = min_heap_insert(worker->open_set, cost, child_node->h, child_node) != SIZE_MAX;
             worker->nodes_reinserted++;
           }
           else
           {
             // Atualizamos a nossa fila prioritária
-            min_heap_update_cost(worker->open_set, child_node->index_in_open_set, cost);
+            allocated = min_heap_update_cost(worker->open_set, child_node->index_in_open_set, cost, child_node->h);
           }
         }
       }
 
-      if(messages_count > 0)
+      open_set_unlock(worker);
+
+      // As mensagens já foram processadas, o trabalho que geraram está nos nós abertos
+      atomic_fetch_sub(&a_star->work, messages_count);
+      if(!allocated)
       {
-        free(messages);
+        atomic_store(&a_star->common->allocation_error, true);
+        a_star_parallel_stop(a_star);
+        break;
       }
     }
 
     if(worker->max_min_heap_size < worker->open_set->size)
       worker->max_min_heap_size = worker->open_set->size;
 
-    // Temos pelo menos um nó na nossa lista aberta que podemos processar
-    if(worker->open_set->size)
+    // Sem nós nem mensagens o trabalhador fica ocioso, se era o último trabalho a procura terminou. As mensagens
+    // guardadas são enviadas antes, podem ser para o próprio trabalhador
+    if(worker->open_set->size == 0)
     {
-      worker->idle = false;
-      // A seguinte operação pode ocorrer em O(log(N))
-      // se nosAbertos é um min-heap ou uma queue prioritária
-      heap_node_t top_element = min_heap_pop(worker->open_set);
-
-      // Nó atual na nossa árvore
-      a_star_node_t* current_node = (a_star_node_t*)top_element.data;
-      current_node->index_in_open_set = SIZE_MAX;
-      worker->expanded++;
-
-#ifdef STATS_GEN
-      search_data_add_entry(worker->thread_id, current_node->state, ACTION_VISITED);
-#endif
-
-      // Verificamos se já existe uma solução, caso já exista temos de verificar se
-      // este trabalhador está a procurar por soluções que se encontram a uma distância maior
-      // do que a solução já encontrada, será que vale a pena continuar? Consideramos que não e saímos.
-      if(a_star->common->solution != NULL)
+      a_star_worker_flush_all(worker);
+      if(!channel_has_messages(a_star->channel, worker->thread_id))
       {
-        int f_solution = a_star->common->solution->g;
-        int f_current = current_node->g + current_node->h;
-
-        if(f_current > f_solution || current_node->g > a_star->common->solution->g)
+        // Sem trabalho próprio, tentamos roubar nós a outro trabalhador antes de ficar ocioso
+        if(a_star_worker_steal(worker, neighbors))
         {
-          min_heap_clean(worker->open_set);
           continue;
         }
-      }
 
-      // Se encontramos o objetivo saímos e retornamos o nó
-      if(a_star->common->goal_func(current_node->state, a_star->common->goal_state))
-      {
-        a_star->common->num_solutions++;
-        // Temos de informar que encontramos o nosso objetivo
-        pthread_mutex_lock(&(a_star->lock));
-        if(a_star->common->solution == NULL)
+        worker->idle = true;
+        if(atomic_fetch_sub(&a_star->work, 1) == 1)
         {
-          // Esta é a primeira solução encontrada nada de especial
-          // a fazer
-          a_star->common->num_better_solutions++;
-          a_star->common->solution = current_node;
-#ifdef STATS_GEN
-          a_star_node_t* solution_path = a_star->common->solution;
-          while(solution_path != NULL)
-          {
-            search_data_add_entry(worker->thread_id, solution_path->state, ACTION_GOAL);
-            solution_path = solution_path->parent;
-          }
-#endif
+          a_star_parallel_stop(a_star);
         }
-        else
-        {
-          // Já existe uma solução, temos de verificar se esta nova
-          // solução tem um custo menor
-          int existing_cost = a_star->common->solution->g + a_star->common->solution->h;
-          int attempt_cost = current_node->g + current_node->h;
-
-          if(existing_cost > attempt_cost)
-          {
-            a_star->common->num_better_solutions++;
-            a_star->common->solution = current_node;
-#ifdef STATS_GEN
-            a_star_node_t* solution_path = a_star->common->solution;
-            while(solution_path != NULL)
-            {
-              search_data_add_entry(worker->thread_id, solution_path->state, ACTION_GOAL);
-              solution_path = solution_path->parent;
-            }
-#endif
-          }
-          else if(existing_cost == attempt_cost)
-          {
-            a_star->common->num_worst_solutions++;
-          }
-        }
-        pthread_mutex_unlock(&(a_star->lock));
+        continue;
       }
-      else
-      {
-        // Executa a função que visita os vizinhos deste nó
-        a_star->common->visit_func(current_node->state, a_star->common->state_allocator, neighbors);
+    }
 
-        // Itera por todos os vizinhos gerados e envia para a devida tarefa
-        while(linked_list_size(neighbors))
-        {
-          // Compomos a mensagem com os dados necessários e identificamos qual
-          // o trabalhador que vai tratar deste estado
-          a_star_message_t message = { current_node, (state_t*)linked_list_pop_back(neighbors) };
-          size_t worker_id = assign_to_worker(a_star, message.state);
-          // Enviamos a mensagem para o respetivo trabalhador
-          channel_send(a_star->channel, worker_id, (void*)&message);
-        }
-      }
+    // Temos pelo menos um nó na nossa lista aberta que podemos processar
+    a_star_node_t* current_node = a_star_worker_pop(worker);
+    if(current_node != NULL && !a_star_worker_expand(worker, current_node, neighbors))
+    {
+      // Os nós seguintes têm um custo igual ou maior, também não levam a uma solução melhor
+      open_set_lock(worker);
+      min_heap_clean(worker->open_set);
+      open_set_unlock(worker);
     }
   }
 
-  // Liberta a lista de vizinhos
-  linked_list_destroy(neighbors);
+  // Liberta o buffer de vizinhos
+  successors_destroy(neighbors);
 
   pthread_exit(NULL);
 }
@@ -262,7 +545,8 @@ a_star_parallel_t* a_star_parallel_create(size_t struct_size,
                                           distance_function d_func,
                                           print_function print_func,
                                           int num_workers,
-                                          bool stop_on_first_solution)
+                                          bool stop_on_first_solution,
+                                          const a_star_options_t* options)
 {
   a_star_parallel_t* a_star = (a_star_parallel_t*)malloc(sizeof(a_star_parallel_t));
   if(a_star == NULL)
@@ -274,11 +558,24 @@ a_star_parallel_t* a_star_parallel_create(size_t struct_size,
   a_star->scheduler.workers = NULL;
   a_star->channel = NULL;
   a_star->common = NULL;
+  a_star->owner_func = NULL;
 
   pthread_mutex_init(&a_star->lock, NULL);
 
+  // Os nós compactos não suportam várias threads, os trabalhadores utilizam sempre os nós embutidos nos estados
+  a_star_options_t parallel_options;
+  if(options != NULL)
+  {
+    parallel_options = *options;
+  }
+  else
+  {
+    a_star_options_default(&parallel_options);
+  }
+  parallel_options.compact_nodes = false;
+
   // Inicializamos a parte comum do nosso algoritmo
-  a_star->common = a_star_create(struct_size, goal_func, visit_func, h_func, d_func, print_func);
+  a_star->common = a_star_create(struct_size, goal_func, visit_func, h_func, d_func, print_func, &parallel_options);
   if(a_star->common == NULL)
   {
     a_star_parallel_destroy(a_star);
@@ -295,6 +592,17 @@ a_star_parallel_t* a_star_parallel_create(size_t struct_size,
     return NULL;
   }
 
+  // Os trabalhadores começam sem memória, assim podem ser destruídos se alguma alocação falhar
+  a_star->scheduler.num_workers = num_workers;
+  for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
+  {
+    a_star->scheduler.workers[i].open_set = NULL;
+    a_star->scheduler.workers[i].outbox = NULL;
+    a_star->scheduler.workers[i].outbox_count = NULL;
+    a_star->scheduler.workers[i].stolen = NULL;
+    pthread_mutex_init(&a_star->scheduler.workers[i].open_set_lock, NULL);
+  }
+
   // Criamos um canal para que os trabalhadores possam comunicar
   a_star->channel = channel_create(num_workers, sizeof(a_star_message_t));
   if(a_star->channel == NULL)
@@ -305,17 +613,38 @@ a_star_parallel_t* a_star_parallel_create(size_t struct_size,
 
   // Inicializamos as estruturas que vão conter o estado de cada
   // um dos trabalhadores
-  a_star->scheduler.num_workers = num_workers;
   for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
   {
     a_star->scheduler.workers[i].a_star = a_star;
     a_star->scheduler.workers[i].thread_id = i;
-    a_star->scheduler.workers[i].open_set = min_heap_create();
+    a_star->scheduler.workers[i].open_set = min_heap_create(
+        a_star->common->options.open_set_type, a_star->common->options.tie_policy, offsetof(a_star_node_t, index_in_open_set));
     a_star->scheduler.workers[i].idle = true;
 
+    // Uma caixa de saída para cada trabalhador de destino
+    a_star->scheduler.workers[i].outbox =
+        (a_star_message_t*)malloc(num_workers * outbox_capacity(a_star) * sizeof(a_star_message_t));
+    a_star->scheduler.workers[i].outbox_count = (size_t*)calloc(num_workers, sizeof(size_t));
+
+    // Nós roubados a outros trabalhadores por expandir
+    size_t steal_batch = a_star->common->options.steal_batch;
+    a_star->scheduler.workers[i].stolen =
+        (a_star_node_t**)malloc((steal_batch > 0 ? steal_batch : 1) * sizeof(a_star_node_t*));
+    if(a_star->scheduler.workers[i].open_set == NULL || a_star->scheduler.workers[i].outbox == NULL ||
+       a_star->scheduler.workers[i].outbox_count == NULL || a_star->scheduler.workers[i].stolen == NULL)
+    {
+      a_star_parallel_destroy(a_star);
+      return NULL;
+    }
+
     // Reiniciamos as estatísticas internas do trabalhador
     a_star->scheduler.workers[i].expanded = 0;
     a_star->scheduler.workers[i].generated = 0;
+    a_star->scheduler.workers[i].messages_sent = 0;
+    a_star->scheduler.workers[i].messages_remote = 0;
+    a_star->scheduler.workers[i].steals = 0;
+    a_star->scheduler.workers[i].nodes_stolen = 0;
+    a_star->scheduler.workers[i].batches_sent = 0;
   }
 
   // Reiniciamos a variável utilizada para round-robin
@@ -324,11 +653,24 @@ a_star_parallel_t* a_star_parallel_create(size_t struct_size,
 
   // Inicializa as funções necessárias para o algoritmo funcionar
   a_star->stop_on_first_solution = stop_on_first_solution;
-  a_star->running = false;
+  atomic_init(&a_star->running, false);
+  atomic_init(&a_star->work, 0);
+  atomic_init(&a_star->solution_cost, INT_MAX);
 
   return a_star;
 }
 
+// Define a função que atribui os estados aos trabalhadores
+void a_star_parallel_set_owner(a_star_parallel_t* a_star, owner_function owner_func)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  a_star->owner_func = owner_func;
+}
+
 // Liberta uma instância do algoritmo A*
 void a_star_parallel_destroy(a_star_parallel_t* a_star)
 {
@@ -343,6 +685,10 @@ void a_star_parallel_destroy(a_star_parallel_t* a_star)
     for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
     {
       min_heap_destroy(a_star->scheduler.workers[i].open_set);
+      free(a_star->scheduler.workers[i].outbox);
+      free(a_star->scheduler.workers[i].outbox_count);
+      free(a_star->scheduler.workers[i].stolen);
+      pthread_mutex_destroy(&a_star->scheduler.workers[i].open_set_lock);
     }
     free(a_star->scheduler.workers);
   }
@@ -355,6 +701,27 @@ void a_star_parallel_destroy(a_star_parallel_t* a_star)
   free(a_star);
 }
 
+// Prepara a instância para resolver outro problema
+void a_star_parallel_reset(a_star_parallel_t* a_star)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  // Nós e mensagens que ficaram por processar na resolução anterior
+  for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
+  {
+    min_heap_clean(a_star->scheduler.workers[i].open_set);
+    a_star->scheduler.workers[i].idle = true;
+  }
+  channel_reset(a_star->channel);
+  a_star->scheduler.next_worker = 0;
+  atomic_store(&a_star->solution_cost, INT_MAX);
+
+  a_star_reset(a_star->common);
+}
+
 // Resolve o problema através do uso do algoritmo A*;
 void a_star_parallel_solve(a_star_parallel_t* a_star, void* initial, void* goal)
 {
@@ -385,86 +752,56 @@ void a_star_parallel_solve(a_star_parallel_t* a_star, void* initial, void* goal)
 
   // Com recurso a esta variável podemos enviar uma mensagem para os nossos trabalhadores
   // pararem
-  a_star->running = true;
-  // Iniciamos cada trabalhador
+  atomic_store(&a_star->running, true);
+  atomic_store(&a_star->work, 0);
+  // Iniciamos cada trabalhador, ficam bloqueados até receberem mensagens
   for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
   {
-    a_star->scheduler.workers[i].idle = false;
     int result =
         pthread_create(&(a_star->scheduler.workers[i].thread), NULL, a_star_worker_function, &(a_star->scheduler.workers[i]));
     if(result != 0)
     {
+      // Os trabalhadores já iniciados estão bloqueados à espera de mensagens
+      a_star_parallel_stop(a_star);
+      for(size_t j = 0; j < i; j++)
+      {
+        pthread_join(a_star->scheduler.workers[j].thread, NULL);
+      }
       return;
     }
   }
-  a_star_message_t message = { NULL, initial_state };
-  size_t worker_id = assign_to_worker(a_star, message.state);
-  // Enviamos o estado inicial para o respetivo trabalhador
-  channel_send(a_star->channel, worker_id, (void*)&message);
 
-  // Ciclo de execução que espera pela solução ou que todos os trabalhadores fiquem
-  // sem nós para processar
   clock_gettime(CLOCK_MONOTONIC, &(a_star->common->start_time));
-  int idle_tries = MAX_IDLE_TIME;
 #ifdef STATS_GEN
   search_data_start();
 #endif
-  while(a_star->running)
-  {
+  // Enviamos o estado inicial para o respetivo trabalhador
+  a_star_message_t message = { NULL, { initial_state, SUCCESSOR_UNKNOWN, SUCCESSOR_UNKNOWN } };
+  a_star_parallel_send(a_star, &message);
+
 #ifdef STATS_GEN
+  // O tempo das entradas registadas pelos trabalhadores avança com o coordenador
+  struct timespec tick = { 0, 100000 };
+  while(atomic_load(&a_star->running))
+  {
     search_data_tick();
-#endif
-    // Solução já foi encontrada e queremos sair à primeira solução
-    if(a_star->common->solution != NULL && a_star->stop_on_first_solution)
-    {
-      clock_gettime(CLOCK_MONOTONIC, &(a_star->common->end_time));
-      a_star->running = false;
-      break;
-    }
-
-    // Verificamos quantos workers estão ociosos, caso todos estejam ociosos assumimos que não existem mais nós a explorar
-    // ou a solução já foi encontrada
-    size_t idle_workers = 0;
-    for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
-    {
-
-      a_star_worker_t* worker = &(a_star->scheduler.workers[i]);
-
-      if(!worker->idle)
-      {
-        idle_tries = MAX_IDLE_TIME;
-        continue;
-      }
-
-      idle_workers++;
-    }
-
-    if(idle_workers == a_star->scheduler.num_workers)
-    {
-      if(idle_tries == MAX_IDLE_TIME)
-      {
-        clock_gettime(CLOCK_MONOTONIC, &(a_star->common->end_time));
-      }
-      idle_tries--;
-    }
-
-    if(idle_tries <= 0)
-    {
-      a_star->running = false;
-      break;
-    }
-
-    // O algoritmo deve continuar a correr enquanto houver trabalhadores que não estejam ociosos
-    a_star->running = true;
+    nanosleep(&tick, NULL);
   }
-  // Esperamos que todas os trabalhadores terminem
+#endif
+  // Os trabalhadores detetam o fim da procura (sem trabalho ou primeira solução) e terminam
   for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
   {
     pthread_join(a_star->scheduler.workers[i].thread, NULL);
   }
+  clock_gettime(CLOCK_MONOTONIC, &(a_star->common->end_time));
+
   // Calculamos o tempo de execução e outras estatísticas
+  a_star_measure_memory(a_star->common);
+  channel_memory(a_star->channel, &a_star->common->memory.channel);
   for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
   {
+    min_heap_memory(a_star->scheduler.workers[i].open_set, &a_star->common->memory.open_set);
+    a_star_worker_outbox_memory(&a_star->scheduler.workers[i], &a_star->common->memory.channel);
     a_star->common->expanded += a_star->scheduler.workers[i].expanded;
     a_star->common->generated += a_star->scheduler.workers[i].generated;
     a_star->common->max_min_heap_size += a_star->scheduler.workers[i].max_min_heap_size;
@@ -507,6 +844,34 @@ void a_star_parallel_print_statistics(a_star_parallel_t* a_star, bool csv, bool
 
   if(!csv)
   {
+    size_t messages_sent = 0;
+    size_t messages_remote = 0;
+    size_t batches_sent = 0;
+    for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
+    {
+      messages_sent += a_star->scheduler.workers[i].messages_sent;
+      messages_remote += a_star->scheduler.workers[i].messages_remote;
+      batches_sent += a_star->scheduler.workers[i].batches_sent;
+    }
+    printf("Mensagens enviadas: %zu em %zu blocos (média %.2f mensagens por bloco)\n",
+           messages_sent,
+           batches_sent,
+           batches_sent > 0 ? (double)messages_sent / batches_sent : 0);
+    printf("Mensagens para outros trabalhadores: %zu (%.2f%%)\n",
+           messages_remote,
+           messages_sent > 0 ? 100.0 * messages_remote / messages_sent : 0);
+    if(a_star->common->options.steal_batch > 0)
+    {
+      size_t steals = 0;
+      size_t nodes_stolen = 0;
+      for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
+      {
+        steals += a_star->scheduler.workers[i].steals;
+        nodes_stolen += a_star->scheduler.workers[i].nodes_stolen;
+      }
+      printf("Nós roubados: %zu em %zu roubos\n", nodes_stolen, steals);
+    }
+
     printf("Estatísticas Trabalhadores:\n");
     for(size_t i = 0; i < a_star->scheduler.num_workers; i++)
     {
@@ -521,6 +886,16 @@ void a_star_parallel_print_statistics(a_star_parallel_t* a_star, bool csv, bool
              a_star->scheduler.workers[i].nodes_reinserted,
              a_star->scheduler.workers[i].paths_worst_or_equals,
              a_star->scheduler.workers[i].paths_better);
+      printf("  * Mensagens enviadas: %zu, Para outros trabalhadores: %zu, Blocos enviados: %zu\n",
+             a_star->scheduler.workers[i].messages_sent,
+             a_star->scheduler.workers[i].messages_remote,
+             a_star->scheduler.workers[i].batches_sent);
+      if(a_star->common->options.steal_batch > 0)
+      {
+        printf("  * Nós roubados: %zu, Roubos: %zu\n",
+               a_star->scheduler.workers[i].nodes_stolen,
+               a_star->scheduler.workers[i].steals);
+      }
     }
   }
 }
@@ -0,0 +1,748 @@
+#include "astar_pbnf.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Custo do melhor nó aberto de um nblock, INT_MAX se estiver vazio
+static inline int nblock_top_cost(a_star_nblock_t* nblock)
+{
+  return nblock->open_set == NULL ? INT_MAX : min_heap_top_cost(nblock->open_set);
+}
+
+// Verifica se um nblock pode ser adquirido
+static inline bool nblock_is_free(a_star_nblock_t* nblock)
+{
+  return !nblock->in_use && nblock->sigma == 0 && nblock_top_cost(nblock) != INT_MAX;
+}
+
+// Recalcula o menor custo dos nblocks livres, o mutex do grafo já está obtido
+static void update_best_free_cost(a_star_pbnf_t* a_star)
+{
+  int best = INT_MAX;
+  for(size_t i = 0; i < a_star->num_free; i++)
+  {
+    int cost = nblock_top_cost(&a_star->nblocks[a_star->free_nblocks[i]]);
+    if(cost < best)
+    {
+      best = cost;
+    }
+  }
+  atomic_store(&a_star->best_free_cost, best);
+}
+
+// Adiciona um nblock à lista de livres se puder ser adquirido, retorna verdadeiro se foi adicionado
+static bool add_free(a_star_pbnf_t* a_star, size_t index)
+{
+  a_star_nblock_t* nblock = &a_star->nblocks[index];
+  if(nblock->free_index != PBNF_NO_NBLOCK || !nblock_is_free(nblock))
+  {
+    return false;
+  }
+
+  nblock->free_index = a_star->num_free;
+  a_star->free_nblocks[a_star->num_free++] = index;
+  return true;
+}
+
+// Retira um nblock da lista de livres, o último nblock da lista ocupa a sua posição
+static void remove_free(a_star_pbnf_t* a_star, size_t index)
+{
+  a_star_nblock_t* nblock = &a_star->nblocks[index];
+  if(nblock->free_index == PBNF_NO_NBLOCK)
+  {
+    return;
+  }
+
+  size_t last = a_star->free_nblocks[--a_star->num_free];
+  a_star->free_nblocks[nblock->free_index] = last;
+  a_star->nblocks[last].free_index = nblock->free_index;
+  nblock->free_index = PBNF_NO_NBLOCK;
+}
+
+// Termina a procura e acorda os trabalhadores à espera de nblocks
+static void a_star_pbnf_stop(a_star_pbnf_t* a_star)
+{
+  pthread_mutex_lock(&a_star->graph_lock);
+  atomic_store(&a_star->running, false);
+  pthread_cond_broadcast(&a_star->graph_cond);
+  pthread_mutex_unlock(&a_star->graph_lock);
+}
+
+// Liberta o nblock do trabalhador (se tiver um) e adquire o nblock livre com nós de menor custo, retorna
+// PBNF_NO_NBLOCK quando a procura terminou
+static size_t next_nblock(a_star_pbnf_worker_t* worker)
+{
+  a_star_pbnf_t* a_star = worker->a_star;
+
+  pthread_mutex_lock(&a_star->graph_lock);
+  if(worker->nblock != PBNF_NO_NBLOCK)
+  {
+    // Os nblocks que interferem com o nosso deixam de o ter em uso e podem ficar livres
+    a_star_nblock_t* released = &a_star->nblocks[worker->nblock];
+    released->in_use = false;
+    a_star->num_in_use--;
+    bool freed = add_free(a_star, worker->nblock);
+    for(size_t i = 0; i < released->num_interference; i++)
+    {
+      size_t index = a_star->interference[released->interference_start + i];
+      a_star->nblocks[index].sigma--;
+      freed |= add_free(a_star, index);
+    }
+    worker->nblock = PBNF_NO_NBLOCK;
+
+    if(freed)
+    {
+      update_best_free_cost(a_star);
+      pthread_cond_broadcast(&a_star->graph_cond);
+    }
+  }
+
+  while(atomic_load(&a_star->running))
+  {
+    if(a_star->num_free > 0)
+    {
+      // Escolhemos o nblock livre com o melhor nó
+      size_t best = a_star->free_nblocks[0];
+      for(size_t i = 1; i < a_star->num_free; i++)
+      {
+        if(nblock_top_cost(&a_star->nblocks[a_star->free_nblocks[i]]) < nblock_top_cost(&a_star->nblocks[best]))
+        {
+          best = a_star->free_nblocks[i];
+        }
+      }
+
+      // Os nblocks que interferem com o adquirido deixam de estar livres
+      a_star_nblock_t* acquired = &a_star->nblocks[best];
+      remove_free(a_star, best);
+      acquired->in_use = true;
+      a_star->num_in_use++;
+      for(size_t i = 0; i < acquired->num_interference; i++)
+      {
+        size_t index = a_star->interference[acquired->interference_start + i];
+        a_star->nblocks[index].sigma++;
+        remove_free(a_star, index);
+      }
+      update_best_free_cost(a_star);
+      pthread_mutex_unlock(&a_star->graph_lock);
+
+      worker->nblock = best;
+      worker->acquisitions++;
+      return best;
+    }
+
+    if(a_star->num_in_use == 0)
+    {
+      // Nenhum nblock tem nós abertos e nenhum trabalhador pode gerar mais
+      atomic_store(&a_star->running, false);
+      pthread_cond_broadcast(&a_star->graph_cond);
+      break;
+    }
+
+    // Esperamos que outro trabalhador liberte um nblock
+    pthread_cond_wait(&a_star->graph_cond, &a_star->graph_lock);
+  }
+  pthread_mutex_unlock(&a_star->graph_lock);
+
+  return PBNF_NO_NBLOCK;
+}
+
+// Verifica se o trabalhador deve trocar de nblock
+static bool should_switch(a_star_pbnf_worker_t* worker, int expansions)
+{
+  a_star_nblock_t* nblock = &worker->a_star->nblocks[worker->nblock];
+  int cost = nblock_top_cost(nblock);
+  if(cost == INT_MAX)
+  {
+    return true;
+  }
+
+  return expansions >= PBNF_MIN_EXPANSIONS && atomic_load(&worker->a_star->best_free_cost) < cost;
+}
+
+// Insere um nó nos nós abertos do seu nblock, o nblock pertence ao âmbito do trabalhador. Retorna falso se não
+// houver memória para os nós abertos do nblock
+static bool nblock_insert(a_star_pbnf_worker_t* worker, a_star_node_t* node)
+{
+  a_star_pbnf_t* a_star = worker->a_star;
+  a_star_nblock_t* nblock = &a_star->nblocks[a_star->abstraction.nblock_func(node->state)];
+
+  if(nblock->open_set == NULL)
+  {
+    nblock->open_set = min_heap_create(
+        a_star->common->options.open_set_type, a_star->common->options.tie_policy, offsetof(a_star_node_t, index_in_open_set));
+    if(nblock->open_set == NULL)
+    {
+      return false;
+    }
+  }
+
+  if(min_heap_insert(nblock->open_set, node->g + node->h, node->h, node) == SIZE_MAX)
+  {
+    return false;
+  }
+  if(nblock->open_set->size > worker->max_min_heap_size)
+  {
+    worker->max_min_heap_size = nblock->open_set->size;
+  }
+  return true;
+}
+
+// Atualiza o nó de um sucessor, o nó pertence ao âmbito do trabalhador e não precisa de mutexes
+static bool update_successor(a_star_pbnf_worker_t* worker, a_star_node_t* current_node, successor_t* neighbor)
+{
+  a_star_t* common = worker->a_star->common;
+  a_star_node_t* child_node = node_allocator_get(common->node_allocator, neighbor->state);
+  int g_attempt = current_node->g + a_star_successor_cost(common, current_node->state, neighbor);
+
+  if(child_node == NULL)
+  {
+    // Este nó ainda não existe, criamos um novo nó
+    child_node = node_allocator_new(common->node_allocator, neighbor->state);
+    child_node->parent = current_node;
+    child_node->g = g_attempt;
+    child_node->h = a_star_successor_h(common, current_node->h, neighbor);
+#ifdef STATS_GEN
+    search_data_add_entry(worker->thread_id, child_node->state, ACTION_SUCESSOR);
+#endif
+    worker->generated++;
+    worker->nodes_new++;
+    return nblock_insert(worker, child_node);
+  }
+
+  // Existe outro caminho igual ou mais curto para este nó
+  if(g_attempt >= child_node->g)
+  {
+    worker->paths_worst_or_equals++;
+    return true;
+  }
+
+  // O nó atual é o caminho mais curto para este vizinho, atualizamos
+  child_node->parent = current_node;
+  child_node->g = g_attempt;
+  worker->paths_better++;
+  if(child_node->index_in_open_set == SIZE_MAX)
+  {
+    worker->nodes_reinserted++;
+    return nblock_insert(worker, child_node);
+  }
+
+  a_star_nblock_t* nblock = &worker->a_star->nblocks[worker->a_star->abstraction.nblock_func(child_node->state)];
+  return min_heap_update_cost(nblock->open_set, child_node->index_in_open_set, g_attempt + child_node->h, child_node->h);
+}
+
+// Verifica se um nó já não pode levar a uma solução melhor do que a encontrada
+static bool a_star_pbnf_prune(a_star_pbnf_t* a_star, a_star_node_t* node)
+{
+  // A solução é protegida pelo lock, apenas o seu custo é publicado para os trabalhadores
+  int f_solution = atomic_load(&a_star->solution_cost);
+  return node->g + node->h > f_solution || node->g > f_solution;
+}
+
+// Regista um nó objetivo como solução, se for melhor do que a encontrada
+static void a_star_pbnf_set_solution(a_star_pbnf_worker_t* worker, a_star_node_t* node)
+{
+  a_star_pbnf_t* a_star = worker->a_star;
+
+  pthread_mutex_lock(&a_star->lock);
+  a_star->common->num_solutions++;
+  // O nó da solução pode continuar a ser atualizado por outros trabalhadores, comparamos com o custo publicado
+  int solution_cost = atomic_load(&a_star->solution_cost);
+  if(node->g < solution_cost)
+  {
+    a_star->common->num_better_solutions++;
+    a_star->common->solution = node;
+    atomic_store(&a_star->solution_cost, node->g);
+#ifdef STATS_GEN
+    a_star_node_t* solution_path = a_star->common->solution;
+    while(solution_path != NULL)
+    {
+      search_data_add_entry(worker->thread_id, solution_path->state, ACTION_GOAL);
+      solution_path = solution_path->parent;
+    }
+#endif
+  }
+  else if(node->g == solution_cost)
+  {
+    a_star->common->num_worst_solutions++;
+  }
+  pthread_mutex_unlock(&a_star->lock);
+
+  // Queremos apenas a primeira solução
+  if(a_star->stop_on_first_solution)
+  {
+    a_star_pbnf_stop(a_star);
+  }
+}
+
+// Função que implementa a lógica de um trabalhador
+static void* a_star_pbnf_worker_function(void* arg)
+{
+  a_star_pbnf_worker_t* worker = (a_star_pbnf_worker_t*)arg;
+  a_star_pbnf_t* a_star = worker->a_star;
+
+  // Reinicia as estatísticas para este trabalhador
+  worker->nblock = PBNF_NO_NBLOCK;
+  worker->generated = 0;
+  worker->expanded = 0;
+  worker->max_min_heap_size = 0;
+  worker->nodes_new = 0;
+  worker->nodes_reinserted = 0;
+  worker->paths_better = 0;
+  worker->paths_worst_or_equals = 0;
+  worker->acquisitions = 0;
+
+  // Este buffer recebe os vizinhos de um nó, é reutilizado em todas as expansões
+  successors_t* neighbors = successors_create(0);
+  if(neighbors == NULL)
+  {
+    a_star_pbnf_stop(a_star);
+    pthread_exit(NULL);
+  }
+
+  while(next_nblock(worker) != PBNF_NO_NBLOCK)
+  {
+    a_star_nblock_t* nblock = &a_star->nblocks[worker->nblock];
+    int expansions = 0;
+    while(atomic_load(&a_star->running) && !should_switch(worker, expansions))
+    {
+      a_star_node_t* current_node = (a_star_node_t*)min_heap_pop(nblock->open_set).data;
+      worker->expanded++;
+      expansions++;
+#ifdef STATS_GEN
+      search_data_add_entry(worker->thread_id, current_node->state, ACTION_VISITED);
+#endif
+
+      // Este nó não leva a uma solução melhor do que a encontrada
+      if(a_star_pbnf_prune(a_star, current_node))
+      {
+        continue;
+      }
+
+      if(a_star->common->goal_func(current_node->state, a_star->common->goal_state))
+      {
+        a_star_pbnf_set_solution(worker, current_node);
+        continue;
+      }
+
+      // Os sucessores pertencem ao âmbito do nblock, são atualizados sem mutexes
+      bool allocated = a_star->common->visit_func(current_node->state, a_star->common->state_allocator, neighbors);
+      for(size_t i = 0; i < neighbors->size && allocated; i++)
+      {
+        allocated = update_successor(worker, current_node, &neighbors->items[i]);
+      }
+      successors_clear(neighbors);
+      if(!allocated)
+      {
+        // Sem memória para os sucessores ou para os nós abertos de um nblock, a procura não pode continuar
+        atomic_store(&a_star->common->allocation_error, true);
+        a_star_pbnf_stop(a_star);
+      }
+    }
+  }
+
+  // Liberta o buffer de vizinhos
+  successors_destroy(neighbors);
+
+  pthread_exit(NULL);
+}
+
+// Adiciona um nblock às interferências do nblock indicado, marks evita repetições
+static bool add_interference(a_star_pbnf_t* a_star, size_t nblock, size_t other, size_t* marks, size_t* capacity)
+{
+  if(other == nblock || marks[other] == nblock)
+  {
+    return true;
+  }
+  marks[other] = nblock;
+
+  size_t size = a_star->nblocks[nblock].interference_start + a_star->nblocks[nblock].num_interference;
+  if(size == *capacity)
+  {
+    size_t* interference = (size_t*)realloc(a_star->interference, *capacity * 2 * sizeof(size_t));
+    if(interference == NULL)
+    {
+      return false;
+    }
+    a_star->interference = interference;
+    *capacity *= 2;
+  }
+
+  a_star->interference[size] = other;
+  a_star->nblocks[nblock].num_interference++;
+  return true;
+}
+
+// Constrói o grafo dos nblocks: dois nblocks interferem se os seus âmbitos de deteção de duplicados (o nblock e os
+// seus sucessores) se intersetam, ou seja, se um pertence ao âmbito do outro ou é predecessor de um nblock do
+// âmbito do outro
+static bool a_star_pbnf_build_graph(a_star_pbnf_t* a_star)
+{
+  size_t num_nblocks = a_star->abstraction.num_nblocks;
+  size_t* successors = (size_t*)malloc(num_nblocks * PBNF_MAX_NBLOCK_SUCCESSORS * sizeof(size_t));
+  size_t* num_successors = (size_t*)malloc(num_nblocks * sizeof(size_t));
+  size_t* predecessors_start = (size_t*)calloc(num_nblocks + 1, sizeof(size_t));
+  size_t* predecessors = (size_t*)malloc(num_nblocks * PBNF_MAX_NBLOCK_SUCCESSORS * sizeof(size_t));
+  size_t* marks = (size_t*)malloc(num_nblocks * sizeof(size_t));
+  size_t capacity = num_nblocks * PBNF_MAX_NBLOCK_SUCCESSORS;
+  a_star->interference = (size_t*)malloc(capacity * sizeof(size_t));
+  bool result = successors != NULL && num_successors != NULL && predecessors_start != NULL && predecessors != NULL &&
+                marks != NULL && a_star->interference != NULL;
+
+  if(result)
+  {
+    // Sucessores de cada nblock e contagem dos predecessores
+    for(size_t i = 0; i < num_nblocks; i++)
+    {
+      size_t* nblock_successors = &successors[i * PBNF_MAX_NBLOCK_SUCCESSORS];
+      num_successors[i] = a_star->abstraction.successors_func(a_star->abstraction.instance, i, nblock_successors);
+      for(size_t j = 0; j < num_successors[i]; j++)
+      {
+        predecessors_start[nblock_successors[j] + 1]++;
+      }
+      marks[i] = PBNF_NO_NBLOCK;
+    }
+
+    // Os predecessores de cada nblock ficam agrupados, marks serve de posição de escrita de cada grupo
+    for(size_t i = 0; i < num_nblocks; i++)
+    {
+      predecessors_start[i + 1] += predecessors_start[i];
+      marks[i] = predecessors_start[i];
+    }
+    for(size_t i = 0; i < num_nblocks; i++)
+    {
+      for(size_t j = 0; j < num_successors[i]; j++)
+      {
+        predecessors[marks[successors[i * PBNF_MAX_NBLOCK_SUCCESSORS + j]]++] = i;
+      }
+    }
+
+    for(size_t i = 0; i < num_nblocks; i++)
+    {
+      marks[i] = PBNF_NO_NBLOCK;
+    }
+  }
+
+  // Interferências de cada nblock: os nblocks do seu âmbito e os respetivos predecessores
+  size_t used = 0;
+  for(size_t i = 0; result && i < num_nblocks; i++)
+  {
+    a_star_nblock_t* nblock = &a_star->nblocks[i];
+    nblock->interference_start = used;
+    nblock->num_interference = 0;
+
+    for(size_t j = 0; result && j <= num_successors[i]; j++)
+    {
+      size_t scope = j == 0 ? i : successors[i * PBNF_MAX_NBLOCK_SUCCESSORS + j - 1];
+      result = add_interference(a_star, i, scope, marks, &capacity);
+      for(size_t k = predecessors_start[scope]; result && k < predecessors_start[scope + 1]; k++)
+      {
+        result = add_interference(a_star, i, predecessors[k], marks, &capacity);
+      }
+    }
+    used += nblock->num_interference;
+  }
+
+  free(predecessors);
+  free(predecessors_start);
+  free(num_successors);
+  free(successors);
+  free(marks);
+  return result;
+}
+
+// Cria uma nova instância para resolver um problema
+a_star_pbnf_t* a_star_pbnf_create(size_t struct_size,
+                                  goal_function goal_func,
+                                  visit_function visit_func,
+                                  heuristic_function h_func,
+                                  distance_function d_func,
+                                  print_function print_func,
+                                  int num_workers,
+                                  bool stop_on_first_solution,
+                                  const a_star_abstraction_t* abstraction,
+                                  const a_star_options_t* options)
+{
+  if(num_workers < 1 || abstraction == NULL || abstraction->num_nblocks == 0)
+  {
+    return NULL;
+  }
+
+  a_star_pbnf_t* a_star = (a_star_pbnf_t*)malloc(sizeof(a_star_pbnf_t));
+  if(a_star == NULL)
+  {
+    return NULL; // Erro de alocação
+  }
+
+  // Garante que a memória esteja limpa
+  a_star->common = NULL;
+  a_star->abstraction = *abstraction;
+  a_star->interference = NULL;
+  a_star->free_nblocks = NULL;
+  a_star->workers = NULL;
+  a_star->num_workers = num_workers;
+  a_star->num_free = 0;
+  a_star->num_in_use = 0;
+  atomic_init(&a_star->best_free_cost, INT_MAX);
+  atomic_init(&a_star->solution_cost, INT_MAX);
+  pthread_mutex_init(&a_star->graph_lock, NULL);
+  pthread_cond_init(&a_star->graph_cond, NULL);
+  pthread_mutex_init(&a_star->lock, NULL);
+
+  a_star->nblocks = (a_star_nblock_t*)calloc(abstraction->num_nblocks, sizeof(a_star_nblock_t));
+  if(a_star->nblocks == NULL)
+  {
+    a_star_pbnf_destroy(a_star);
+    return NULL;
+  }
+  for(size_t i = 0; i < abstraction->num_nblocks; i++)
+  {
+    a_star->nblocks[i].free_index = PBNF_NO_NBLOCK;
+  }
+
+  // Os nós compactos não suportam várias threads, os trabalhadores utilizam sempre os nós embutidos nos estados
+  a_star_options_t parallel_options;
+  if(options != NULL)
+  {
+    parallel_options = *options;
+  }
+  else
+  {
+    a_star_options_default(&parallel_options);
+  }
+  parallel_options.compact_nodes = false;
+
+  // Inicializamos a parte comum do nosso algoritmo
+  a_star->common = a_star_create(struct_size, goal_func, visit_func, h_func, d_func, print_func, &parallel_options);
+  a_star->free_nblocks = (size_t*)malloc(abstraction->num_nblocks * sizeof(size_t));
+  a_star->workers = (a_star_pbnf_worker_t*)calloc(a_star->num_workers, sizeof(a_star_pbnf_worker_t));
+  if(a_star->common == NULL || a_star->free_nblocks == NULL || a_star->workers == NULL || !a_star_pbnf_build_graph(a_star))
+  {
+    a_star_pbnf_destroy(a_star);
+    return NULL;
+  }
+
+  for(size_t i = 0; i < a_star->num_workers; i++)
+  {
+    a_star->workers[i].a_star = a_star;
+    a_star->workers[i].thread_id = i;
+    a_star->workers[i].nblock = PBNF_NO_NBLOCK;
+  }
+
+  a_star->stop_on_first_solution = stop_on_first_solution;
+  atomic_init(&a_star->running, false);
+
+  return a_star;
+}
+
+// Liberta uma instância do algoritmo
+void a_star_pbnf_destroy(a_star_pbnf_t* a_star)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  if(a_star->nblocks != NULL)
+  {
+    for(size_t i = 0; i < a_star->abstraction.num_nblocks; i++)
+    {
+      min_heap_destroy(a_star->nblocks[i].open_set);
+    }
+  }
+  free(a_star->nblocks);
+  free(a_star->interference);
+  free(a_star->free_nblocks);
+  free(a_star->workers);
+  a_star_destroy(a_star->common);
+  pthread_mutex_destroy(&a_star->graph_lock);
+  pthread_cond_destroy(&a_star->graph_cond);
+  pthread_mutex_destroy(&a_star->lock);
+  free(a_star);
+}
+
+// Prepara a instância para resolver outro problema
+void a_star_pbnf_reset(a_star_pbnf_t* a_star)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  // Nós que ficaram por expandir na resolução anterior
+  for(size_t i = 0; i < a_star->abstraction.num_nblocks; i++)
+  {
+    a_star_nblock_t* nblock = &a_star->nblocks[i];
+    if(nblock->open_set != NULL)
+    {
+      min_heap_clean(nblock->open_set);
+    }
+    nblock->sigma = 0;
+    nblock->in_use = false;
+    nblock->free_index = PBNF_NO_NBLOCK;
+  }
+  a_star->num_free = 0;
+  a_star->num_in_use = 0;
+  atomic_store(&a_star->best_free_cost, INT_MAX);
+  atomic_store(&a_star->solution_cost, INT_MAX);
+  a_star_reset(a_star->common);
+}
+
+// Resolve o problema
+void a_star_pbnf_solve(a_star_pbnf_t* a_star, void* initial, void* goal)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  // Guarda os nossos estados inicial e objetivo
+  state_t* initial_state = state_allocator_new(a_star->common->state_allocator, initial);
+  if(initial_state == NULL)
+  {
+    return;
+  }
+
+  // Preparamos o nosso objetivo caso tenha sido passado (existem problemas em que não se passam soluções)
+  if(goal)
+  {
+    a_star->common->goal_state = state_allocator_new(a_star->common->state_allocator, goal);
+    if(a_star->common->goal_state == NULL)
+    {
+      return;
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &(a_star->common->start_time));
+#ifdef STATS_GEN
+  search_data_start();
+#endif
+
+  // O nó inicial é colocado no seu nblock, que fica livre para o primeiro trabalhador
+  a_star_node_t* initial_node = node_allocator_new(a_star->common->node_allocator, initial_state);
+  initial_node->g = 0;
+  initial_node->h = a_star->common->h_func(initial_state, a_star->common->goal_state);
+  if(!nblock_insert(&a_star->workers[0], initial_node))
+  {
+    return;
+  }
+  add_free(a_star, a_star->abstraction.nblock_func(initial_state));
+  update_best_free_cost(a_star);
+
+  atomic_store(&a_star->running, true);
+  size_t started = 0;
+  for(; started < a_star->num_workers; started++)
+  {
+    if(pthread_create(&a_star->workers[started].thread, NULL, a_star_pbnf_worker_function, &a_star->workers[started]) != 0)
+    {
+      // Os trabalhadores já iniciados continuam a procura
+      break;
+    }
+  }
+  if(started == 0)
+  {
+    atomic_store(&a_star->running, false);
+    return;
+  }
+
+#ifdef STATS_GEN
+  // O tempo das entradas registadas pelos trabalhadores avança com o coordenador
+  struct timespec tick = { 0, 100000 };
+  while(atomic_load(&a_star->running))
+  {
+    search_data_tick();
+    nanosleep(&tick, NULL);
+  }
+#endif
+  for(size_t i = 0; i < started; i++)
+  {
+    pthread_join(a_star->workers[i].thread, NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &(a_star->common->end_time));
+
+  // Calculamos o tempo de execução e outras estatísticas
+  a_star_measure_memory(a_star->common);
+  a_star->common->memory.open_set.reserved += a_star->abstraction.num_nblocks * sizeof(a_star_nblock_t);
+  for(size_t i = 0; i < a_star->abstraction.num_nblocks; i++)
+  {
+    if(a_star->nblocks[i].open_set != NULL)
+    {
+      min_heap_memory(a_star->nblocks[i].open_set, &a_star->common->memory.open_set);
+    }
+  }
+  for(size_t i = 0; i < started; i++)
+  {
+    a_star_pbnf_worker_t* worker = &a_star->workers[i];
+    a_star->common->expanded += worker->expanded;
+    a_star->common->generated += worker->generated;
+    a_star->common->max_min_heap_size += worker->max_min_heap_size;
+    a_star->common->nodes_new += worker->nodes_new;
+    a_star->common->nodes_reinserted += worker->nodes_reinserted;
+    a_star->common->paths_better += worker->paths_better;
+    a_star->common->paths_worst_or_equals += worker->paths_worst_or_equals;
+  }
+  a_star->common->execution_time = (a_star->common->end_time.tv_sec - a_star->common->start_time.tv_sec);
+  a_star->common->execution_time += (a_star->common->end_time.tv_nsec - a_star->common->start_time.tv_nsec) / 1000000000.0;
+}
+
+// Imprime estatísticas do algoritmo no formato desejado
+void a_star_pbnf_print_statistics(a_star_pbnf_t* a_star, bool csv, bool show_solution)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  if(show_solution)
+  {
+    a_star_print_statistics(a_star->common, csv, true);
+    return;
+  }
+
+  if(!csv)
+  {
+    if(a_star->stop_on_first_solution)
+    {
+      printf("Método: Primeira solução (PBNF)\n");
+    }
+    else
+    {
+      printf("Método: Melhor solução (PBNF)\n");
+    }
+  }
+
+  a_star_print_statistics(a_star->common, csv, false);
+
+  if(!csv)
+  {
+    size_t acquisitions = 0;
+    size_t used = 0;
+    for(size_t i = 0; i < a_star->num_workers; i++)
+    {
+      acquisitions += a_star->workers[i].acquisitions;
+    }
+    for(size_t i = 0; i < a_star->abstraction.num_nblocks; i++)
+    {
+      used += a_star->nblocks[i].open_set != NULL;
+    }
+    printf("nblocks: %zu (%zu com nós), Aquisições de nblocks: %zu\n", a_star->abstraction.num_nblocks, used, acquisitions);
+
+    printf("Estatísticas Trabalhadores:\n");
+    for(size_t i = 0; i < a_star->num_workers; i++)
+    {
+      a_star_pbnf_worker_t* worker = &a_star->workers[i];
+      printf("- Trabalhador #%ld\n", i + 1);
+      printf("  * Estados gerados: %d, Estados expandidos: %d, nblocks adquiridos: %zu\n",
+             worker->generated,
+             worker->expanded,
+             worker->acquisitions);
+      printf("  * Max nós min_heap: %ld, Novos nós: %d, Nós reinseridos: %d, Caminhos piores (ignorados): %d, Caminhos "
+             "melhores (atualizados): %d\n",
+             worker->max_min_heap_size,
+             worker->nodes_new,
+             worker->nodes_reinserted,
+             worker->paths_worst_or_equals,
+             worker->paths_better);
+    }
+  }
+}
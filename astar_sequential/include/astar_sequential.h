@@ -21,17 +21,21 @@ struct a_star_sequential_t
   min_heap_t* open_set;
 };
 
-// Cria uma nova instância do algoritmo A* sequencial para resolver um problema
+// Cria uma nova instância do algoritmo A* sequencial para resolver um problema, options pode ser NULL
 a_star_sequential_t* a_star_sequential_create(size_t struct_size,
                                               goal_function goal_func,
                                               visit_function visit_func,
                                               heuristic_function h_func,
                                               distance_function d_func,
-                                              print_function print_func);
+                                              print_function print_func,
+                                              const a_star_options_t* options);
 
 // Liberta uma instância do algoritmo A* sequencial
 void a_star_sequential_destroy(a_star_sequential_t* a_star);
 
+// Prepara a instância para resolver outro problema, a memória já alocada é reutilizada
+void a_star_sequential_reset(a_star_sequential_t* a_star);
+
 // Resolve o problema através do uso do algoritmo A* sequencial
 void a_star_sequential_solve(a_star_sequential_t* a_star, void* initial, void* goal);
 
@@ -1,4 +1,5 @@
 #include "astar_sequential.h"
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,7 +13,8 @@ a_star_sequential_t* a_star_sequential_create(size_t struct_size,
                                               visit_function visit_func,
                                               heuristic_function h_func,
                                               distance_function d_func,
-                                              print_function print_func)
+                                              print_function print_func,
+                                              const a_star_options_t* options)
 {
   a_star_sequential_t* a_star = (a_star_sequential_t*)malloc(sizeof(a_star_sequential_t));
   if(a_star == NULL)
@@ -25,7 +27,7 @@ a_star_sequential_t* a_star_sequential_create(size_t struct_size,
   a_star->common = NULL;
 
   // Inicializamos a parte comum do nosso algoritmo
-  a_star->common = a_star_create(struct_size, goal_func, visit_func, h_func, d_func, print_func);
+  a_star->common = a_star_create(struct_size, goal_func, visit_func, h_func, d_func, print_func, options);
 
   if(a_star->common == NULL)
   {
@@ -33,13 +35,21 @@ a_star_sequential_t* a_star_sequential_create(size_t struct_size,
     return NULL;
   }
 
-  // Conjunto com os nós por explorar
-  a_star->open_set = min_heap_create();
+  // Conjunto com os nós por explorar, o heap mantém a posição de cada nó atualizada (no próprio nó ou, com
+  // nós compactos, no array de posições)
+  bool compact = a_star->common->node_store != NULL;
+  a_star->open_set = min_heap_create(a_star->common->options.open_set_type,
+                                     a_star->common->options.tie_policy,
+                                     compact ? MIN_HEAP_NO_INDEX : offsetof(a_star_node_t, index_in_open_set));
   if(a_star->open_set == NULL)
   {
     a_star_sequential_destroy(a_star);
     return NULL;
   }
+  if(compact)
+  {
+    min_heap_set_positions(a_star->open_set, &a_star->common->node_store->open_index);
+  }
 
   return a_star;
 }
@@ -62,6 +72,202 @@ void a_star_sequential_destroy(a_star_sequential_t* a_star)
   free(a_star);
 }
 
+// Prepara a instância para resolver outro problema
+void a_star_sequential_reset(a_star_sequential_t* a_star)
+{
+  if(a_star == NULL)
+  {
+    return;
+  }
+
+  // Nós que ficaram por explorar na resolução anterior
+  min_heap_clean(a_star->open_set);
+
+  a_star_reset(a_star->common);
+}
+
+// Atualiza a árvore de procura com um sucessor do nó expandido. Retorna falso se não for possível inserir o nó
+// nos nós abertos
+static bool update_successor(a_star_sequential_t* a_star, a_star_node_t* current_node, successor_t* neighbor)
+{
+  a_star_t* common = a_star->common;
+
+  // Verifica se o nó para este estado já se encontra na nossa lista de nós
+  a_star_node_t* child_node = node_allocator_get(common->node_allocator, neighbor->state);
+
+  if(!child_node)
+  {
+    // Este nó ainda não existe, criamos um novo nó
+    child_node = node_allocator_new(common->node_allocator, neighbor->state);
+    child_node->parent = current_node;
+#ifdef STATS_GEN
+    search_data_add_entry(0, child_node->state, ACTION_SUCESSOR);
+#endif
+    // Encontra o custo de chegar do nó a este vizinho e calcula a heurística para chegar ao objetivo
+    // (apenas se a função de visita não os forneceu)
+    child_node->g = current_node->g + a_star_successor_cost(common, current_node->state, neighbor);
+    child_node->h = a_star_successor_h(common, current_node->h, neighbor);
+
+    // Calculamos o custo
+    int cost = child_node->g + child_node->h;
+
+    // Inserimos o nó na nossa fila
+    if(min_heap_insert(a_star->open_set, cost, child_node->h, child_node) == SIZE_MAX)
+    {
+      return false;
+    }
+    common->generated++;
+    common->nodes_new++;
+  }
+  else
+  {
+    // Encontra o custo de chegar do nó a este vizinho
+    int g_attempt = current_node->g + a_star_successor_cost(common, current_node->state, neighbor);
+
+    // Se o custo for maior do que o nó já tem, não faz sentido atualizar
+    // existe outro caminho mais curto para este nó
+    if(g_attempt >= child_node->g)
+    {
+      common->paths_worst_or_equals++;
+      return true;
+    }
+
+    // O nó atual é o caminho mais curto para este vizinho, atualizamos
+    child_node->parent = current_node;
+
+    // Atualizamos os parâmetros do nó, a heurística depende apenas do estado e não muda
+    child_node->g = g_attempt;
+
+    // Calculamos o novo custo
+    int cost = child_node->g + child_node->h;
+
+    common->paths_better++;
+    if(child_node->index_in_open_set == SIZE_MAX)
+    {
+      // Inserimos o nó na nossa fila novamente
+      if(min_heap_insert(a_star->open_set, cost, child_node->h, child_node) == SIZE_MAX)
+      {
+        return false;
+      }
+      common->nodes_reinserted++;
+    }
+    else if(!min_heap_update_cost(a_star->open_set, child_node->index_in_open_set, cost, child_node->h))
+    {
+      // Sem memória para a nova posição o nó saiu da nossa fila prioritária
+      return false;
+    }
+  }
+  return true;
+}
+
+// Atualiza a árvore de procura com um sucessor do nó expandido, com nós compactos. Retorna falso se não for
+// possível alocar o nó ou inseri-lo nos nós abertos
+static bool update_successor_compact(a_star_sequential_t* a_star, node_id_t current_id, successor_t* neighbor)
+{
+  a_star_t* common = a_star->common;
+  node_store_t* store = common->node_store;
+
+  // O identificador do nó é obtido a partir do registo do estado, sem memória para os arrays dos nós a
+  // procura não pode continuar
+  node_id_t child_id = node_store_id(store, neighbor->state);
+  if(child_id == NODE_NONE)
+  {
+    return false;
+  }
+  state_t* current_state = node_store_state(store, current_id);
+
+  if(!node_store_exists(store, child_id))
+  {
+    // Este nó ainda não existe, criamos um novo nó
+    store->parent[child_id] = current_id;
+#ifdef STATS_GEN
+    search_data_add_entry(0, neighbor->state, ACTION_SUCESSOR);
+#endif
+    store->g[child_id] = store->g[current_id] + a_star_successor_cost(common, current_state, neighbor);
+    store->h[child_id] = a_star_successor_h(common, store->h[current_id], neighbor);
+    store->open_index[child_id] = UINT32_MAX;
+
+    // Inserimos o nó na nossa fila, os dados do elemento são o identificador
+    int cost = store->g[child_id] + store->h[child_id];
+    if(min_heap_insert(a_star->open_set, cost, store->h[child_id], (void*)(uintptr_t)child_id) == SIZE_MAX)
+    {
+      return false;
+    }
+    common->generated++;
+    common->nodes_new++;
+  }
+  else
+  {
+    int g_attempt = store->g[current_id] + a_star_successor_cost(common, current_state, neighbor);
+
+    // Existe outro caminho mais curto para este nó
+    if(g_attempt >= store->g[child_id])
+    {
+      common->paths_worst_or_equals++;
+      return true;
+    }
+
+    // O nó atual é o caminho mais curto para este vizinho, atualizamos
+    store->parent[child_id] = current_id;
+    store->g[child_id] = g_attempt;
+    int cost = g_attempt + store->h[child_id];
+
+    common->paths_better++;
+    if(store->open_index[child_id] == UINT32_MAX)
+    {
+      if(min_heap_insert(a_star->open_set, cost, store->h[child_id], (void*)(uintptr_t)child_id) == SIZE_MAX)
+      {
+        return false;
+      }
+      common->nodes_reinserted++;
+    }
+    else if(!min_heap_update_cost(a_star->open_set, store->open_index[child_id], cost, store->h[child_id]))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Estado de um elemento do conjunto de nós abertos (um nó ou, com nós compactos, um identificador)
+static inline state_t* open_state(a_star_sequential_t* a_star, void* data)
+{
+  if(a_star->common->node_store != NULL)
+  {
+    return node_store_state(a_star->common->node_store, (node_id_t)(uintptr_t)data);
+  }
+  return ((a_star_node_t*)data)->state;
+}
+
+// Insere o nó do estado inicial no conjunto de nós abertos, retorna falso em caso de erro de alocação
+static bool insert_initial(a_star_sequential_t* a_star, state_t* initial_state)
+{
+  a_star_t* common = a_star->common;
+  int h = common->h_func(initial_state, common->goal_state);
+
+  if(common->node_store != NULL)
+  {
+    node_store_t* store = common->node_store;
+    node_id_t id = node_store_id(store, initial_state);
+    if(id == NODE_NONE)
+    {
+      return false;
+    }
+    store->g[id] = 0;
+    store->h[id] = h;
+    store->parent[id] = NODE_NONE;
+    store->open_index[id] = UINT32_MAX;
+    return min_heap_insert(a_star->open_set, h, h, (void*)(uintptr_t)id) != SIZE_MAX;
+  }
+
+  a_star_node_t* initial_node = node_allocator_new(common->node_allocator, initial_state);
+
+  // Atribui ao nó inicial um custo total de 0
+  initial_node->g = 0;
+  initial_node->h = h;
+  return min_heap_insert(a_star->open_set, initial_node->g + initial_node->h, initial_node->h, initial_node) != SIZE_MAX;
+}
+
 // Resolve o problema através do uso do algoritmo A*;
 void a_star_sequential_solve(a_star_sequential_t* a_star, void* initial, void* goal)
 {
@@ -92,17 +298,35 @@ void a_star_sequential_solve(a_star_sequential_t* a_star, void* initial, void* g
     return;
   }
 
-  a_star_node_t* initial_node = node_allocator_new(a_star->common->node_allocator, initial_state);
-
-  // Atribui ao nó inicial um custo total de 0
-  initial_node->g = 0;
-  initial_node->h = a_star->common->h_func(initial_node->state, a_star->common->goal_state);
-
   // Inserimos o nó inicial na nossa fila prioritária
-  min_heap_insert(a_star->open_set, initial_node->g + initial_node->h, initial_node);
+  if(!insert_initial(a_star, initial_state))
+  {
+    atomic_store(&a_star->common->allocation_error, true);
+    return;
+  }
 
-  // Esta lista irá receber os vizinhos de um nó
-  linked_list_t* neighbors = linked_list_create();
+  // Este buffer irá receber os vizinhos de um nó, é reutilizado em todas as expansões
+  successors_t* neighbors = successors_create(0);
+  if(neighbors == NULL)
+  {
+    return;
+  }
+
+  // Nós expandidos em conjunto e o fim dos seus sucessores no buffer, com staging os sucessores só são obtidos
+  // depois de visitar todos os nós do conjunto
+  size_t batch = a_star->common->options.expansion_batch;
+  neighbors->staging = batch > 0;
+  if(batch == 0)
+  {
+    batch = 1;
+  }
+  else if(batch > A_STAR_MAX_EXPANSION_BATCH)
+  {
+    // Os buffers do conjunto estão na stack, o tamanho é limitado
+    batch = A_STAR_MAX_EXPANSION_BATCH;
+  }
+  void* batch_nodes[batch];
+  size_t batch_ends[batch];
 
   clock_gettime(CLOCK_MONOTONIC, &(a_star->common->start_time));
 #ifdef STATS_GEN
@@ -110,110 +334,102 @@ void a_star_sequential_solve(a_star_sequential_t* a_star, void* initial, void* g
 #endif
   while(a_star->open_set->size)
   {
-#ifdef STATS_GEN
-    search_data_tick();
-#endif
-    if(a_star->common->max_min_heap_size < a_star->open_set->size)
-      a_star->common->max_min_heap_size = a_star->open_set->size;
+    size_t batch_size = 0;
+    int batch_cost = min_heap_top_cost(a_star->open_set);
 
-    // A seguinte operação pode ocorrer em O(log(N))
-    // se nosAbertos é um min-heap ou uma queue prioritária
-    heap_node_t top_element = min_heap_pop(a_star->open_set);
-
-    // Nó atual na nossa árvore
-    a_star_node_t* current_node = (a_star_node_t*)top_element.data;
-    current_node->index_in_open_set = SIZE_MAX;
-    a_star->common->expanded++;
-#ifdef STATS_GEN
-    search_data_add_entry(0, current_node->state, ACTION_VISITED);
-#endif
-    // Se encontramos o objetivo saímos e retornamos o nó
-    if(a_star->common->goal_func(current_node->state, a_star->common->goal_state))
+    // Retiramos os nós do conjunto, todos com o custo mínimo (a ordem entre eles não altera o resultado)
+    while(batch_size < batch && a_star->open_set->size && min_heap_top_cost(a_star->open_set) == batch_cost)
     {
-      // Guardamos a solução e saímos do ciclo
-      a_star->common->num_solutions = a_star->common->num_better_solutions = 1;
-      a_star->common->solution = current_node;
 #ifdef STATS_GEN
-      a_star_node_t* solution_path = a_star->common->solution;
-      while(solution_path != NULL)
-      {
-        search_data_add_entry(0, solution_path->state, ACTION_GOAL);
-        solution_path = solution_path->parent;
-      }
+      search_data_tick();
 #endif
-      break;
-    }
-    // Executa a função que visita os vizinhos deste nó
-    a_star->common->visit_func(current_node->state, a_star->common->state_allocator, neighbors);
-    // Itera por todos os vizinhos gerados e atualiza a nossa árvore de procura
-    while(linked_list_size(neighbors))
-    {
-      state_t* neighbor = (state_t*)linked_list_pop_back(neighbors);
+      if(a_star->common->max_min_heap_size < a_star->open_set->size)
+        a_star->common->max_min_heap_size = a_star->open_set->size;
 
-      // Verifica se o nó para este estado já se encontra na nossa lista de nós
-      a_star_node_t* child_node = node_allocator_get(a_star->common->node_allocator, neighbor);
+      // A seguinte operação pode ocorrer em O(log(N))
+      // se nosAbertos é um min-heap ou uma queue prioritária
+      heap_node_t top_element = min_heap_pop(a_star->open_set);
 
-      if(!child_node)
-      {
-        // Este nó ainda não existe, criamos um novo nó
-        child_node = node_allocator_new(a_star->common->node_allocator, neighbor);
-        child_node->parent = current_node;
+      // Nó atual na nossa árvore (o heap já marcou o nó como fora do open_set)
+      state_t* current_state = open_state(a_star, top_element.data);
+      a_star->common->expanded++;
 #ifdef STATS_GEN
-        search_data_add_entry(0, child_node->state, ACTION_SUCESSOR);
+      search_data_add_entry(0, current_state, ACTION_VISITED);
 #endif
-        // Encontra o custo de chegar do nó a este vizinho e calcula a heurística para chegar ao objetivo
-        child_node->g = current_node->g + a_star->common->d_func(current_node->state, child_node->state);
-        child_node->h = a_star->common->h_func(child_node->state, a_star->common->goal_state);
-
-        // Calculamos o custo
-        int cost = child_node->g + child_node->h;
-
-        // Inserimos o nó na nossa fila
-        child_node->index_in_open_set = min_heap_insert(a_star->open_set, cost, child_node);
-        a_star->common->generated++;
-        a_star->common->nodes_new++;
-      }
-      else
+      // Se encontramos o objetivo saímos e retornamos o nó
+      if(a_star->common->goal_func(current_state, a_star->common->goal_state))
       {
-        // Encontra o custo de chegar do nó a este vizinho
-        int g_attempt = current_node->g + a_star->common->d_func(current_node->state, child_node->state);
-
-        // Se o custo for maior do que o nó já tem, não faz sentido atualizar
-        // existe outro caminho mais curto para este nó
-        if(g_attempt >= child_node->g)
+        // Guardamos a solução e saímos do ciclo
+        a_star->common->num_solutions = a_star->common->num_better_solutions = 1;
+        if(a_star->common->node_store == NULL)
         {
-          a_star->common->paths_worst_or_equals++;
-          continue;
+          a_star->common->solution = (a_star_node_t*)top_element.data;
         }
+        else if(!a_star_set_compact_solution(a_star->common, (node_id_t)(uintptr_t)top_element.data))
+        {
+          // O caminho é copiado para nós normais, sem memória a solução fica por guardar e a procura termina
+          atomic_store(&a_star->common->allocation_error, true);
+        }
+#ifdef STATS_GEN
+        a_star_node_t* solution_path = a_star->common->solution;
+        while(solution_path != NULL)
+        {
+          search_data_add_entry(0, solution_path->state, ACTION_GOAL);
+          solution_path = solution_path->parent;
+        }
+#endif
+        break;
+      }
+      // Executa a função que visita os vizinhos deste nó
+      if(!a_star->common->visit_func(current_state, a_star->common->state_allocator, neighbors))
+      {
+        atomic_store(&a_star->common->allocation_error, true);
+        break;
+      }
+      batch_nodes[batch_size] = top_element.data;
+      batch_ends[batch_size++] = neighbors->size;
+    }
 
-        // O nó atual é o caminho mais curto para este vizinho, atualizamos
-        child_node->parent = current_node;
-
-        // Atualizamos os parâmetros do nó
-        child_node->g = g_attempt;
-        child_node->h = a_star->common->h_func(child_node->state, a_star->common->goal_state);
+    if(a_star->common->num_solutions || atomic_load(&a_star->common->allocation_error))
+    {
+      break;
+    }
 
-        // Calculamos o novo custo
-        int cost = child_node->g + child_node->h;
+    // Obtém os estados de todos os vizinhos, os acessos à hashtable foram antecipados durante as visitas
+    bool allocated = successors_resolve(neighbors, a_star->common->state_allocator);
 
-        a_star->common->paths_better++;
-        if(child_node->index_in_open_set == SIZE_MAX)
+    // Itera por todos os vizinhos gerados e atualiza a nossa árvore de procura
+    size_t i = 0;
+    for(size_t n = 0; n < batch_size && allocated; n++)
+    {
+      for(; i < batch_ends[n] && allocated; i++)
+      {
+        if(a_star->common->node_store != NULL)
         {
-          // Inserimos o nó na nossa fila novamente
-          child_node->index_in_open_set = min_heap_insert(a_star->open_set, cost, child_node);
-          a_star->common->nodes_reinserted++;
+          allocated = update_successor_compact(a_star, (node_id_t)(uintptr_t)batch_nodes[n], &neighbors->items[i]);
         }
         else
         {
-          // Atualizamos a nossa fila prioritária
-          min_heap_update_cost(a_star->open_set, child_node->index_in_open_set, cost);
+          allocated = update_successor(a_star, (a_star_node_t*)batch_nodes[n], &neighbors->items[i]);
         }
       }
     }
+    successors_clear(neighbors);
+
+    // Erro de alocação, a procura termina sem solução
+    if(!allocated)
+    {
+      atomic_store(&a_star->common->allocation_error, true);
+      break;
+    }
   }
 
-  // Liberta a lista de vizinhos
-  linked_list_destroy(neighbors);
+  // Liberta o buffer de vizinhos
+  successors_destroy(neighbors);
+
+  // Memória utilizada, os nós abertos que restam ainda ocupam o heap
+  a_star_measure_memory(a_star->common);
+  min_heap_memory(a_star->open_set, &a_star->common->memory.open_set);
 
   clock_gettime(CLOCK_MONOTONIC, &(a_star->common->end_time));
   // Calculamos o tempo de execução
@@ -1,8 +1,9 @@
 #ifndef LOGIC_H
 #define LOGIC_H
 #include "maze_common.h"
-#include "linked_list.h"
+#include "successors.h"
 #include "state.h"
+#include <stdint.h>
 #ifdef STATS_GEN
 #include "search_data.h"
 #endif
@@ -16,12 +17,28 @@ typedef struct
 
 int heuristic(const state_t*, const state_t*);
 
-void visit(state_t*, state_allocator_t*, linked_list_t*);
+// Retorna falso se não for possível alocar os sucessores
+bool visit(state_t*, state_allocator_t*, successors_t*);
 
 bool goal(const state_t*, const state_t*);
 
 int distance(const state_t*, const state_t*);
 
+// Hash de Zobrist abstrato para atribuir os estados aos trabalhadores: o labirinto é dividido em blocos de
+// OWNER_BLOCK_SIZE x OWNER_BLOCK_SIZE posições e apenas o bloco conta, os movimentos dentro do bloco mantêm o
+// estado no mesmo trabalhador
+uint64_t owner(const state_t*);
+
+// Abstração para o algoritmo PBNF: o labirinto é dividido numa grelha de no máximo NBLOCK_GRID x NBLOCK_GRID
+// blocos (nblocks), os sucessores de um nblock são os nblocks vizinhos na grelha
+size_t nblock(const state_t*);
+
+// Número de nblocks do labirinto
+size_t nblock_count(const maze_solver_t*);
+
+// Preenche os nblocks vizinhos de um nblock (instance é o maze_solver_t) e retorna quantos são
+size_t nblock_successors(const void* instance, size_t nblock, size_t* successors);
+
 #ifdef STATS_GEN
 size_t maze_serialize_function(char*, const search_data_entry_t*);
 #endif
@@ -1,4 +1,6 @@
+#include "astar_multi_queue.h"
 #include "astar_parallel.h"
+#include "astar_pbnf.h"
 #include "astar_sequential.h"
 #include "maze_logic.h"
 #include <stdio.h>
@@ -92,11 +94,24 @@ void print_solution(a_star_node_t* solution)
 }
 
 // Resolve o problema utilizando a versão paralela do algoritmo
-void solve_parallel(maze_solver_t* maze_solver, int num_threads, bool first, bool csv, bool show_solution)
+void solve_parallel(maze_solver_t* maze_solver,
+                    int num_threads,
+                    bool first,
+                    bool csv,
+                    bool show_solution,
+                    bool abstract_owner,
+                    const a_star_options_t* options)
 {
   // Criamos a instância do algoritmo A*
-  a_star_parallel_t* a_star =
-      a_star_parallel_create(sizeof(maze_solver_state_t), goal, visit, heuristic, distance, print_solution, num_threads, first);
+  a_star_parallel_t* a_star = a_star_parallel_create(
+      sizeof(maze_solver_state_t), goal, visit, heuristic, distance, print_solution, num_threads, first, options);
+
+  // Os estados são atribuídos aos trabalhadores pelo hash abstrato do problema
+  if(abstract_owner)
+  {
+    a_star_parallel_set_owner(a_star, owner);
+  }
+
   // Criamos o nosso estado inicial para lançar o algoritmo
   maze_solver_state_t initial = { maze_solver, maze_solver->entry_coord };
   // Tentamos resolver o problema
@@ -111,12 +126,67 @@ void solve_parallel(maze_solver_t* maze_solver, int num_threads, bool first, boo
   a_star_parallel_destroy(a_star);
 }
 
+// Resolve o problema utilizando a versão paralela com fronteira partilhada (MultiQueue) do algoritmo
+void solve_multi_queue(maze_solver_t* maze_solver,
+                       int num_threads,
+                       bool first,
+                       bool csv,
+                       bool show_solution,
+                       const a_star_options_t* options)
+{
+  // Criamos a instância do algoritmo A*
+  a_star_multi_queue_t* a_star = a_star_multi_queue_create(
+      sizeof(maze_solver_state_t), goal, visit, heuristic, distance, print_solution, num_threads, first, options);
+
+  // Criamos o nosso estado inicial para lançar o algoritmo
+  maze_solver_state_t initial = { maze_solver, maze_solver->entry_coord };
+  // Tentamos resolver o problema
+  a_star_multi_queue_solve(a_star, &initial, NULL);
+#ifdef STATS_GEN
+  search_data_print();
+#else
+  // Imprime as estatísticas da execução
+  a_star_multi_queue_print_statistics(a_star, csv, show_solution);
+#endif
+  // Limpamos a memória
+  a_star_multi_queue_destroy(a_star);
+}
+
+// Resolve o problema utilizando a versão paralela Best-NBlock-First (PBNF) do algoritmo
+void solve_pbnf(maze_solver_t* maze_solver,
+                int num_threads,
+                bool first,
+                bool csv,
+                bool show_solution,
+                const a_star_options_t* options)
+{
+  // Os estados são divididos em nblocks por uma grelha sobre o labirinto
+  a_star_abstraction_t abstraction = { maze_solver, nblock_count(maze_solver), nblock, nblock_successors };
+
+  // Criamos a instância do algoritmo A*
+  a_star_pbnf_t* a_star = a_star_pbnf_create(
+      sizeof(maze_solver_state_t), goal, visit, heuristic, distance, print_solution, num_threads, first, &abstraction, options);
+
+  // Criamos o nosso estado inicial para lançar o algoritmo
+  maze_solver_state_t initial = { maze_solver, maze_solver->entry_coord };
+  // Tentamos resolver o problema
+  a_star_pbnf_solve(a_star, &initial, NULL);
+#ifdef STATS_GEN
+  search_data_print();
+#else
+  // Imprime as estatísticas da execução
+  a_star_pbnf_print_statistics(a_star, csv, show_solution);
+#endif
+  // Limpamos a memória
+  a_star_pbnf_destroy(a_star);
+}
+
 // Resolve o problema utilizando a versão sequencial do algoritmo
-void solve_sequential(maze_solver_t* maze_solver, bool csv, bool show_solution)
+void solve_sequential(maze_solver_t* maze_solver, bool csv, bool show_solution, const a_star_options_t* options)
 {
   // Criamos a instância do algoritmo A*
   a_star_sequential_t* a_star =
-      a_star_sequential_create(sizeof(maze_solver_state_t), goal, visit, heuristic, distance, print_solution);
+      a_star_sequential_create(sizeof(maze_solver_state_t), goal, visit, heuristic, distance, print_solution, options);
   // Criamos o nosso estado inicial para lançar o algoritmo
   maze_solver_state_t initial = { maze_solver, maze_solver->entry_coord };
   // Tentamos resolver o problema
@@ -136,11 +206,33 @@ int main(int argc, char* argv[])
   // Verificar se o nome do arquivo foi fornecido como argumento
   if(argc < 2)
   {
-    printf("Uso: %s [-n <num. trabalhadores>] [-p] [-r] <ficheiro_instâncias>\n", argv[0]);
+    printf("Uso: %s [-n <num. trabalhadores>] [-p] [-r] [-s] [-q <tipo>] [-t <política>] [-b <nós>] [-c] [-o <mensagens>] "
+           "[-e <expansões>] [-z] [-w <nós>] [-m] [-a] <ficheiro_instâncias>\n",
+           argv[0]);
     printf("Opções:\n");
     printf("-n : Número de trabalhadores (threads), defeito: 0 (algoritmo sequencial)\n");
     printf("-p : Termina à primeira solução encontrada, defeito: falso (utilizado no algoritmo paralelo apenas)\n");
     printf("-r : Relatório em formato compatível com CSV \n");
+    printf("-s : Imprime a solução encontrada\n");
+    printf("-q : Estrutura dos nós abertos (binary, 4ary, 8ary ou bucket), defeito: 4ary\n");
+    printf("-t : Desempate dos nós abertos com o mesmo custo (none, high-g, low-h ou lifo), defeito: high-g\n");
+    printf("-b : Nós com o mesmo custo expandidos em conjunto, com os acessos aos sucessores antecipados, defeito: 0 "
+           "(um nó de cada vez, máximo %d, utilizado no algoritmo sequencial apenas)\n",
+           A_STAR_MAX_EXPANSION_BATCH);
+    printf("-c : Nós compactos (arrays indexados por 32 bits), reduz a memória por estado, defeito: falso "
+           "(utilizado no algoritmo sequencial apenas)\n");
+    printf("-o : Mensagens guardadas para cada trabalhador antes de serem enviadas num bloco, defeito: 64 "
+           "(utilizado no algoritmo paralelo apenas)\n");
+    printf("-e : Expansões após as quais as mensagens guardadas são enviadas, defeito: 16, 0 não limita "
+           "(utilizado no algoritmo paralelo apenas)\n");
+    printf("-z : Atribui os estados aos trabalhadores por hashing de Zobrist abstrato, mais sucessores ficam no "
+           "trabalhador que os gerou, defeito: falso (utilizado no algoritmo paralelo apenas)\n");
+    printf("-w : Nós com menor custo roubados de cada vez ao trabalhador com mais nós por um trabalhador sem trabalho, "
+           "defeito: 0 (sem roubo de nós, utilizado no algoritmo paralelo apenas)\n");
+    printf("-m : Os trabalhadores partilham os nós abertos numa MultiQueue em vez de trocarem mensagens, defeito: falso "
+           "(utilizado no algoritmo paralelo apenas)\n");
+    printf("-a : Os trabalhadores expandem nblocks da abstração do problema com âmbitos disjuntos (PBNF), defeito: "
+           "falso (utilizado no algoritmo paralelo apenas)\n");
     return 0;
   }
 
@@ -149,6 +241,11 @@ int main(int argc, char* argv[])
   bool first = false;
   bool csv = false;
   bool show_solution = false;
+  bool abstract_owner = false;
+  bool multi_queue = false;
+  bool pbnf = false;
+  a_star_options_t options;
+  a_star_options_default(&options);
 
   // Verificamos se mais opções foram passadas
   int filename_arg = 1;
@@ -178,6 +275,104 @@ int main(int argc, char* argv[])
       continue;
     }
 
+    if(strcmp(opt, "-q") == 0)
+    {
+      if(++i >= argc || !min_heap_type_from_name(argv[i], &options.open_set_type))
+      {
+        printf("Erro: a estrutura dos nós abertos não é válida.\n");
+        return 1;
+      }
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-b") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0 || atoi(argv[i]) > A_STAR_MAX_EXPANSION_BATCH)
+      {
+        printf("Erro: o número de nós expandidos em conjunto não é válido (máximo %d).\n", A_STAR_MAX_EXPANSION_BATCH);
+        return 1;
+      }
+      options.expansion_batch = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-z") == 0)
+    {
+      abstract_owner = true;
+      filename_arg++;
+      continue;
+    }
+
+    if(strcmp(opt, "-a") == 0)
+    {
+      pbnf = true;
+      filename_arg++;
+      continue;
+    }
+
+    if(strcmp(opt, "-m") == 0)
+    {
+      multi_queue = true;
+      filename_arg++;
+      continue;
+    }
+
+    if(strcmp(opt, "-w") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0)
+      {
+        printf("Erro: o número de nós roubados não é válido.\n");
+        return 1;
+      }
+      options.steal_batch = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-o") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0)
+      {
+        printf("Erro: o número de mensagens guardadas para cada trabalhador não é válido.\n");
+        return 1;
+      }
+      options.outbox_size = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-e") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0)
+      {
+        printf("Erro: o número de expansões entre envios de mensagens não é válido.\n");
+        return 1;
+      }
+      options.outbox_expansions = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-c") == 0)
+    {
+      options.compact_nodes = true;
+      filename_arg++;
+      continue;
+    }
+
+    if(strcmp(opt, "-t") == 0)
+    {
+      if(++i >= argc || !min_heap_tie_from_name(argv[i], &options.tie_policy))
+      {
+        printf("Erro: a política de desempate não é válida.\n");
+        return 1;
+      }
+      filename_arg += 2;
+      continue;
+    }
+
     if(strcmp(opt, "-r") == 0)
     {
       csv = true;
@@ -219,14 +414,25 @@ int main(int argc, char* argv[])
       search_data_create("maze", argv[filename_arg], ALGO_PARALLEL_EXHAUSTIVE, num_threads, maze_serialize_function);
     }
 #endif
-   solve_parallel(maze_solver, num_threads, first, csv, show_solution);
+    if(pbnf)
+    {
+      solve_pbnf(maze_solver, num_threads, first, csv, show_solution, &options);
+    }
+    else if(multi_queue)
+    {
+      solve_multi_queue(maze_solver, num_threads, first, csv, show_solution, &options);
+    }
+    else
+    {
+      solve_parallel(maze_solver, num_threads, first, csv, show_solution, abstract_owner, &options);
+    }
   }
   else
   {
 #ifdef STATS_GEN
     search_data_create("maze", argv[filename_arg], ALGO_SEQUENTIAL, 1, maze_serialize_function);
 #endif
-    solve_sequential(maze_solver, csv, show_solution);
+    solve_sequential(maze_solver, csv, show_solution, &options);
   }
 #ifdef STATS_GEN
   search_data_destroy();
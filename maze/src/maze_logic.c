@@ -1,4 +1,5 @@
 #include "maze_logic.h"
+#include "zobrist.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,22 +8,23 @@
 #  include <time.h>
 #endif
 
-void update_neighbors(maze_solver_t* maze_solver, coord new_position, state_allocator_t* allocator, linked_list_t* neighbors)
+// Acrescenta o sucessor na nova posição se esta for válida, retorna falso em caso de erro de alocação
+bool update_neighbors(maze_solver_t* maze_solver, coord new_position, state_allocator_t* allocator, successors_t* neighbors)
 {
   int index = new_position.row * maze_solver->cols + new_position.col;
   if(maze_solver->initial_board[index] != '.')
   {
     // não podemos colocar um link na coordenada passada, este estado não
     // é valido
-    return;
+    return true;
   }
 
   maze_solver_state_t new_board;
   new_board.maze_solver = maze_solver;
   new_board.position.col = new_position.col;
   new_board.position.row = new_position.row;
-  state_t* new_state = state_allocator_new(allocator, &new_board);
-  linked_list_append(neighbors, new_state);
+  // Cada movimento custa 1, a heurística (distância euclidiana truncada) não é incremental
+  return successors_add_data(neighbors, allocator, &new_board, 1, SUCCESSOR_UNKNOWN);
 }
 
 // Função de heurística para o puzzle 8
@@ -37,7 +39,7 @@ int heuristic(const state_t* current_state, const state_t*)
   return h;
 }
 
-void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t* neighbors)
+bool visit(state_t* current_state, state_allocator_t* allocator, successors_t* neighbors)
 {
   maze_solver_state_t* state = (maze_solver_state_t*)current_state->data;
 
@@ -56,29 +58,43 @@ void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t*
   if(down > -1 && down < state->maze_solver->rows)
   {
     coord new_position = { col, down };
-    update_neighbors(state->maze_solver, new_position, allocator, neighbors);
+    if(!update_neighbors(state->maze_solver, new_position, allocator, neighbors))
+    {
+      return false;
+    }
   }
 
   // Verifica se o movimento para cima é válido
   if(up > -1 && up < state->maze_solver->rows)
   {
     coord new_position = { col, up };
-    update_neighbors(state->maze_solver, new_position, allocator, neighbors);
+    if(!update_neighbors(state->maze_solver, new_position, allocator, neighbors))
+    {
+      return false;
+    }
   }
 
   // Verifica se o movimento para a esquerda é válido
   if(left > -1 && left < state->maze_solver->cols)
   {
     coord new_position = { left, row };
-    update_neighbors(state->maze_solver, new_position, allocator, neighbors);
+    if(!update_neighbors(state->maze_solver, new_position, allocator, neighbors))
+    {
+      return false;
+    }
   }
 
   // Verifica se o movimento para a direita é válido
   if(right > -1 && right < state->maze_solver->cols)
   {
     coord new_position = { right, row };
-    update_neighbors(state->maze_solver, new_position, allocator, neighbors);
+    if(!update_neighbors(state->maze_solver, new_position, allocator, neighbors))
+    {
+      return false;
+    }
   }
+
+  return true;
 }
 
 // Verifica se um estado é um objetivo do problema number link
@@ -94,6 +110,77 @@ int distance(const state_t*, const state_t*)
   return 1;
 }
 
+// Lado, em posições, dos blocos utilizados pelo hash abstrato
+#define OWNER_BLOCK_SIZE 16
+
+// Hash de Zobrist abstrato do bloco da posição
+uint64_t owner(const state_t* state)
+{
+  maze_solver_state_t* maze_state = (maze_solver_state_t*)state->data;
+  return zobrist_key(0, (uint32_t)(maze_state->position.row / OWNER_BLOCK_SIZE)) ^
+         zobrist_key(1, (uint32_t)(maze_state->position.col / OWNER_BLOCK_SIZE));
+}
+
+// Número máximo de nblocks em cada dimensão do labirinto
+#define NBLOCK_GRID 16
+
+// Posições de um nblock numa dimensão do labirinto
+static inline int nblock_side(int length)
+{
+  return (length + NBLOCK_GRID - 1) / NBLOCK_GRID;
+}
+
+// Número de nblocks numa dimensão do labirinto
+static inline int nblock_blocks(int length)
+{
+  return (length + nblock_side(length) - 1) / nblock_side(length);
+}
+
+// Bloco da grelha onde está a posição
+size_t nblock(const state_t* state)
+{
+  maze_solver_state_t* maze_state = (maze_solver_state_t*)state->data;
+  maze_solver_t* maze_solver = maze_state->maze_solver;
+  int row = maze_state->position.row / nblock_side(maze_solver->rows);
+  int col = maze_state->position.col / nblock_side(maze_solver->cols);
+  return (size_t)(row * nblock_blocks(maze_solver->cols) + col);
+}
+
+// Número de blocos da grelha
+size_t nblock_count(const maze_solver_t* maze_solver)
+{
+  return (size_t)(nblock_blocks(maze_solver->rows) * nblock_blocks(maze_solver->cols));
+}
+
+// Os movimentos mudam a posição numa linha ou coluna, os nblocks sucessores são os vizinhos na grelha
+size_t nblock_successors(const void* instance, size_t nblock, size_t* successors)
+{
+  const maze_solver_t* maze_solver = (const maze_solver_t*)instance;
+  int rows = nblock_blocks(maze_solver->rows);
+  int cols = nblock_blocks(maze_solver->cols);
+  int row = (int)nblock / cols;
+  int col = (int)nblock % cols;
+
+  size_t count = 0;
+  if(row > 0)
+  {
+    successors[count++] = nblock - cols;
+  }
+  if(row < rows - 1)
+  {
+    successors[count++] = nblock + cols;
+  }
+  if(col > 0)
+  {
+    successors[count++] = nblock - 1;
+  }
+  if(col < cols - 1)
+  {
+    successors[count++] = nblock + 1;
+  }
+  return count;
+}
+
 #ifdef STATS_GEN
 size_t maze_serialize_function(char* buffer, const search_data_entry_t* entry)
 {
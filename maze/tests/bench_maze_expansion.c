@@ -0,0 +1,179 @@
+/*
+  Benchmark da expansão de nós no algoritmo sequencial
+
+  Compara o ciclo atual (um nó de cada vez, cada sucessor é obtido durante a visita) com a expansão em conjunto,
+  em que os hashes dos sucessores de um ou vários nós são calculados e os acessos à hashtable antecipados antes
+  de os estados serem obtidos. Para cada labirinto e modo reporta a melhor de várias execuções em expansões por
+  segundo, a instância do algoritmo é reutilizada entre execuções.
+
+  Utilização (a partir da raiz do repositório): bench_maze_expansion [repetições] [ficheiros de labirintos]
+  Por defeito utiliza os labirintos instances/maze_15 a instances/maze_19.
+*/
+#include "astar_sequential.h"
+#include "maze_logic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_REPETITIONS 5
+#define FIRST_MAZE 15
+#define LAST_MAZE 19
+
+// Modos comparados, 0 é o ciclo atual
+static const size_t batches[] = { 0, 1, 4, 16 };
+#define NUM_BATCHES (sizeof(batches) / sizeof(batches[0]))
+
+// Lê um labirinto, as linhas têm todas o mesmo comprimento
+static maze_solver_t* load_maze(const char* filename)
+{
+  FILE* file = fopen(filename, "r");
+  if(file == NULL)
+  {
+    return NULL;
+  }
+
+  fseek(file, 0, SEEK_END);
+  long length = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  char* board = malloc(length + 1);
+  if(board == NULL)
+  {
+    fclose(file);
+    return NULL;
+  }
+
+  // Removemos as mudanças de linha, o número de colunas é o comprimento da primeira linha
+  int rows = 0;
+  int cols = 0;
+  size_t size = 0;
+  int c;
+  int col = 0;
+  while((c = fgetc(file)) != EOF)
+  {
+    if(c == '\n' || c == '\r')
+    {
+      if(col > 0)
+      {
+        cols = col;
+        rows++;
+      }
+      col = 0;
+      continue;
+    }
+    board[size++] = (char)c;
+    col++;
+  }
+  if(col > 0)
+  {
+    cols = col;
+    rows++;
+  }
+  fclose(file);
+
+  maze_solver_t* maze_solver = NULL;
+  if(rows > 0 && (size_t)(rows * cols) == size)
+  {
+    maze_solver = maze_solver_init(rows, cols, board);
+  }
+  free(board);
+  return maze_solver;
+}
+
+// Melhor tempo de várias resoluções do labirinto com o modo indicado
+static double run(maze_solver_t* maze_solver, size_t batch, int repetitions, int* expanded)
+{
+  a_star_options_t options;
+  a_star_options_default(&options);
+  options.expansion_batch = batch;
+
+  a_star_sequential_t* a_star =
+      a_star_sequential_create(sizeof(maze_solver_state_t), goal, visit, heuristic, distance, NULL, &options);
+  if(a_star == NULL)
+  {
+    return 0;
+  }
+
+  double best = 0;
+  for(int r = 0; r < repetitions; r++)
+  {
+    a_star_sequential_reset(a_star);
+    maze_solver_state_t initial = { maze_solver, maze_solver->entry_coord };
+    a_star_sequential_solve(a_star, &initial, NULL);
+
+    if(r == 0 || a_star->common->execution_time < best)
+    {
+      best = a_star->common->execution_time;
+    }
+    *expanded = a_star->common->expanded;
+  }
+
+  a_star_sequential_destroy(a_star);
+  return best;
+}
+
+// Corre todos os modos para um labirinto
+static void bench_maze(const char* filename, int repetitions)
+{
+  maze_solver_t* maze_solver = load_maze(filename);
+  if(maze_solver == NULL)
+  {
+    printf("%s: erro ao ler o labirinto\n", filename);
+    return;
+  }
+
+  printf("%s (%dx%d)\n", filename, maze_solver->rows, maze_solver->cols);
+  double base = 0;
+  for(size_t i = 0; i < NUM_BATCHES; i++)
+  {
+    int expanded = 0;
+    double time = run(maze_solver, batches[i], repetitions, &expanded);
+    double rate = time > 0 ? expanded / time : 0;
+    if(i == 0)
+    {
+      base = rate;
+      printf("- ciclo atual: %d expansões, %.6fs, %.3f M expansões/s\n", expanded, time, rate / 1e6);
+    }
+    else
+    {
+      printf("- conjunto de %zu: %d expansões, %.6fs, %.3f M expansões/s (%.2fx)\n",
+             batches[i],
+             expanded,
+             time,
+             rate / 1e6,
+             base > 0 ? rate / base : 0);
+    }
+  }
+
+  maze_solver_destroy(maze_solver);
+}
+
+int main(int argc, char* argv[])
+{
+  int repetitions = DEFAULT_REPETITIONS;
+  if(argc > 1)
+  {
+    repetitions = atoi(argv[1]);
+    if(repetitions < 1)
+    {
+      repetitions = 1;
+    }
+  }
+
+  if(argc > 2)
+  {
+    for(int i = 2; i < argc; i++)
+    {
+      bench_maze(argv[i], repetitions);
+    }
+    return 0;
+  }
+
+  for(int m = FIRST_MAZE; m <= LAST_MAZE; m++)
+  {
+    char filename[64];
+    snprintf(filename, sizeof(filename), "instances/maze_%d", m);
+    bench_maze(filename, repetitions);
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+#include <check.h>
+#include <libgen.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Pasta dos executáveis, obtida a partir do caminho deste teste
+static char bin_dir[PATH_MAX];
+
+// Com STATS_GEN os programas não imprimem o relatório, os testes não são compilados
+#ifndef STATS_GEN
+// Ficheiro temporário com o labirinto dos testes, não depende da pasta de onde os testes são executados
+static char instance_path[] = "/tmp/test_maze_cli_XXXXXX";
+
+// Instância maze_1, a solução ótima tem custo 38
+static const char instance[] = "X.XXXXXXXXX\n"
+                               "X.....X...X\n"
+                               "X.XXXXX.X.X\n"
+                               "X.X.....X.X\n"
+                               "X.X.XXXXX.X\n"
+                               "X.X.....X.X\n"
+                               "X.XXXXX.X.X\n"
+                               "X.......X.X\n"
+                               "X.XXXXXXX.X\n"
+                               "X.X.......X\n"
+                               "XXXXXXXXX.X";
+
+// Executa o programa com os argumentos indicados, guarda a saída e retorna o código de saída
+static int run_maze(const char* args, char* output, size_t size)
+{
+  char command[2 * PATH_MAX];
+  snprintf(command, sizeof(command), "%s/maze %s %s", bin_dir, args, instance_path);
+
+  FILE* pipe = popen(command, "r");
+  ck_assert_ptr_nonnull(pipe);
+  size_t length = fread(output, 1, size - 1, pipe);
+  output[length] = '\0';
+  int status = pclose(pipe);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Teste da opção -s: a solução é impressa antes do relatório
+START_TEST(test_show_solution)
+{
+  char output[4096];
+  ck_assert_int_eq(run_maze("-r -s", output, sizeof(output)), 0);
+
+  // O caminho da solução é marcado com 'c' no labirinto
+  ck_assert_ptr_nonnull(strstr(output, "XcXXXXXXXXX\n"));
+  ck_assert_ptr_nonnull(strstr(output, "\"sim\";38;"));
+}
+END_TEST
+
+// Teste da opção -w: o número de nós roubados não é confundido com o nome do ficheiro
+START_TEST(test_steal_batch)
+{
+  char output[4096];
+  ck_assert_int_eq(run_maze("-r -n 2 -w 4", output, sizeof(output)), 0);
+  ck_assert_ptr_nonnull(strstr(output, "\"sim\";38;"));
+}
+END_TEST
+
+// Teste da opção -b: conjuntos acima do máximo são rejeitados com uma mensagem de erro
+START_TEST(test_expansion_batch_limit)
+{
+  char output[4096];
+  ck_assert_int_eq(run_maze("-r -b 10000000", output, sizeof(output)), 1);
+  ck_assert_ptr_nonnull(strstr(output, "Erro:"));
+
+  ck_assert_int_eq(run_maze("-r -b 256", output, sizeof(output)), 0);
+  ck_assert_ptr_nonnull(strstr(output, "\"sim\";38;"));
+}
+END_TEST
+#endif
+
+// Função principal de teste
+int main(int argc, char* argv[])
+{
+  // Os testes podem ser executados a partir da raiz do projeto ou da pasta do problema
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s", argv[0]);
+  snprintf(bin_dir, sizeof(bin_dir), "%s", dirname(path));
+
+#ifndef STATS_GEN
+  // O labirinto é escrito num ficheiro temporário, removido no fim dos testes
+  int fd = mkstemp(instance_path);
+  if(fd == -1 || write(fd, instance, sizeof(instance) - 1) != (ssize_t)(sizeof(instance) - 1))
+  {
+    perror("Erro ao criar o labirinto dos testes");
+    return EXIT_FAILURE;
+  }
+  close(fd);
+#endif
+
+  Suite* suite = suite_create("maze_cli");
+  TCase* testcase = tcase_create("Core");
+
+#ifndef STATS_GEN
+  tcase_add_test(testcase, test_show_solution);
+  tcase_add_test(testcase, test_steal_batch);
+  tcase_add_test(testcase, test_expansion_batch_limit);
+#endif
+
+  suite_add_tcase(suite, testcase);
+
+  SRunner* runner = srunner_create(suite);
+  srunner_run_all(runner, CK_NORMAL);
+  int num_failed = srunner_ntests_failed(runner);
+  srunner_free(runner);
+
+#ifndef STATS_GEN
+  unlink(instance_path);
+#endif
+
+  return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
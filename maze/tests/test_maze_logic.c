@@ -2,6 +2,7 @@
 #include "state.h"
 #include <check.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Teste unitário para a função visit
 START_TEST(test_visit_case_1)
@@ -13,14 +14,14 @@ START_TEST(test_visit_case_1)
 
   maze_solver_t* maze_solver = maze_solver_init(rows, cols, initial_board);
 
-  state_allocator_t* allocator = state_allocator_create(sizeof(maze_solver_state_t));
+  state_allocator_t* allocator = state_allocator_create(sizeof(maze_solver_state_t), 0);
 
   maze_solver_state_t initial_state = {
     maze_solver, position
   };
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -28,15 +29,15 @@ START_TEST(test_visit_case_1)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 1);
 
   coord n1_position = { 1, 2 };
 
   // Retira o sucessor da lista e remove da lista
-  state_t* neighbor_1_ptr = linked_list_get(neighbors, 0);
-  linked_list_remove(neighbors,0);
+  state_t* neighbor_1_ptr = neighbors->items[0].state;
+  successors_clear(neighbors);
 
   maze_solver_state_t* n1_state = (maze_solver_state_t*)neighbor_1_ptr->data;
   ck_assert_int_eq(n1_state->position.row, n1_position.row);
@@ -45,31 +46,31 @@ START_TEST(test_visit_case_1)
   // Chamada da função visit para expandir o estado inicial
   visit(neighbor_1_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 3);
 
   coord n2_position = { 1, 3 };
   coord n3_position = { 2, 2 };
 
   // Retira o sucessor da lista e remove da lista
-  state_t* neighbor_2_ptr = linked_list_get(neighbors, 0);
+  state_t* neighbor_2_ptr = neighbors->items[0].state;
   maze_solver_state_t* n2_state = (maze_solver_state_t*)neighbor_2_ptr->data;
   ck_assert_int_eq(n2_state->position.row, n2_position.row);
   ck_assert_int_eq(n2_state->position.col, n2_position.col);
 
-  neighbor_1_ptr = linked_list_get(neighbors, 1);
+  neighbor_1_ptr = neighbors->items[1].state;
   n1_state = (maze_solver_state_t*)neighbor_1_ptr->data;
   ck_assert_int_eq(n1_state->position.row, position.row);
   ck_assert_int_eq(n1_state->position.col, position.col);
 
-  state_t* neighbor_3_ptr = linked_list_get(neighbors, 2);
+  state_t* neighbor_3_ptr = neighbors->items[2].state;
   maze_solver_state_t* n3_state = (maze_solver_state_t*)neighbor_3_ptr->data;
   ck_assert_int_eq(n3_state->position.row, n3_position.row);
   ck_assert_int_eq(n3_state->position.col, n3_position.col);
 
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
   maze_solver_destroy(maze_solver);
 }
@@ -83,7 +84,7 @@ START_TEST(test_goal) {
 
   maze_solver_t* maze_solver = maze_solver_init(rows, cols, board);
 
-  state_allocator_t* allocator = state_allocator_create(sizeof(maze_solver_state_t));
+  state_allocator_t* allocator = state_allocator_create(sizeof(maze_solver_state_t), 0);
 
   maze_solver_state_t initial_state = {
     maze_solver, position
@@ -117,7 +118,7 @@ START_TEST(test_heuristic) {
 
   maze_solver_t* maze_solver = maze_solver_init(rows, cols, board);
 
-  state_allocator_t* allocator = state_allocator_create(sizeof(maze_solver_state_t));
+  state_allocator_t* allocator = state_allocator_create(sizeof(maze_solver_state_t), 0);
 
   maze_solver_state_t initial_state = {
     maze_solver,  position
@@ -136,6 +137,57 @@ START_TEST(test_heuristic) {
 }
 END_TEST
 
+// Teste unitário para o hash abstrato, as posições do mesmo bloco têm o mesmo trabalhador
+START_TEST(test_owner)
+{
+  maze_solver_state_t first = { NULL, { 0, 0 } };
+  maze_solver_state_t same_block = { NULL, { 15, 15 } };
+  maze_solver_state_t next_block = { NULL, { 16, 15 } };
+
+  state_t first_state = { 0, &first };
+  state_t same_block_state = { 0, &same_block };
+  state_t next_block_state = { 0, &next_block };
+
+  ck_assert_uint_eq(owner(&first_state), owner(&same_block_state));
+  ck_assert_uint_ne(owner(&first_state), owner(&next_block_state));
+}
+END_TEST
+
+// Teste unitário da abstração do PBNF, o labirinto é dividido numa grelha de blocos vizinhos
+START_TEST(test_nblock)
+{
+  // Um labirinto de 40 x 40 é dividido em 14 x 14 blocos de 3 x 3 posições
+  char board[40 * 40];
+  memset(board, '.', sizeof(board));
+  maze_solver_t* maze_solver = maze_solver_init(40, 40, board);
+  ck_assert_uint_eq(nblock_count(maze_solver), 14 * 14);
+
+  maze_solver_state_t first = { maze_solver, { 0, 0 } };
+  maze_solver_state_t same_block = { maze_solver, { 2, 2 } };
+  maze_solver_state_t next_block = { maze_solver, { 3, 2 } };
+  maze_solver_state_t last = { maze_solver, { 39, 39 } };
+
+  state_t first_state = { 0, &first };
+  state_t same_block_state = { 0, &same_block };
+  state_t next_block_state = { 0, &next_block };
+  state_t last_state = { 0, &last };
+
+  ck_assert_uint_eq(nblock(&first_state), 0);
+  ck_assert_uint_eq(nblock(&same_block_state), 0);
+  ck_assert_uint_eq(nblock(&next_block_state), 1);
+  ck_assert_uint_eq(nblock(&last_state), 14 * 14 - 1);
+
+  // Os cantos têm dois vizinhos, os blocos interiores quatro
+  size_t successors[4];
+  ck_assert_uint_eq(nblock_successors(maze_solver, 0, successors), 2);
+  ck_assert_uint_eq(successors[0], 14);
+  ck_assert_uint_eq(successors[1], 1);
+  ck_assert_uint_eq(nblock_successors(maze_solver, 15, successors), 4);
+
+  maze_solver_destroy(maze_solver);
+}
+END_TEST
+
 // Função auxiliar para criação da suíte de testes
 Suite* create_suite()
 {
@@ -145,6 +197,8 @@ Suite* create_suite()
   tcase_add_test(tcase, test_goal);
   tcase_add_test(tcase, test_distance);
   tcase_add_test(tcase, test_heuristic);
+  tcase_add_test(tcase, test_owner);
+  tcase_add_test(tcase, test_nblock);
   suite_add_tcase(suite, tcase);
   return suite;
 }
@@ -1,8 +1,9 @@
 #ifndef LOGIC_H
 #define LOGIC_H
 #include "numberlink_common.h"
-#include "linked_list.h"
+#include "successors.h"
 #include "state.h"
+#include <stdint.h>
 
 // Estrutura do que contem o estado do nosso number link
 typedef struct
@@ -16,7 +17,8 @@ typedef struct
 int heuristic(const state_t*, const state_t*);
 
 // Encontra os vizinhos de um estado no problema 8 puzzle
-void visit(state_t*, state_allocator_t*, linked_list_t*);
+// Retorna falso se não for possível alocar os sucessores
+bool visit(state_t*, state_allocator_t*, successors_t*);
 
 // Verifica se um estado é um objetivo do problema 8 puzzle
 bool goal(const state_t*, const state_t*);
@@ -26,4 +28,8 @@ bool goal(const state_t*, const state_t*);
 // mover uma peça de cada vez para o espaço livre
 int distance(const state_t*, const state_t*);
 
+// Hash de Zobrist abstrato para atribuir os estados aos trabalhadores: apenas as posições atuais dos pares de
+// índice par, os movimentos dos outros pares mantêm o estado no mesmo trabalhador
+uint64_t owner(const state_t*);
+
 #endif
\ No newline at end of file
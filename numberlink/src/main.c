@@ -7,6 +7,7 @@ int main(int argc, char* argv[])
   return 0;
 }
 #else
+#include "astar_multi_queue.h"
 #include "astar_parallel.h"
 #include "astar_sequential.h"
 #include "numberlink_logic.h"
@@ -82,11 +83,23 @@ void print_solution(a_star_node_t* solution)
 }
 
 // Resolve o problema utilizando a versão paralela do algoritmo
-void solve_parallel(number_link_t* number_link, int num_threads, bool first, bool csv, bool show_solution)
+void solve_parallel(number_link_t* number_link,
+                    int num_threads,
+                    bool first,
+                    bool csv,
+                    bool show_solution,
+                    bool abstract_owner,
+                    const a_star_options_t* options)
 {
   // Criamos a instância do algoritmo A*
-  a_star_parallel_t* a_star =
-      a_star_parallel_create(sizeof(number_link_state_t), goal, visit, heuristic, distance, print_solution, num_threads, first);
+  a_star_parallel_t* a_star = a_star_parallel_create(
+      sizeof(number_link_state_t), goal, visit, heuristic, distance, print_solution, num_threads, first, options);
+
+  // Os estados são atribuídos aos trabalhadores pelo hash abstrato do problema
+  if(abstract_owner)
+  {
+    a_star_parallel_set_owner(a_star, owner);
+  }
 
   // Criamos o nosso estado inicial para lançar o algoritmo
   number_link_state_t initial = { number_link,
@@ -103,12 +116,39 @@ void solve_parallel(number_link_t* number_link, int num_threads, bool first, boo
   a_star_parallel_destroy(a_star);
 }
 
+// Resolve o problema utilizando a versão paralela com fronteira partilhada (MultiQueue) do algoritmo
+void solve_multi_queue(number_link_t* number_link,
+                       int num_threads,
+                       bool first,
+                       bool csv,
+                       bool show_solution,
+                       const a_star_options_t* options)
+{
+  // Criamos a instância do algoritmo A*
+  a_star_multi_queue_t* a_star = a_star_multi_queue_create(
+      sizeof(number_link_state_t), goal, visit, heuristic, distance, print_solution, num_threads, first, options);
+
+  // Criamos o nosso estado inicial para lançar o algoritmo
+  number_link_state_t initial = { number_link,
+                                  number_link_create_board(number_link, number_link->initial_board, number_link->initial_coords),
+                                  0 };
+
+  // Tentamos resolver o problema
+  a_star_multi_queue_solve(a_star, &initial, NULL);
+
+  // Imprime as estatísticas da execução
+  a_star_multi_queue_print_statistics(a_star, csv, show_solution);
+
+  // Limpamos a memória
+  a_star_multi_queue_destroy(a_star);
+}
+
 // Resolve o problema utilizando a versão sequencial do algoritmo
-void solve_sequential(number_link_t* number_link, bool csv, bool show_solution)
+void solve_sequential(number_link_t* number_link, bool csv, bool show_solution, const a_star_options_t* options)
 {
   // Criamos a instância do algoritmo A*
   a_star_sequential_t* a_star =
-      a_star_sequential_create(sizeof(number_link_state_t), goal, visit, heuristic, distance, print_solution);
+      a_star_sequential_create(sizeof(number_link_state_t), goal, visit, heuristic, distance, print_solution, options);
 
   // Criamos o nosso estado inicial para lançar o algoritmo
   number_link_state_t initial = { number_link,
@@ -130,11 +170,31 @@ int main(int argc, char* argv[])
   // Verificar se o nome do arquivo foi fornecido como argumento
   if(argc < 2)
   {
-    printf("Uso: %s [-n <num. trabalhadores>] [-p] [-r] <ficheiro_instâncias>\n", argv[0]);
+    printf("Uso: %s [-n <num. trabalhadores>] [-p] [-r] [-s] [-q <tipo>] [-t <política>] [-b <nós>] [-c] [-o <mensagens>] "
+           "[-e <expansões>] [-z] [-w <nós>] [-m] <ficheiro_instâncias>\n",
+           argv[0]);
     printf("Opções:\n");
     printf("-n : Número de trabalhadores (threads), defeito: 0 (algoritmo sequencial)\n");
     printf("-p : Termina à primeira solução encontrada, defeito: falso (utilizado no algoritmo paralelo apenas)\n");
     printf("-r : Relatório em formato compatível com CSV \n");
+    printf("-s : Imprime a solução encontrada\n");
+    printf("-q : Estrutura dos nós abertos (binary, 4ary, 8ary ou bucket), defeito: 4ary\n");
+    printf("-t : Desempate dos nós abertos com o mesmo custo (none, high-g, low-h ou lifo), defeito: high-g\n");
+    printf("-b : Nós com o mesmo custo expandidos em conjunto, com os acessos aos sucessores antecipados, defeito: 0 "
+           "(um nó de cada vez, máximo %d, utilizado no algoritmo sequencial apenas)\n",
+           A_STAR_MAX_EXPANSION_BATCH);
+    printf("-c : Nós compactos (arrays indexados por 32 bits), reduz a memória por estado, defeito: falso "
+           "(utilizado no algoritmo sequencial apenas)\n");
+    printf("-o : Mensagens guardadas para cada trabalhador antes de serem enviadas num bloco, defeito: 64 "
+           "(utilizado no algoritmo paralelo apenas)\n");
+    printf("-e : Expansões após as quais as mensagens guardadas são enviadas, defeito: 16, 0 não limita "
+           "(utilizado no algoritmo paralelo apenas)\n");
+    printf("-z : Atribui os estados aos trabalhadores por hashing de Zobrist abstrato, mais sucessores ficam no "
+           "trabalhador que os gerou, defeito: falso (utilizado no algoritmo paralelo apenas)\n");
+    printf("-w : Nós com menor custo roubados de cada vez ao trabalhador com mais nós por um trabalhador sem trabalho, "
+           "defeito: 0 (sem roubo de nós, utilizado no algoritmo paralelo apenas)\n");
+    printf("-m : Os trabalhadores partilham os nós abertos numa MultiQueue em vez de trocarem mensagens, defeito: falso "
+           "(utilizado no algoritmo paralelo apenas)\n");
     return 0;
   }
 
@@ -143,6 +203,10 @@ int main(int argc, char* argv[])
   bool first = false;
   bool csv = false;
   bool show_solution = false;
+  bool abstract_owner = false;
+  bool multi_queue = false;
+  a_star_options_t options;
+  a_star_options_default(&options);
 
   // Verificamos se mais opções foram passadas
   int filename_arg = 1;
@@ -172,6 +236,97 @@ int main(int argc, char* argv[])
       continue;
     }
 
+    if(strcmp(opt, "-q") == 0)
+    {
+      if(++i >= argc || !min_heap_type_from_name(argv[i], &options.open_set_type))
+      {
+        printf("Erro: a estrutura dos nós abertos não é válida.\n");
+        return 1;
+      }
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-b") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0 || atoi(argv[i]) > A_STAR_MAX_EXPANSION_BATCH)
+      {
+        printf("Erro: o número de nós expandidos em conjunto não é válido (máximo %d).\n", A_STAR_MAX_EXPANSION_BATCH);
+        return 1;
+      }
+      options.expansion_batch = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-z") == 0)
+    {
+      abstract_owner = true;
+      filename_arg++;
+      continue;
+    }
+
+    if(strcmp(opt, "-m") == 0)
+    {
+      multi_queue = true;
+      filename_arg++;
+      continue;
+    }
+
+    if(strcmp(opt, "-w") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0)
+      {
+        printf("Erro: o número de nós roubados não é válido.\n");
+        return 1;
+      }
+      options.steal_batch = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-o") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0)
+      {
+        printf("Erro: o número de mensagens guardadas para cada trabalhador não é válido.\n");
+        return 1;
+      }
+      options.outbox_size = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-e") == 0)
+    {
+      if(++i >= argc || atoi(argv[i]) < 0)
+      {
+        printf("Erro: o número de expansões entre envios de mensagens não é válido.\n");
+        return 1;
+      }
+      options.outbox_expansions = (size_t)atoi(argv[i]);
+      filename_arg += 2;
+      continue;
+    }
+
+    if(strcmp(opt, "-c") == 0)
+    {
+      options.compact_nodes = true;
+      filename_arg++;
+      continue;
+    }
+
+    if(strcmp(opt, "-t") == 0)
+    {
+      if(++i >= argc || !min_heap_tie_from_name(argv[i], &options.tie_policy))
+      {
+        printf("Erro: a política de desempate não é válida.\n");
+        return 1;
+      }
+      filename_arg += 2;
+      continue;
+    }
+
     if(strcmp(opt, "-r") == 0)
     {
       csv = true;
@@ -204,11 +359,18 @@ int main(int argc, char* argv[])
 
   if(num_threads > 0)
   {
-    solve_parallel(number_link, num_threads, first, csv, show_solution);
+    if(multi_queue)
+    {
+      solve_multi_queue(number_link, num_threads, first, csv, show_solution, &options);
+    }
+    else
+    {
+      solve_parallel(number_link, num_threads, first, csv, show_solution, abstract_owner, &options);
+    }
   }
   else
   {
-    solve_sequential(number_link, csv, show_solution);
+    solve_sequential(number_link, csv, show_solution, &options);
   }
 
   number_link_destroy(number_link);
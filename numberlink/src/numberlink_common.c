@@ -244,10 +244,15 @@ void* number_link_create_board(number_link_t* number_link, const char* board_dat
 
   if(!board)
   {
-    // O tabuleiro nesta configuração ainda não existe, alocamos e indexamos
+    // O tabuleiro nesta configuração ainda não existe, alocamos e indexamos. Se outra thread o
+    // indexou entretanto utilizamos o tabuleiro dela
     board = (void*)allocator_alloc(number_link->allocator);
+    if(board == NULL)
+    {
+      return NULL;
+    }
     memcpy(board, &tmp_board, number_link->struct_size);
-    hashtable_insert(number_link->hashtable, board);
+    board = hashtable_insert_if_absent(number_link->hashtable, board);
   }
 
   return board;
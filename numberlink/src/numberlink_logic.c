@@ -1,15 +1,18 @@
 #include "numberlink_logic.h"
+#include "zobrist.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-void update_neighbors(number_link_t* number_link,
+// Acrescenta o sucessor com o par movido para a nova posição se esta for válida, retorna falso em caso de erro de
+// alocação
+bool update_neighbors(number_link_t* number_link,
                       int pair,
                       coord new_coord,
                       board_data_t board_data,
                       state_allocator_t* allocator,
-                      linked_list_t* neighbors,
+                      successors_t* neighbors,
                       int matched_pairs)
 {
   char tmp_board[number_link->board_len];
@@ -22,8 +25,9 @@ void update_neighbors(number_link_t* number_link,
   // Atualizamos a nossa coordenada atual para este par
   tmp_curr[pair] = new_coord;
 
-  // Iniciamos um novo tabuleiro
+  // Iniciamos um novo tabuleiro, os bytes de alinhamento também são comparados pela hashtable
   number_link_state_t new_board;
+  memset(&new_board, 0, sizeof(new_board));
   new_board.number_link = number_link;
   new_board.matched_pairs = matched_pairs;
 
@@ -41,7 +45,7 @@ void update_neighbors(number_link_t* number_link,
     {
       // não podemos colocar um link na coordenada passada, este estado não
       // é valido
-      return;
+      return true;
     }
     // Colocamos a respetiva letra no tabuleiro e atualizamos a posição para este par
     tmp_board[index] = number_to_lower(pair);
@@ -49,8 +53,18 @@ void update_neighbors(number_link_t* number_link,
 
   // Alocamos o tabuleiro
   new_board.board_data = number_link_create_board(number_link, (const char*)&tmp_board, (const coord*)&tmp_curr);
-  state_t* new_state = state_allocator_new(allocator, &new_board);
-  linked_list_append(neighbors, new_state);
+  if(new_board.board_data == NULL)
+  {
+    return false;
+  }
+
+  // Apenas este par se moveu uma posição, o que evita percorrer todos os pares na distância e na heurística
+  int linked = new_board.matched_pairs - matched_pairs;
+  coord old_coord = board_data.coords[pair];
+  coord goal = number_link->goals[pair];
+  int h_delta = -linked + abs(new_coord.col - goal.col) + abs(new_coord.row - goal.row) - abs(old_coord.col - goal.col) -
+                abs(old_coord.row - goal.row);
+  return successors_add_data(neighbors, allocator, &new_board, 1 + linked, h_delta);
 }
 
 // Função de heurística para o puzzle 8
@@ -73,15 +87,16 @@ int heuristic(const state_t* current_state, const state_t*)
   return h;
 }
 
-void do_moves(
-    int pair, board_data_t board_data, number_link_state_t* state, state_allocator_t* allocator, linked_list_t* neighbors)
+// Acrescenta os sucessores dos movimentos de um par, retorna falso em caso de erro de alocação
+bool do_moves(
+    int pair, board_data_t board_data, number_link_state_t* state, state_allocator_t* allocator, successors_t* neighbors)
 {
   int up, down, left, right, col, row;
 
   if(memcmp(&(board_data.coords[pair]), &(state->number_link->goals[pair]), sizeof(coord)) == 0)
   {
     // Este par já se encontra ligado, nada a fazer
-    return;
+    return true;
   }
 
   // Lemos as coordenadas atuais e movemos cada um dos links
@@ -97,40 +112,58 @@ void do_moves(
   if(down > -1 && down < state->number_link->rows)
   {
     coord new_coord = { col, down };
-    update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs);
+    if(!update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs))
+    {
+      return false;
+    }
   }
 
   // Verifica se o movimento para cima é válido
   if(up > -1 && up < state->number_link->rows)
   {
     coord new_coord = { col, up };
-    update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs);
+    if(!update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs))
+    {
+      return false;
+    }
   }
 
   // Verifica se o movimento para a esquerda é válido
   if(left > -1 && left < state->number_link->cols)
   {
     coord new_coord = { left, row };
-    update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs);
+    if(!update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs))
+    {
+      return false;
+    }
   }
 
   // Verifica se o movimento para a direita é válido
   if(right > -1 && right < state->number_link->cols)
   {
     coord new_coord = { right, row };
-    update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs);
+    if(!update_neighbors(state->number_link, pair, new_coord, board_data, allocator, neighbors, state->matched_pairs))
+    {
+      return false;
+    }
   }
+
+  return true;
 }
 
-void visit(state_t* current_state, state_allocator_t* allocator, linked_list_t* neighbors)
+bool visit(state_t* current_state, state_allocator_t* allocator, successors_t* neighbors)
 {
   number_link_state_t* state = (number_link_state_t*)current_state->data;
   board_data_t board_data = number_link_wrap_board(state->number_link, state->board_data);
 
   for(int pair = 0; pair < state->number_link->num_pairs; pair++)
   {
-    do_moves(pair, board_data, state, allocator, neighbors);
+    if(!do_moves(pair, board_data, state, allocator, neighbors))
+    {
+      return false;
+    }
   }
+  return true;
 }
 
 // Verifica se um estado é um objetivo do problema number link
@@ -160,3 +193,19 @@ int distance(const state_t* parent, const state_t* neighbor)
   }
   return d;
 }
+
+// Hash de Zobrist abstrato das posições dos pares de índice par
+uint64_t owner(const state_t* state)
+{
+  number_link_state_t* link_state = (number_link_state_t*)state->data;
+  number_link_t* number_link = link_state->number_link;
+  board_data_t board_data = number_link_wrap_board(number_link, link_state->board_data);
+
+  uint64_t hash = 0;
+  for(int pair = 0; pair < number_link->num_pairs; pair += 2)
+  {
+    coord position = board_data.coords[pair];
+    hash ^= zobrist_key((uint32_t)pair, (uint32_t)(position.row * number_link->cols + position.col));
+  }
+  return hash;
+}
@@ -21,14 +21,14 @@ START_TEST(test_visit_case_1)
 
   number_link_t* number_link = number_link_init(rows, cols, initial_board);
 
-  state_allocator_t* allocator = state_allocator_create(sizeof(number_link_state_t));
+  state_allocator_t* allocator = state_allocator_create(sizeof(number_link_state_t), 0);
 
   number_link_state_t initial_state = {
     number_link, number_link_create_board(number_link, number_link->initial_board, number_link->initial_coords), 0
   };
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -36,33 +36,41 @@ START_TEST(test_visit_case_1)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 3);
 
-  state_t* neighbor_1 = linked_list_get(neighbors, 0);
+  state_t* neighbor_1 = neighbors->items[0].state;
   number_link_state_t* neighbor_1_state = (number_link_state_t*)neighbor_1->data;
   board_data_t neighbor_1_board_data = number_link_wrap_board(neighbor_1_state->number_link, neighbor_1_state->board_data);
   ck_assert_mem_eq(neighbor_1_board_data.board, &neighbor_1_board, rows * cols);
   ck_assert_mem_eq(neighbor_1_board_data.coords, &neighbor_1_coords, number_link->num_pairs * sizeof(coord));
   ck_assert_int_eq(neighbor_1_state->matched_pairs, 0);
 
-  state_t* neighbor_2 = linked_list_get(neighbors, 1);
+  state_t* neighbor_2 = neighbors->items[1].state;
   number_link_state_t* neighbor_2_state = (number_link_state_t*)neighbor_2->data;
   board_data_t neighbor_2_board_data = number_link_wrap_board(neighbor_2_state->number_link, neighbor_2_state->board_data);
   ck_assert_mem_eq(neighbor_2_board_data.board, &neighbor_2_board, rows * cols);
   ck_assert_mem_eq(neighbor_2_board_data.coords, &neighbor_2_coords, number_link->num_pairs * sizeof(coord));
   ck_assert_int_eq(neighbor_2_state->matched_pairs, 0);
 
-  state_t* neighbor_3 = linked_list_get(neighbors, 2);
+  state_t* neighbor_3 = neighbors->items[2].state;
   number_link_state_t* neighbor_3_state = (number_link_state_t*)neighbor_3->data;
   board_data_t neighbor_3_board_data = number_link_wrap_board(neighbor_3_state->number_link, neighbor_3_state->board_data);
   ck_assert_mem_eq(neighbor_3_board_data.board, &neighbor_3_board, rows * cols);
   ck_assert_mem_eq(neighbor_3_board_data.coords, &neighbor_3_coords, number_link->num_pairs * sizeof(coord));
   ck_assert_int_eq(neighbor_3_state->matched_pairs, 0);
 
+  // O custo e a variação da heurística fornecidos coincidem com as funções de distância e de heurística
+  for(size_t i = 0; i < neighbors->size; i++)
+  {
+    successor_t* successor = &neighbors->items[i];
+    ck_assert_int_eq(successor->cost, distance(initial_state_ptr, successor->state));
+    ck_assert_int_eq(heuristic(initial_state_ptr, NULL) + successor->h_delta, heuristic(successor->state, NULL));
+  }
+
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
   number_link_destroy(number_link);
 }
@@ -85,14 +93,14 @@ START_TEST(test_visit_case_2)
 
   number_link_t* number_link = number_link_init(rows, cols, initial_board);
 
-  state_allocator_t* allocator = state_allocator_create(sizeof(number_link_state_t));
+  state_allocator_t* allocator = state_allocator_create(sizeof(number_link_state_t), 0);
 
   number_link_state_t initial_state = {
     number_link, number_link_create_board(number_link, number_link->initial_board, number_link->initial_coords), 0
   };
 
-  // Criação da lista ligada de vizinhos
-  linked_list_t* neighbors = linked_list_create();
+  // Criação do buffer de vizinhos
+  successors_t* neighbors = successors_create(0);
 
   // Criação do estado inicial usando o alocador
   state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
@@ -100,39 +108,73 @@ START_TEST(test_visit_case_2)
   // Chamada da função visit para expandir o estado inicial
   visit(initial_state_ptr, allocator, neighbors);
 
-  // Verificação do tamanho da lista de vizinhos
-  size_t num_neighbors = linked_list_size(neighbors);
+  // Verificação do número de vizinhos
+  size_t num_neighbors = neighbors->size;
   ck_assert_int_eq(num_neighbors, 3);
 
-  state_t* neighbor_1 = linked_list_get(neighbors, 0);
+  state_t* neighbor_1 = neighbors->items[0].state;
   number_link_state_t* neighbor_1_state = (number_link_state_t*)neighbor_1->data;
   board_data_t neighbor_1_board_data = number_link_wrap_board(neighbor_1_state->number_link, neighbor_1_state->board_data);
   ck_assert_mem_eq(neighbor_1_board_data.board, &neighbor_1_board, rows * cols);
   ck_assert_mem_eq(neighbor_1_board_data.coords, &neighbor_1_coords, number_link->num_pairs * sizeof(coord));
   ck_assert_int_eq(neighbor_1_state->matched_pairs, 0);
 
-  state_t* neighbor_2 = linked_list_get(neighbors, 1);
+  state_t* neighbor_2 = neighbors->items[1].state;
   number_link_state_t* neighbor_2_state = (number_link_state_t*)neighbor_2->data;
   board_data_t neighbor_2_board_data = number_link_wrap_board(neighbor_2_state->number_link, neighbor_2_state->board_data);
   ck_assert_mem_eq(neighbor_2_board_data.board, &neighbor_2_board, rows * cols);
   ck_assert_mem_eq(neighbor_2_board_data.coords, &neighbor_2_coords, number_link->num_pairs * sizeof(coord));
   ck_assert_int_eq(neighbor_2_state->matched_pairs, 0);
 
-  state_t* neighbor_3 = linked_list_get(neighbors, 2);
+  state_t* neighbor_3 = neighbors->items[2].state;
   number_link_state_t* neighbor_3_state = (number_link_state_t*)neighbor_3->data;
   board_data_t neighbor_3_board_data = number_link_wrap_board(neighbor_3_state->number_link, neighbor_3_state->board_data);
   ck_assert_mem_eq(neighbor_3_board_data.board, &neighbor_3_board, rows * cols);
   ck_assert_mem_eq(neighbor_3_board_data.coords, &neighbor_3_coords, number_link->num_pairs * sizeof(coord));
   ck_assert_int_eq(neighbor_3_state->matched_pairs, 0);
 
+  // O custo e a variação da heurística fornecidos coincidem com as funções de distância e de heurística
+  for(size_t i = 0; i < neighbors->size; i++)
+  {
+    successor_t* successor = &neighbors->items[i];
+    ck_assert_int_eq(successor->cost, distance(initial_state_ptr, successor->state));
+    ck_assert_int_eq(heuristic(initial_state_ptr, NULL) + successor->h_delta, heuristic(successor->state, NULL));
+  }
+
   // Liberta a memória utilizada
-  linked_list_destroy(neighbors);
+  successors_destroy(neighbors);
   state_allocator_destroy(allocator);
   number_link_destroy(number_link);
 }
 
 END_TEST
 
+// Teste unitário para o hash abstrato, apenas os pares de índice par mudam o trabalhador do estado
+START_TEST(test_owner)
+{
+  number_link_t* number_link = number_link_init(3, 3, "A.AB.BC.C");
+  state_allocator_t* allocator = state_allocator_create(sizeof(number_link_state_t), 0);
+
+  number_link_state_t initial_state = {
+    number_link, number_link_create_board(number_link, number_link->initial_board, number_link->initial_coords), 0
+  };
+  successors_t* neighbors = successors_create(0);
+  state_t* initial_state_ptr = state_allocator_new(allocator, &initial_state);
+
+  // Os vizinhos movem os pares A, B e C por esta ordem
+  visit(initial_state_ptr, allocator, neighbors);
+  ck_assert_int_eq(neighbors->size, 3);
+  ck_assert_uint_ne(owner(initial_state_ptr), owner(neighbors->items[0].state));
+  ck_assert_uint_eq(owner(initial_state_ptr), owner(neighbors->items[1].state));
+  ck_assert_uint_ne(owner(initial_state_ptr), owner(neighbors->items[2].state));
+
+  // Liberta a memória utilizada
+  successors_destroy(neighbors);
+  state_allocator_destroy(allocator);
+  number_link_destroy(number_link);
+}
+END_TEST
+
 START_TEST(test_goal) { }
 END_TEST
 
@@ -150,6 +192,7 @@ Suite* create_suite()
   TCase* tcase = tcase_create("Core");
   tcase_add_test(tcase, test_visit_case_1);
   tcase_add_test(tcase, test_visit_case_2);
+  tcase_add_test(tcase, test_owner);
   tcase_add_test(tcase, test_goal);
   tcase_add_test(tcase, test_distance);
   tcase_add_test(tcase, test_heuristic);
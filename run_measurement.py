@@ -112,13 +112,17 @@ def row_to_str(row: list):
 
 def run_measurement(problem, instance,
                     num_runs, thread_num=0,
-                    first_solution=False):
+                    first_solution=False, tie_policy=None):
     # Execution arguments
     exec_cmd = f"./{problem}/bin/{problem}"
     # -r flag means we want in CSV format
     # -s flag means we want the solution
     exec_args = ["-r"]
 
+    # -t flag selects the open list tie-breaking policy
+    if tie_policy:
+        exec_args.extend(["-t", tie_policy])
+
     # Average result row
     average_row = [f"\"{problem}-{instance}\""]
     if thread_num > 0:
@@ -155,7 +159,7 @@ def run_measurement(problem, instance,
 
 
 def run_measurements(problem, instance, threads, num_runs,
-                     save_csv, output, truncate):
+                     save_csv, output, truncate, tie_policy=None):
 
     # To store measurements
     # 0-> sequential
@@ -165,7 +169,7 @@ def run_measurements(problem, instance, threads, num_runs,
 
     # Sequential
     row = run_measurement(
-        problem, instance, num_runs)
+        problem, instance, num_runs, tie_policy=tie_policy)
     # Base time for calculating speed-up
     base_exec_time = row[-1]
     # Store row
@@ -175,7 +179,8 @@ def run_measurements(problem, instance, threads, num_runs,
     for thread_num in threads:
         # First solution average
         row = run_measurement(problem, instance,
-                              num_runs, thread_num)
+                              num_runs, thread_num,
+                              tie_policy=tie_policy)
         # Calculate speed-up and append to row
         speed_up = round(base_exec_time/row[-1], 3)
         row.append(speed_up)
@@ -185,7 +190,7 @@ def run_measurements(problem, instance, threads, num_runs,
         # First solution average
         row = run_measurement(problem, instance,
                               num_runs, thread_num,
-                              True)
+                              True, tie_policy)
         # Calculate speed-up and append to row
         speed_up = round(base_exec_time/row[-1], 3)
         row.append(speed_up)
@@ -246,6 +251,9 @@ if __name__ == '__main__':
                         help='Trunca ficheiro CSV')
     parser.add_argument('-o', '--output',
                         help='Nome do ficheiro CSV', default="report/measurements.csv")
+    parser.add_argument('-b', '--tie-break',
+                        choices=['none', 'high-g', 'low-h', 'lifo'],
+                        help='Política de desempate dos nós abertos')
     parser.add_argument('problem', type=str, help='problema a utilizar')
     parser.add_argument('instance', type=str, help='instância a utilizar')
 
@@ -257,4 +265,4 @@ if __name__ == '__main__':
 
     # Run measurements
     run_measurements(args.problem, args.instance, args.threads, int(args.runs),
-                     args.csv, args.output, args.truncate)
+                     args.csv, args.output, args.truncate, args.tie_break)